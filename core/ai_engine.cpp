@@ -4,6 +4,7 @@
  */
 
 #include "core/ai_engine.h"
+#include "core/json_reader.h"
 #include <iostream>
 #include <sstream>
 #include <cstdio>
@@ -12,6 +13,91 @@
 #include <memory>
 #include <vector>
 #include <chrono> // 用于 sleep
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cerrno>
+#include <pwd.h>
+#include <sys/stat.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+
+#ifndef AIOS_DATA_DIR
+#define AIOS_DATA_DIR "data"
+#endif
+
+// 本地分类器的结果要同时满足这两个门槛才直接采用
+static const double kLocalConfidence = 0.95;
+static const double kLocalCoverage = 0.5;
+// 本地模型只认词不懂语气，"不要清理内存"、"恢复了吗" 也会判成 CLEAN / RESTORE，
+// 所以只放行只读的标签，会改变系统状态的一律交给 LLM
+static const char* const kLocalLabels[] = {"CHECK", "LIST", "STATUS_MONITOR", "FIND_LARGE"};
+
+static const size_t kWorkerThreads = 4;   // 同时在跑的指令数上限
+static const size_t kProbeThreads = 2;    // 后台预热线程
+
+// 快照采样周期与单次耗时预算 (毫秒)：CPU/内存/进程表由采样线程发布，指令只读快照
+static const int kCpuSampleIntervalMs = 1000;
+static const int kCpuSampleBudgetMs = 20;
+static const int kMemSampleIntervalMs = 1000;
+static const int kMemSampleBudgetMs = 20;
+static const int kProcSampleIntervalMs = 1000;
+static const int kProcSampleBudgetMs = 200;
+
+static const size_t kBusiestCores = 4;    // CPU 查询列出的最忙核心数
+
+// 指标历史：每个指标保留的点数 (按 1 秒一次约 1 小时)，'history' 默认看的窗口
+static const size_t kHistoryPoints = 3600;
+static const int64_t kHistoryWindowMs = 60000;
+static const double kPercentResolution = 0.1;   // 百分比读数的记录精度
+
+// 指标的磁盘历史：分段大小、保留时长、总量上限，每轮按 CPU 和内存各记前几名进程
+static const size_t kStoreSegmentBytes = 4 << 20;
+static const int64_t kStoreRetentionMs = 7LL * 24 * 3600 * 1000;
+static const uint64_t kStoreMaxBytes = 256ULL << 20;
+static const size_t kStoreTopProcs = 5;
+static const int64_t kStoreDefaultRangeMs = 3600 * 1000;   // 'history <指标>' 不给时长时看最近 1 小时
+static const size_t kStoreDefaultRows = 20;                // 不给步长时大约分成这么多行
+
+// 哨兵各检查项的周期与单次耗时预算 (毫秒)
+static const int kNewProcIntervalMs = 1000;
+static const int kNewProcBudgetMs = 50;
+static const int kHighLoadIntervalMs = 3000;
+static const int kHighLoadBudgetMs = 200;
+static const double kHighLoadThreshold = 90.0;
+
+// 哨兵的 PSI 触发器：1 秒窗口里停顿超过阈值才唤醒 (没有 CAP_SYS_RESOURCE 时窗口按比例放大到 2 秒)
+struct PressureTrigger {
+    const char* resource;
+    bool full;
+    int stallMs;
+};
+static const PressureTrigger kPressureTriggers[] = {
+    {"cpu", false, 150},      // 15% 的时间有任务在排队等 CPU
+    {"memory", false, 150},   // 有任务在等回收 / 换入
+    {"memory", true, 50},     // 全部任务都卡在内存上，已经在颠簸
+    {"io", false, 150},
+};
+static const int kPressureWindowMs = 1000;
+static const int kPressureCooldownMs = 30000;   // 持续越线时同一触发器多久再报一次
+static const size_t kPressureCulprits = 3;      // 告警里列出的进程数
+static const int kPsiSampleIntervalMs = 1000;   // 磁盘历史里的 PSI 读数
+static const int kPsiSampleBudgetMs = 20;
+
+// 预热请求：处理完模块说明后只需模型简短应答，context 就包含了说明的全部 token
+static const char* const kWarmSuffix = "\n明白后只回复 OK。";
+static const int kWarmMaxTokens = 8;
+// 模型指纹的有效期：过期后重新 /api/show，模型被重新拉取时缓存的 context 随之作废
+static const int kModelStampTtlMs = 60000;
+
+// 指令在工作线程中运行时，输出写到该指令自己的缓冲区，取消标志指向该指令
+static thread_local std::ostream* tlsOut = &std::cout;
+static thread_local const std::atomic<bool>* tlsCancel = nullptr;
+static thread_local int tlsCommandId = 0;
+static thread_local int tlsModule = 0;     // 当前指令所属模块在 LatencyStats 中的下标
+
+static std::ostream& out() { return *tlsOut; }
 
 // ==========================================
 //           工具函数区
@@ -19,41 +105,91 @@
 
 std::string jsonEscape(const std::string& input) {
     std::string output;
+    output.reserve(input.size() + 16);
     for (char c : input) {
         if (c == '"') output += "\\\"";
         else if (c == '\\') output += "\\\\";
-        else if (c == '\n') output += " ";
+        else if (c == '\n') output += "\\n";
+        else if (c == '\r') output += "\\r";
+        else if (c == '\t') output += "\\t";
+        else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
+            output += buf;
+        }
         else output += c;
     }
     return output;
 }
 
-std::string AiEngine::extractJson(const std::string& jsonResponse) {
-    std::string key = "\"response\":\"";
-    size_t startPos = jsonResponse.find(key);
-    if (startPos == std::string::npos) return ""; 
-    startPos += key.length();
-    std::string result;
-    bool escape = false;
-    for (size_t i = startPos; i < jsonResponse.length(); ++i) {
-        char c = jsonResponse[i];
-        if (escape) { result += c; escape = false; }
-        else {
-            if (c == '\\') escape = true;
-            else if (c == '"') break;
-            else result += c;
-        }
+// 各模块提示词的用户部分
+static std::string userQuery(const std::string& input) {
+    return "用户指令: [" + input + "]。只回复标签。";
+}
+
+bool AiEngine::extractJson(const char* data, size_t len, std::string& out) {
+    // Ollama 的回复对象里只关心 "response"，其余字段只跳过不解析
+    return JsonReader(data, len).getString("response", out);
+}
+
+// 路由关键词表：{关键词, 模块, 权重}
+// 模块第一次出现的顺序就是同分时的优先级；越具体的词权重越高，
+// 例如 "关闭监控" 里 "监控"(3) 压过 "关"(1)，"清理磁盘" 里 "磁盘"(3) 压过 "清理"(1)。
+struct RouteKeyword {
+    const char* keyword;
+    const char* route;
+    double weight;
+};
+
+static const RouteKeyword kRouteKeywords[] = {
+    {"cpu", "cpu", 3}, {"频率", "cpu", 2}, {"主频", "cpu", 2}, {"温度", "cpu", 2},
+    {"性能", "cpu", 2}, {"省电", "cpu", 2}, {"节能", "cpu", 2}, {"模式", "cpu", 1},
+    {"超频", "cpu", 2}, {"降频", "cpu", 2}, {"boost", "cpu", 3}, {"powersave", "cpu", 3},
+
+    {"内存", "mem", 3}, {"mem", "mem", 3}, {"memory", "mem", 3}, {"ram", "mem", 3},
+    {"垃圾", "mem", 2}, {"缓存", "mem", 2}, {"清理", "mem", 1},
+
+    {"监控", "monitor", 3}, {"哨兵", "monitor", 3}, {"守护", "monitor", 3},
+    {"monitor", "monitor", 3}, {"watch", "monitor", 2},
+
+    {"进程", "proc", 3}, {"任务", "proc", 2}, {"杀", "proc", 2}, {"关", "proc", 1},
+    {"top", "proc", 2}, {"ps", "proc", 2}, {"kill", "proc", 3},
+    {"process", "proc", 3}, {"processes", "proc", 3},
+
+    {"创建", "file_create", 3}, {"新建", "file_create", 3}, {"create", "file_create", 3},
+    {"new", "file_create", 2}, {"touch", "file_create", 3},
+
+    {"打开", "file_control", 2}, {"删除", "file_control", 3}, {"搜索", "file_control", 2},
+    {"查找", "file_control", 2}, {"open", "file_control", 2}, {"delete", "file_control", 3},
+    {"find", "file_control", 2}, {"search", "file_control", 2},
+
+    {"文件", "file", 2}, {"磁盘", "file", 3}, {"大文件", "file", 3}, {"大于", "file", 2},
+    {"找", "file", 1}, {"扫描", "file", 3}, {"索引", "file", 2}, {"file", "file", 2},
+    {"files", "file", 2}, {"disk", "file", 3}, {"scan", "file", 2}, {"large", "file", 2},
+};
+
+// 流式输出中是否已经出现完整标签
+// 普通标签 (如 "CHECK") 出现即完整；以 ':' 结尾的带参标签 (如 "KILL:") 要等到 ']' 或换行
+bool hasCompleteLabel(const std::string& text, const std::vector<std::string>& labels) {
+    for (const auto& label : labels) {
+        size_t pos = text.find(label);
+        if (pos == std::string::npos) continue;
+        if (label.back() != ':') return true;
+        if (text.find_first_of("]\n", pos + label.size()) != std::string::npos) return true;
     }
-    return result;
+    return false;
 }
 
-// 关键词匹配辅助
-bool hasKey(const std::string& str, const std::string& key) {
-    std::string s = str;
-    std::string k = key;
-    std::transform(s.begin(), s.end(), s.begin(), ::tolower);
-    std::transform(k.begin(), k.end(), k.begin(), ::tolower);
-    return s.find(k) != std::string::npos;
+// 缓存目录 ($XDG_CACHE_HOME/aios 或 ~/.cache/aios)，与 DataRadar 的索引放在一起
+std::string aiosCacheDir() {
+    const char* cacheHome = getenv("XDG_CACHE_HOME");
+    const char* home = getenv("HOME");
+    std::string dir = (cacheHome && *cacheHome) ? std::string(cacheHome)
+                                                : std::string(home ? home : getpwuid(getuid())->pw_dir) + "/.cache";
+    mkdir(dir.c_str(), 0755);
+    dir += "/aios";
+    mkdir(dir.c_str(), 0755);
+    return dir;
 }
 
 // ==========================================
@@ -66,258 +202,797 @@ AiEngine::AiEngine() {
     cpuControl = std::make_unique<CpuControl>();
     memMonitor = std::make_unique<MemMonitor>();
     memControl = std::make_unique<MemControl>();
+    psiMonitor = std::make_unique<PsiMonitor>();
     procMonitor = std::make_unique<ProcMonitor>();
     procControl = std::make_unique<ProcControl>();
     fileMonitor = std::make_unique<FileMonitor>(); // 新增：数据雷达模块
+    fileMonitor->setLiveUpdates(true);             // 索引随文件变化实时更新
     fileControl = std::make_unique<FileControl>(); // 新增：文件控制模块
     fileCreator = std::make_unique<FileCreator>(); // 新增
 
+    ollamaPort = 0;
+    if (!HttpClient::parseUrl(ollamaUrl, ollamaHost, ollamaPort, ollamaPath)) {
+        std::cerr << "[Error] Invalid Ollama URL: " << ollamaUrl << std::endl;
+    }
+    intentCache = std::make_unique<IntentCache>(aiosCacheDir() + "/intent_cache.txt");
+    promptContexts = std::make_unique<PromptContextCache>(aiosCacheDir() + "/prompt_context.txt");
+    std::vector<std::string> moduleNames;
+    for (const auto& k : kRouteKeywords) moduleNames.push_back(k.route);
+    moduleNames.push_back("psi");   // 只有后台采样 (PROBE)，没有对应的指令路由
+    latency = std::make_unique<LatencyStats>(moduleNames);
+    shuttingDown = false;
+    for (const auto& k : kRouteKeywords) router.addKeyword(k.keyword, k.route, k.weight);
+    localModel = std::make_unique<IntentClassifier>();
+    if (localModel->loadOrTrain(aiosCacheDir() + "/intent_model.bin", AIOS_DATA_DIR "/intent_corpus.tsv")) {
+        std::cout << "[Core] 本地意图模型已加载 (" << localModel->moduleCount() << " 个模块)" << std::endl;
+    } else {
+        std::cerr << "[Warning] 本地意图模型不可用，所有分类交给 LLM。" << std::endl;
+    }
+
     std::cout << "[Core] 系统就绪。请下达指令。" << std::endl;
 
     // 启动后台监控线程
     isMonitorRunning = false;
-    keepRunning = false;
+
+    // 异步指令管线
+    for (const auto& k : kRouteKeywords) moduleLocks[k.route];
+    eventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    nextCommandId = 1;
+    inputClosed = false;
+    promptShown = false;
+    probes = std::make_unique<TaskPool>(kProbeThreads);
+    workers = std::make_unique<TaskPool>(kWorkerThreads);
+
+    // 在后台把各模块的说明预热好，第一次真正提问时就只需处理用户指令
+    probes->submit([this]() { prewarmContexts(); });
+    startSamplers();
 
     std::cout << "[Core] 系统就绪。后台监控默认 [关闭]。" << std::endl;
 }
 
+// === 快照采样 ===
+
+// 采样线程是各监控对象唯一的定期写者；指令与哨兵都只读它们发布的快照
+void AiEngine::startSamplers() {
+    samplers = std::make_unique<SamplingScheduler>();
+    auto timed = [this](const char* module, std::function<void()> fn) {
+        int idx = latency->moduleIndex(module);
+        return [this, idx, fn]() {
+            LatencyStats::Span span(latency.get(), idx, LatencyStats::PROBE);
+            fn();
+        };
+    };
+
+    // 指标要在采样开始前登记好，之后注册表只读
+    history = std::make_unique<MetricHistory>();
+    MetricSeries* cpuUsage = &history->add("cpu.usage", kHistoryPoints, 30.0, kPercentResolution);
+    MetricSeries* cpuBusiest = &history->add("cpu.busiest_core", kHistoryPoints, 30.0, kPercentResolution);
+    MetricSeries* cpuIowait = &history->add("cpu.iowait", kHistoryPoints, 30.0, kPercentResolution);
+    MetricSeries* cpuSteal = &history->add("cpu.steal", kHistoryPoints, 30.0, kPercentResolution);
+    MetricSeries* cpuFreq = &history->add("cpu.freq_mhz", kHistoryPoints, 30.0, 1.0);
+    MetricSeries* cpuTemp = &history->add("cpu.temp_c", kHistoryPoints, 30.0, 0.1);
+    MetricSeries* memUsed = &history->add("mem.used_pct", kHistoryPoints, 30.0, kPercentResolution);
+    MetricSeries* memAvail = &history->add("mem.available_mb", kHistoryPoints, 30.0, 1.0);
+    MetricSeries* swapUsed = &history->add("swap.used_mb", kHistoryPoints, 30.0, 1.0);
+    MetricSeries* procCount = &history->add("proc.count", kHistoryPoints, 30.0, 1.0);
+    MetricSeries* procTop = &history->add("proc.top_cpu", kHistoryPoints, 30.0, kPercentResolution);
+    // PSI 的 avg10 本身已平滑过，直接记录
+    MetricSeries* psiCpu = &history->add("psi.cpu_some", kHistoryPoints, 30.0, kPercentResolution);
+    MetricSeries* psiMemSome = &history->add("psi.memory_some", kHistoryPoints, 30.0, kPercentResolution);
+    MetricSeries* psiMemFull = &history->add("psi.memory_full", kHistoryPoints, 30.0, kPercentResolution);
+    MetricSeries* psiIoSome = &history->add("psi.io_some", kHistoryPoints, 30.0, kPercentResolution);
+    MetricSeries* psiIoFull = &history->add("psi.io_full", kHistoryPoints, 30.0, kPercentResolution);
+
+    store = std::make_unique<MetricStore>(aiosCacheDir() + "/metrics", kStoreSegmentBytes, kStoreRetentionMs,
+                                          kStoreMaxBytes);
+    if (!store->open()) {
+        std::cerr << "[Warning] 指标磁盘历史不可用，只保留内存里最近 " << kHistoryPoints / 60 << " 分钟。" << std::endl;
+        store.reset();
+    }
+    // 同一个读数同时进内存序列和磁盘历史
+    MetricStore* disk = store.get();
+    auto record = [disk](MetricSeries* s, int64_t now, double v) {
+        s->push(now, v);
+        if (disk) disk->append(s->name(), s->precision(), now, v);
+    };
+
+    samplers->addSource("cpu", kCpuSampleIntervalMs, kCpuSampleBudgetMs, timed("cpu", [=]() {
+        cpuMonitor->sample();
+        auto snap = cpuMonitor->snapshot();
+        int64_t now = MetricSeries::nowMs();
+        record(cpuUsage, now, snap->usagePercent);
+        double busiest = 0;
+        for (float u : snap->usage) busiest = std::max(busiest, static_cast<double>(u));
+        record(cpuBusiest, now, busiest);
+        record(cpuIowait, now, snap->iowaitPercent);
+        record(cpuSteal, now, snap->stealPercent);
+        if (snap->freqMHz > 0) record(cpuFreq, now, snap->freqMHz);
+        if (snap->tempC >= 0) record(cpuTemp, now, snap->tempC);
+    }));
+    samplers->addSource("mem", kMemSampleIntervalMs, kMemSampleBudgetMs, timed("mem", [=]() {
+        memMonitor->sample();
+        auto snap = memMonitor->snapshot();
+        int64_t now = MetricSeries::nowMs();
+        record(memUsed, now, snap->usagePercent);
+        record(memAvail, now, snap->availableMB);
+        record(swapUsed, now, snap->swapUsedMB);
+    }));
+    samplers->addSource("procs", kProcSampleIntervalMs, kProcSampleBudgetMs, timed("proc", [=]() {
+        procMonitor->sample();
+        auto snap = procMonitor->snapshot();
+        int64_t now = MetricSeries::nowMs();
+        double top = 0;
+        for (const auto& p : snap->procs) top = std::max(top, p.cpuPercent);
+        record(procCount, now, static_cast<double>(snap->procs.size()));
+        if (snap->hasCpu) {
+            record(procTop, now, top);
+            if (store) recordProcessHistory(*snap, now);
+        }
+    }));
+    if (psiMonitor->isAvailable()) {
+        samplers->addSource("psi", kPsiSampleIntervalMs, kPsiSampleBudgetMs, timed("psi", [=]() {
+            PsiStatus psi = psiMonitor->read();
+            int64_t now = MetricSeries::nowMs();
+            record(psiCpu, now, psi.cpu.some.avg10);
+            record(psiMemSome, now, psi.memory.some.avg10);
+            record(psiMemFull, now, psi.memory.full.avg10);
+            record(psiIoSome, now, psi.io.some.avg10);
+            record(psiIoFull, now, psi.io.full.avg10);
+        }));
+    }
+    if (!samplers->start()) {
+        std::cerr << "[Error] 采样线程启动失败，CPU/内存/进程读数将停留在启动时。" << std::endl;
+    }
+}
+
+// 同名进程合并后 (多进程的浏览器、编译器)，CPU 和内存各取前几名写进磁盘历史。
+// 进程掉出前几名就不再记录，它的序列在那段时间是空的
+void AiEngine::recordProcessHistory(const ProcTable& table, int64_t nowMs) {
+    procTotals.clear();
+    for (const auto& p : table.procs) {
+        auto& t = procTotals[p.name];
+        t.first += p.cpuPercent;
+        t.second += p.rssKB / 1024.0;
+    }
+    using Entry = const std::pair<const std::string, std::pair<double, double>>*;
+    std::vector<Entry> ranked;
+    ranked.reserve(procTotals.size());
+    for (const auto& kv : procTotals) ranked.push_back(&kv);
+    size_t k = std::min(kStoreTopProcs, ranked.size());
+
+    std::vector<Entry> chosen;
+    std::partial_sort(ranked.begin(), ranked.begin() + k, ranked.end(),
+                      [](Entry a, Entry b) { return a->second.first > b->second.first; });
+    chosen.assign(ranked.begin(), ranked.begin() + k);
+    std::partial_sort(ranked.begin(), ranked.begin() + k, ranked.end(),
+                      [](Entry a, Entry b) { return a->second.second > b->second.second; });
+    for (size_t i = 0; i < k; ++i) {
+        if (std::find(chosen.begin(), chosen.end(), ranked[i]) == chosen.end()) chosen.push_back(ranked[i]);
+    }
+    for (Entry e : chosen) {
+        store->append("proc.cpu:" + e->first, kPercentResolution, nowMs, e->second.first);
+        store->append("proc.rss_mb:" + e->first, 1.0, nowMs, e->second.second);
+    }
+}
+
+// "history <指标> [时长] [步长]"：从磁盘历史按步长降采样，时长/步长写成 90s、15m、24h、7d
+static int64_t parseDurationMs(const std::string& text) {
+    char* end = nullptr;
+    double n = std::strtod(text.c_str(), &end);
+    if (end == text.c_str() || !(n > 0)) return 0;
+    std::string unit(end);
+    if (unit.empty() || unit == "s") return static_cast<int64_t>(n * 1000);
+    if (unit == "m") return static_cast<int64_t>(n * 60 * 1000);
+    if (unit == "h") return static_cast<int64_t>(n * 3600 * 1000);
+    if (unit == "d") return static_cast<int64_t>(n * 86400 * 1000);
+    return 0;
+}
+
+void AiEngine::showStoredHistory(const std::string& args) {
+    if (!store) {
+        std::cout << ">>> 指标磁盘历史不可用。" << std::endl;
+        return;
+    }
+    std::istringstream in(args);
+    std::string name, rangeText, stepText;
+    in >> name >> rangeText >> stepText;
+    int64_t rangeMs = rangeText.empty() ? kStoreDefaultRangeMs : parseDurationMs(rangeText);
+    int64_t stepMs = stepText.empty() ? std::max<int64_t>(rangeMs / kStoreDefaultRows, 1000) : parseDurationMs(stepText);
+    if (rangeMs <= 0 || stepMs <= 0) {
+        std::cout << ">>> 时长格式如 90s、15m、24h、7d。" << std::endl;
+        return;
+    }
+
+    int64_t toMs = MetricSeries::nowMs();
+    std::vector<MetricStore::Bucket> buckets;
+    store->aggregate(name, toMs - rangeMs, toMs, stepMs, buckets);
+    if (buckets.empty()) {
+        std::cout << ">>> " << name << " 在这段时间没有记录。可查询的指标:";
+        for (const auto& n : store->seriesNames()) std::cout << " " << n;
+        std::cout << std::endl;
+        return;
+    }
+
+    size_t points = 0;
+    for (const auto& b : buckets) points += b.count;
+    std::cout << ">>> " << name << " 最近 " << (rangeText.empty() ? std::string("1h") : rangeText)
+              << "，每 " << stepMs / 1000 << " 秒一行，共 " << points << " 个点:" << std::endl;
+    std::cout << "  时间                  点数       min      mean       max" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    for (const auto& b : buckets) {
+        time_t t = static_cast<time_t>(b.startMs / 1000);
+        struct tm local;
+        localtime_r(&t, &local);
+        char when[32];
+        strftime(when, sizeof(when), "%m-%d %H:%M:%S", &local);
+        std::cout << "  " << when << std::setw(12) << b.count << std::setw(10) << b.min
+                  << std::setw(10) << b.mean << std::setw(10) << b.max << std::endl;
+    }
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << std::setprecision(6);
+}
+
 // === 线程控制逻辑 ===
 
 void AiEngine::startMonitor() {
     if (isMonitorRunning) {
-        std::cout << ">>> [AI 哨兵] 已经在运行中，无需重复启动。" << std::endl;
+        out() << ">>> [AI 哨兵] 已经在运行中，无需重复启动。" << std::endl;
         return;
     }
 
-    std::cout << ">>> 正在启动后台监控线程..." << std::endl;
+    out() << ">>> 正在启动后台监控线程..." << std::endl;
     
     // 重置状态
-    // 为了防止 detectNewProcesses 刚启动就报一堆旧进程，我们先刷新一下快照但不打印
-    procMonitor->detectNewProcesses(); 
-    
-    keepRunning = true;
+    // 为了防止 detectNewProcesses 刚启动就报一堆旧进程，我们先刷新一下基准但不打印
+    procMonitor->detectNewProcesses();
+
+    // 负载异常交给内核 PSI 触发器：系统健康时监听线程一直阻塞，不做任何检查
+    std::vector<PsiTrigger> triggers;
+    for (const auto& spec : kPressureTriggers) {
+        PsiTrigger t;
+        t.resource = spec.resource;
+        t.full = spec.full;
+        t.stallUs = spec.stallMs * 1000;
+        t.windowUs = kPressureWindowMs * 1000;
+        triggers.push_back(t);
+    }
+    lastPressureAlert.clear();
+    int armedCount = psiMonitor->start(triggers, [this](const PsiTrigger& t, const PsiStatus& s) { onPressure(t, s); });
+
+    // 新进程检查跑得勤；没有 PSI 触发器时退回定时扫描高负载进程，看的是区间占用，跑得慢一些
+    monitorScheduler = std::make_unique<SamplingScheduler>();
+    monitorScheduler->addSource("new_procs", kNewProcIntervalMs, kNewProcBudgetMs,
+                                [this]() { checkNewProcesses(); });
+    if (armedCount == 0) {
+        monitorScheduler->addSource("high_load", kHighLoadIntervalMs, kHighLoadBudgetMs,
+                                    [this]() { checkAbnormalProcesses(); });
+    }
+    if (!monitorScheduler->start()) {
+        psiMonitor->stop();
+        monitorScheduler.reset();
+        out() << ">>> [AI 哨兵] 启动失败。" << std::endl;
+        return;
+    }
+    if (armedCount > 0) out() << ">>> [AI 哨兵] 已注册 " << armedCount << " 个 PSI 触发器，资源停顿越线时才会唤醒。" << std::endl;
+    else out() << ">>> [AI 哨兵] 内核不支持 PSI 触发器，改为每 " << kHighLoadIntervalMs / 1000 << " 秒扫描一次高负载进程。" << std::endl;
     isMonitorRunning = true;
-    
-    // 创建新线程
-    monitorThread = std::thread(&AiEngine::backgroundMonitorTask, this);
-    std::cout << ">>> [AI 哨兵] 启动成功！现在我会盯着后台进程和异常。" << std::endl;
+    out() << ">>> [AI 哨兵] 启动成功！现在我会盯着后台进程和异常。" << std::endl;
 }
 
 void AiEngine::stopMonitor() {
     if (!isMonitorRunning) {
-        std::cout << ">>> [AI 哨兵] 已经是关闭状态。" << std::endl;
+        out() << ">>> [AI 哨兵] 已经是关闭状态。" << std::endl;
         return;
     }
 
-    std::cout << ">>> 正在停止监控线程..." << std::endl;
-    keepRunning = false; // 告诉线程循环该停了
-    
-    if (monitorThread.joinable()) {
-        monitorThread.join(); // 等待线程彻底结束
-    }
-    
+    out() << ">>> 正在停止监控线程..." << std::endl;
+    // eventfd 立即唤醒调度线程，不用等完当前周期
+    monitorScheduler->stop();
+    monitorScheduler.reset();
+    psiMonitor->stop();
     isMonitorRunning = false;
-    std::cout << ">>> [AI 哨兵] 已关闭。世界清静了。" << std::endl;
+    out() << ">>> [AI 哨兵] 已关闭。世界清静了。" << std::endl;
 }
 
-// 线程主体 (保持之前的逻辑，略微优化显示)
-void AiEngine::backgroundMonitorTask() {
-    while (keepRunning) {
-        // 1. 新进程检测
-        std::string newProcs = procMonitor->detectNewProcesses();
-        if (!newProcs.empty()) {
-            std::cout << "\r\033[K"; 
-            std::cout << "\033[1;32m[AI 哨兵] 发现新活动:\033[0m\n" << newProcs << std::flush;
-            std::cout << "Admin@AIOS:~$ " << std::flush; 
-        }
+// 哨兵检查 (在调度线程上执行)
+// 只读进程表快照，不和进程模块的指令抢锁；
+// 结果交给主循环打印，不直接写终端，避免踩到用户正在输入的提示符
+void AiEngine::checkNewProcesses() {
+    std::string newProcs = procMonitor->detectNewProcesses();
+    if (!newProcs.empty()) {
+        postEvent({LoopEvent::MESSAGE, 0, "\033[1;32m[AI 哨兵] 发现新活动:\033[0m\n" + newProcs, nullptr});
+    }
+}
 
-        // 2. 异常检测
-        std::string badProcs = procMonitor->detectAbnormalProcesses(90.0);
-        if (!badProcs.empty()) {
-            std::cout << "\r\033[K";
-            std::cout << "\033[1;31m[AI 警告] 异常负载:\033[0m\n" << badProcs << std::flush;
-            std::cout << "Admin@AIOS:~$ " << std::flush;
+void AiEngine::checkAbnormalProcesses() {
+    std::string badProcs = procMonitor->detectAbnormalProcesses(kHighLoadThreshold);
+    if (!badProcs.empty()) {
+        postEvent({LoopEvent::MESSAGE, 0, "\033[1;31m[AI 警告] 异常负载:\033[0m\n" + badProcs, nullptr});
+    }
+}
+
+// PSI 触发器越线 (在 PSI 监听线程上执行)：说明哪种资源在停顿，并列出最可能的来源
+void AiEngine::onPressure(const PsiTrigger& trigger, const PsiStatus& status) {
+    // 停顿持续期间内核每个窗口都会通知一次，同一触发器在冷却期内只报一次
+    auto now = std::chrono::steady_clock::now();
+    std::string key = trigger.describe();
+    auto it = lastPressureAlert.find(key);
+    if (it != lastPressureAlert.end() && now - it->second < std::chrono::milliseconds(kPressureCooldownMs)) return;
+    lastPressureAlert[key] = now;
+
+    const PsiResource& res = trigger.resource == "cpu" ? status.cpu
+                           : trigger.resource == "memory" ? status.memory : status.io;
+    const PsiLine& line = trigger.full ? res.full : res.some;
+    const char* what = trigger.resource == "cpu" ? "CPU" : trigger.resource == "memory" ? "内存" : "IO";
+
+    std::ostringstream msg;
+    msg << std::fixed << std::setprecision(1);
+    msg << "\033[1;31m[AI 警告] " << what << " 停顿:\033[0m " << trigger.describe() << " 越线，最近 10 秒"
+        << (trigger.full ? "全部任务" : "有任务") << "在等待的时间占 " << line.avg10 << "% (60 秒 "
+        << line.avg60 << "%)\n";
+
+    auto snap = procMonitor->snapshot();
+    std::vector<const ProcSample*> order;
+    for (const auto& p : snap->procs) order.push_back(&p);
+    size_t n = std::min(kPressureCulprits, order.size());
+    if (trigger.resource == "cpu") {
+        std::partial_sort(order.begin(), order.begin() + n, order.end(),
+                          [](const ProcSample* a, const ProcSample* b) { return a->cpuPercent > b->cpuPercent; });
+        for (size_t i = 0; i < n && order[i]->cpuPercent > 0; ++i) {
+            msg << " [CPU 大户] " << order[i]->name << " (PID " << order[i]->pid << ", CPU "
+                << order[i]->cpuPercent << "%)\n";
+        }
+    } else if (trigger.resource == "memory") {
+        std::partial_sort(order.begin(), order.begin() + n, order.end(),
+                          [](const ProcSample* a, const ProcSample* b) { return a->rssKB > b->rssKB; });
+        for (size_t i = 0; i < n; ++i) {
+            msg << " [内存大户] " << order[i]->name << " (PID " << order[i]->pid << ", "
+                << order[i]->rssKB / 1024.0 << " MB)\n";
         }
+    }
+    postEvent({LoopEvent::MESSAGE, 0, msg.str(), nullptr});
+}
 
-        // 休眠 2 秒
-        std::this_thread::sleep_for(std::chrono::seconds(2));
+// 'pressure'：系统级和各 cgroup 的停顿占比
+void AiEngine::showPressure() {
+    PsiStatus sys = psiMonitor->read();
+    if (!sys.available) {
+        std::cout << ">>> 内核没有提供 PSI (/proc/pressure)。" << std::endl;
+        return;
     }
+    auto row = [](const std::string& name, const PsiStatus& s) {
+        std::cout << "  " << std::left << std::setw(28) << name << std::right
+                  << std::setw(8) << s.cpu.some.avg10 << std::setw(8) << s.cpu.some.avg60
+                  << std::setw(8) << s.memory.some.avg10 << std::setw(8) << s.memory.full.avg10
+                  << std::setw(8) << s.io.some.avg10 << std::setw(8) << s.io.full.avg10 << std::endl;
+    };
+    std::cout << ">>> 资源停顿占比 (%，some=有任务在等，full=全部任务在等):" << std::endl;
+    std::cout << "  " << std::left << std::setw(28) << "" << std::right;
+    for (const char* h : {"cpu", "cpu", "mem", "mem", "io", "io"}) std::cout << std::setw(8) << h;
+    std::cout << std::endl << "  " << std::left << std::setw(28) << "cgroup" << std::right;
+    for (const char* h : {"10s", "60s", "some", "full", "some", "full"}) std::cout << std::setw(8) << h;
+    std::cout << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    row("/proc/pressure", sys);
+    for (const auto& cg : psiMonitor->readCgroups()) row(cg.path, cg.status);
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << std::setprecision(6);
 }
 
 AiEngine::~AiEngine() {
-    // 停止监控线程
+    // 先等工作线程和预热线程退出，再停采样线程和监控线程
+    shuttingDown = true;
+    workers.reset();
+    probes.reset();
+    if (samplers) samplers->stop();
+    std::string statsPath = aiosCacheDir() + "/latency_stats.json";
+    if (latency->writeJson(statsPath)) std::cout << "[Core] 耗时统计已写入 " << statsPath << std::endl;
     stopMonitor();
+    if (eventFd >= 0) close(eventFd);
+    std::cout << "[Core] 意图缓存: 命中 " << intentCache->hitCount()
+              << " 次 / 未命中 " << intentCache->missCount() << " 次" << std::endl;
     std::cout << "[Core] 系统已关闭。" << std::endl;
 }
 
-std::string AiEngine::callOllama(const std::string& promptText) {
+std::unique_ptr<HttpClient> AiEngine::acquireClient() {
+    std::lock_guard<std::mutex> g(clientLock);
+    if (idleClients.empty()) return std::make_unique<HttpClient>(ollamaHost, ollamaPort);
+    std::unique_ptr<HttpClient> client = std::move(idleClients.back());
+    idleClients.pop_back();
+    return client;
+}
+
+void AiEngine::releaseClient(std::unique_ptr<HttpClient> client) {
+    client->setCancelFlag(nullptr);
+    std::lock_guard<std::mutex> g(clientLock);
+    idleClients.push_back(std::move(client));
+}
+
+std::string AiEngine::callOllama(const std::string& promptText, const std::vector<std::string>& labels,
+                                 const std::string& context, int* httpStatus) {
     std::string safePrompt = jsonEscape(promptText);
-    std::string jsonPayload = "{\"model\": \"" + modelName + "\", \"prompt\": \"" + safePrompt + "\", \"stream\": false}";
-    std::string cmd = "curl -s -X POST " + ollamaUrl + " -d '" + jsonPayload + "'";
-    
+    bool stream = !labels.empty();
+    std::string jsonPayload = "{\"model\": \"" + modelName + "\", \"prompt\": \"" + safePrompt + "\", \"stream\": " +
+                              (stream ? "true" : "false");
+    if (!context.empty()) jsonPayload += ", \"context\": " + context;
+    jsonPayload += "}";
+
+    // HTTP 阶段 = 整个请求耗时减去其中解析 JSON 的时间
+    auto started = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::duration jsonTime{0};
+
+    // 直接走持久 HTTP 连接，不再为每条指令 fork 一次 sh + curl
+    std::unique_ptr<HttpClient> ollama = acquireClient();
+    ollama->setCancelFlag(tlsCancel);
     std::string rawJson;
-    char buffer[2048];
-    std::shared_ptr<FILE> pipe(popen(cmd.c_str(), "r"), pclose);
-    if (!pipe) return "";
-    while (fgets(buffer, 2048, pipe.get())) rawJson += buffer;
-    return extractJson(rawJson);
-}
+    std::string text;      // 流式模式下已拼好的回复
+    std::string fragment;  // 每行的 response 片段反转义到这里，容量复用
+    size_t lineStart = 0;
+    bool cutOff = false;
+    int status = 0;
+    bool ok;
+    const char* line;
+    size_t lineLen;
+    if (stream) {
+        // NDJSON：每行一个 {"response":"片段","done":false}，边收边拼，标签完整就断开
+        ok = ollama->postStream(ollamaPath, jsonPayload, [&](const char* data, size_t len) {
+            rawJson.append(data, len);
+            if (isCancelled()) return false;
+            if (status != 200) return true;
+            auto parseStart = std::chrono::steady_clock::now();
+            while (JsonReader::nextLine(rawJson.data(), rawJson.size(), lineStart, line, lineLen)) {
+                if (extractJson(line, lineLen, fragment)) text += fragment;
+                if (hasCompleteLabel(text, labels)) {
+                    cutOff = true;
+                    break;
+                }
+            }
+            jsonTime += std::chrono::steady_clock::now() - parseStart;
+            if (cutOff) return false;
+            // 已处理的行不再保留，长回复时缓冲区不会一直涨
+            if (lineStart > 4096) {
+                rawJson.erase(0, lineStart);
+                lineStart = 0;
+            }
+            return true;
+        }, status);
+    } else {
+        ok = ollama->post(ollamaPath, jsonPayload, rawJson, status);
+    }
 
-// ==========================================
-//           核心路由 (Router)
-// ==========================================
-// 这里不做AI分析，只做物理分流，确保绝对不会串台
-void AiEngine::routeAndProcess(const std::string& input) {
-    
-    // 1. 判断是否是 CPU 相关
-    if (hasKey(input, "cpu") || hasKey(input, "频率") || hasKey(input, "温度") || 
-        hasKey(input, "性能") || hasKey(input, "省电") || hasKey(input, "模式")) {
-        runCpuModule(input);
-        return;
+    std::string error = ollama->lastError();
+    releaseClient(std::move(ollama));
+    auto httpTime = std::chrono::steady_clock::now() - started - jsonTime;
+    latency->record(tlsModule, LatencyStats::HTTP,
+                    std::chrono::duration_cast<std::chrono::microseconds>(httpTime).count());
+    if (httpStatus) *httpStatus = ok ? status : 0;
+    if (isCancelled()) return "";
+    if (!ok) {
+        out() << "[Error] Ollama request failed: " << error << std::endl;
+        return "";
+    }
+    if (status != 200) {
+        // 出错时 Ollama 会在 {"error": "..."} 里说明原因 (比如模型没有拉取)
+        std::string reason;
+        JsonReader(rawJson).getString("error", reason);
+        out() << "[Error] Ollama returned HTTP " << status << (reason.empty() ? "" : ": " + reason) << std::endl;
+        return "";
     }
+    auto parseStart = std::chrono::steady_clock::now();
+    if (!stream) {
+        extractJson(rawJson.data(), rawJson.size(), text);
+    } else {
+        // 最后一行可能没有换行
+        while (!cutOff && JsonReader::nextLine(rawJson.data(), rawJson.size(), lineStart, line, lineLen, false)) {
+            if (extractJson(line, lineLen, fragment)) text += fragment;
+        }
+    }
+    jsonTime += std::chrono::steady_clock::now() - parseStart;
+    latency->record(tlsModule, LatencyStats::JSON,
+                    std::chrono::duration_cast<std::chrono::microseconds>(jsonTime).count());
+    return text;
+}
 
-    // 2. 判断是否是 内存 相关
-    if (hasKey(input, "内存") || hasKey(input, "mem") || hasKey(input, "ram") || 
-        hasKey(input, "垃圾") || hasKey(input, "清理")) {
-        runMemModule(input);
-        return;
+bool AiEngine::loadModelStamp(std::string& stamp) {
+    std::unique_lock<std::mutex> g(modelStampLock);
+    auto fresh = [this] {
+        return !modelStamp.empty() &&
+               std::chrono::steady_clock::now() - modelStampAt < std::chrono::milliseconds(kModelStampTtlMs);
+    };
+    if (fresh()) {
+        stamp = modelStamp;
+        return true;
+    }
+    if (modelStampFetching) {
+        // 别的线程正在取 (非流式请求最长要等 responseMs)：等它的结果，不重复请求
+        uint64_t fetches = modelStampFetches;
+        while (modelStampFetches == fetches) {
+            if (isCancelled() || shuttingDown) return false;
+            modelStampCv.wait_for(g, std::chrono::milliseconds(100));
+        }
+        if (!fresh()) return false;   // 那次没取到
+        stamp = modelStamp;
+        return true;
+    }
+    modelStampFetching = true;
+    g.unlock();
+
+    // 模型重新拉取后修改时间会变，模板变了 token 序列也会变，两者都要进指纹
+    std::unique_ptr<HttpClient> client = acquireClient();
+    client->setCancelFlag(tlsCancel ? tlsCancel : &shuttingDown);
+    std::string body;
+    int status = 0;
+    bool ok = client->post("/api/show", "{\"model\": \"" + modelName + "\"}", body, status);
+    releaseClient(std::move(client));
+    ok = ok && status == 200;
+    if (ok) {
+        JsonReader reader(body);
+        std::string modifiedAt;
+        std::string tmpl;
+        reader.getString("modified_at", modifiedAt);
+        reader.getString("template", tmpl);
+        stamp = modelName + "\n" + modifiedAt + "\n" + tmpl;
     }
 
-    // === 新增：监控控制路由 ===
-    if (hasKey(input, "监控") || hasKey(input, "哨兵") || 
-        hasKey(input, "monitor") || hasKey(input, "watch") || 
-        hasKey(input, "守护")) {
-        runMonitorModule(input);
-        return;
+    g.lock();
+    if (ok) {
+        modelStamp = stamp;
+        modelStampAt = std::chrono::steady_clock::now();
     }
+    modelStampFetching = false;
+    modelStampFetches++;
+    g.unlock();
+    modelStampCv.notify_all();
+    return ok;
+}
 
-    // 3. 判断是否是 进程 相关 (优先级最低，作为兜底)
-    // 凡是说“杀”、“关”、“任务”、“top”都算进程
-    if (hasKey(input, "杀") || hasKey(input, "关") || hasKey(input, "进程") || 
-        hasKey(input, "任务") || hasKey(input, "top") || hasKey(input, "kill")) {
-        runProcModule(input);
-        return;
+bool AiEngine::warmPrompt(const std::string& preamble, std::string& context) {
+    std::string payload = "{\"model\": \"" + modelName + "\", \"prompt\": \"" + jsonEscape(preamble + kWarmSuffix) +
+                          "\", \"stream\": false, \"options\": {\"num_predict\": " + std::to_string(kWarmMaxTokens) + "}}";
+    std::unique_ptr<HttpClient> client = acquireClient();
+    client->setCancelFlag(tlsCancel ? tlsCancel : &shuttingDown);
+    std::string body;
+    int status = 0;
+    bool ok = client->post(ollamaPath, payload, body, status);
+    releaseClient(std::move(client));
+    if (!ok || status != 200) return false;
+
+    JsonReader::Value v;
+    if (!JsonReader(body).find("context", v) || v.type != JsonReader::ARRAY) return false;
+    context.assign(v.begin, v.end);
+    return true;
+}
+
+std::string AiEngine::moduleContext(const std::string& module, const std::string& preamble) {
+    std::string stamp;
+    if (!loadModelStamp(stamp)) return "";
+
+    uint64_t fp = PromptContextCache::fingerprint({stamp, preamble, kWarmSuffix});
+    std::string context;
+    if (promptContexts->lookup(module, fp, context)) return context;
+    if (!warmPrompt(preamble, context)) return "";
+    promptContexts->store(module, fp, context);
+    return context;
+}
+
+void AiEngine::prewarmContexts() {
+    const std::pair<const char*, Prompt> modules[] = {
+        {"cpu", buildCpuPrompt("")},          {"mem", buildMemPrompt("")},
+        {"monitor", buildMonitorPrompt("")},  {"proc", buildProcPrompt("")},
+        {"file", buildFilePrompt("")},        {"file_control", buildFileControlPrompt("")},
+        {"file_create", buildFileCreatePrompt("")},
+    };
+    for (const auto& m : modules) {
+        if (shuttingDown) return;
+        // 模型不可用时不再逐个重试，留到第一次提问时再说
+        if (moduleContext(m.first, m.second.preamble).empty()) return;
     }
+}
 
-    // 4. 文件创建 (新建/创建) -> 优先路由
-    if (hasKey(input, "创建") || hasKey(input, "create") || 
-        hasKey(input, "新建") || hasKey(input, "new") || hasKey(input, "touch")) {
-        runFileCreateModule(input);
-        return;
+std::string AiEngine::classify(const std::string& module, const std::string& input,
+                               PromptBuilder build, const std::vector<std::string>& labels) {
+    std::string label;
+    {
+        LatencyStats::Span span(latency.get(), tlsModule, LatencyStats::CACHE);
+        if (intentCache->lookup(module, input, label)) return label;
     }
 
-    // 5. 判断是否是 文件控制 相关
-    if (hasKey(input, "打开") || hasKey(input, "open") || 
-        hasKey(input, "删除") || hasKey(input, "delete") || 
-        hasKey(input, "搜索") || hasKey(input, "查找") || hasKey(input, "find")) {
-        runFileControlModule(input); // 调用控制模块
-        return;
+    // 本地模型只判断只读的类别，带参数的标签 (KILL:xxx 等) 和会改变系统状态的标签仍交给 LLM
+    {
+        LatencyStats::Span span(latency.get(), tlsModule, LatencyStats::LOCAL_MODEL);
+        IntentClassifier::Prediction local;
+        if (localModel->predict(module, input, local) && local.confidence >= kLocalConfidence &&
+            local.coverage >= kLocalCoverage &&
+            std::find(std::begin(kLocalLabels), std::end(kLocalLabels), local.label) != std::end(kLocalLabels)) {
+            return "[" + local.label + "]";
+        }
     }
-    
-    // 6. 判断是否是 文件 相关
-    if (hasKey(input, "文件") || hasKey(input, "file") || hasKey(input, "磁盘") || 
-        hasKey(input, "找") || hasKey(input, "搜索") || hasKey(input, "大于")) {
-        runFileModule(input);
-        return;
+
+    // 固定说明已由 context 带上，只发送用户指令；context 失效 (模型被替换等) 时退回完整提示词
+    LatencyStats::Span promptSpan(latency.get(), tlsModule, LatencyStats::PROMPT);
+    Prompt prompt = (this->*build)(input);
+    std::string context = moduleContext(module, prompt.preamble);
+    promptSpan.stop();
+    if (!context.empty()) {
+        // 只有 Ollama 明确拒绝了这段 context (4xx，比如模型被替换) 才丢掉它、用完整提示词重问；
+        // 网络错误、超时或回复里没有标签时重问一遍也不会更好
+        int status = 0;
+        label = callOllama(prompt.query, labels, context, &status);
+        if (status >= 400 && status < 500 && !isCancelled()) {
+            promptContexts->invalidate(module);
+            {
+                std::lock_guard<std::mutex> g(modelStampLock);
+                modelStamp.clear();
+            }
+            label = callOllama(prompt.full(), labels);
+        }
+    } else {
+        label = callOllama(prompt.full(), labels);
     }
+    // 只缓存真正包含标签的回复，模型答非所问或请求失败时下次还要重问
+    if (hasCompleteLabel(label, labels)) intentCache->store(module, input, label);
+    return label;
+}
 
-    // 6. 未识别
-    std::cout << "[Core] 未识别指令领域 (请输入: CPU / 内存 / 进程 相关指令)" << std::endl;
+// ==========================================
+//           核心路由 (Router)
+// ==========================================
+// 这里不做AI分析，只做物理分流，确保绝对不会串台
+void AiEngine::routeAndProcess(const std::string& input) {
+    LatencyStats::Span total(latency.get(), 0, LatencyStats::TOTAL);
+    std::string route;
+    {
+        // 一次扫描收集所有模块的关键词命中，按权重打分选出模块
+        LatencyStats::Span span(latency.get(), 0, LatencyStats::ROUTE);
+        route = router.route(input);
+        tlsModule = latency->moduleIndex(route);
+        span.setModule(tlsModule);
+    }
+    total.setModule(tlsModule);
+
+    if (route == "cpu") runCpuModule(input);
+    else if (route == "mem") runMemModule(input);
+    else if (route == "monitor") runMonitorModule(input);
+    else if (route == "proc") runProcModule(input);
+    else if (route == "file_create") runFileCreateModule(input);
+    else if (route == "file_control") runFileControlModule(input);
+    else if (route == "file") runFileModule(input);
+    else out() << "[Core] 未识别指令领域 (请输入: CPU / 内存 / 进程 相关指令)" << std::endl;
 }
 
 // ==========================================
 //           功能区 1: CPU 模块
 // ==========================================
 
-std::string AiEngine::buildCpuPrompt(const std::string& input) {
+AiEngine::Prompt AiEngine::buildCpuPrompt(const std::string& input) {
     // 这里的 Prompt 只有 CPU 的概念，AI 不可能回答杀进程
-    return "用户指令: [" + input + "]。\n"
-           "请分类为:\n"
-           "1. [CHECK] (查询CPU状态)\n"
-           "2. [BOOST] (高性能/游戏模式)\n"
-           "3. [RESTORE] (省电/默认模式)\n"
-           "只回复标签。";
+    return {"你是 CPU 指令分类器。把之后给出的用户指令分类为:\n"
+            "1. [CHECK] (查询CPU状态)\n"
+            "2. [BOOST] (高性能/游戏模式)\n"
+            "3. [RESTORE] (省电/默认模式)\n"
+            "只回复标签。",
+            userQuery(input)};
 }
 
 void AiEngine::runCpuModule(const std::string& input) {
-    std::cout << "[CPU模块] 处理中..." << std::endl;
-    std::string resp = callOllama(buildCpuPrompt(input));
+    out() << "[CPU模块] 处理中..." << std::endl;
+
+    // 大多数 CPU 指令是查询：读数由采样线程定期发布，查询只读最新快照，不等新的采样；
+    // 快照在模型思考之前就已采好，不会把模型推理自身的负载算进去。
+    CpuStatus sample = *cpuMonitor->snapshot();
+
+    std::string resp = classify("cpu", input, &AiEngine::buildCpuPrompt, {"CHECK", "BOOST", "RESTORE"});
+    auto guard = beginAction("cpu", resp);
+    if (!guard) return;
     
     if (resp.find("CHECK") != std::string::npos) {
-        double temp = cpuMonitor->getCpuTemperature();
-        std::cout << ">>> CPU 使用率: " << cpuMonitor->getSystemCpuUsage() << "%" << std::endl;
-        std::cout << ">>> CPU 主频  : " << cpuMonitor->getCpuFrequency() << " MHz" << std::endl;
-        std::cout << ">>> CPU 温度  : " << (temp > 0 ? std::to_string(temp) + "C" : "N/A") << std::endl;
+        out() << ">>> CPU 使用率: " << sample.usagePercent << "%";
+        if (sample.iowaitPercent + sample.stealPercent >= 1.0) {
+            out() << " (iowait " << sample.iowaitPercent << "%, steal " << sample.stealPercent << "%)";
+        }
+        out() << std::endl;
+        out() << ">>> CPU 主频  : " << sample.freqMHz << " MHz" << std::endl;
+        out() << ">>> CPU 温度  : " << (sample.tempC > 0 ? std::to_string(sample.tempC) + "C" : "N/A") << std::endl;
+
+        // 整机平均会掩盖单核跑满，列出最忙的几个核心
+        if (sample.coreCount() > 1) {
+            out() << ">>> 最忙核心  :";
+            for (size_t i : sample.mostLoaded(kBusiestCores)) {
+                out() << " cpu" << sample.cpuId[i] << "=" << static_cast<int>(sample.usage[i] + 0.5) << "%";
+                if (sample.curMHz[i] > 0) out() << "@" << static_cast<int>(sample.curMHz[i]) << "MHz";
+            }
+            out() << std::endl;
+        }
+        auto nodes = sample.nodes();
+        if (nodes.size() > 1) {
+            for (const auto& n : nodes) {
+                out() << ">>> NUMA 节点 " << n.node << ": " << n.cores << " 核, 平均 " << n.usagePercent
+                      << "%, 最高 " << n.maxUsagePercent << "%" << std::endl;
+            }
+        }
+        int hot = sample.hottest();
+        if (hot >= 0 && sample.packages.size() > 1) {
+            out() << ">>> 最热核心  : cpu" << sample.cpuId[hot] << " (封装 " << sample.packageId[hot] << ", "
+                  << sample.packageTemp(sample.packageId[hot]) << "C)" << std::endl;
+        }
     }
     else if (resp.find("BOOST") != std::string::npos) {
-        std::cout << ">>> 正在开启高性能模式..." << std::endl;
+        out() << ">>> 正在开启高性能模式..." << std::endl;
         // 直接调用底层，不搞虚假的模拟
         bool ok = cpuControl->boostPerformance();
-        if (ok) std::cout << ">>> 成功。" << std::endl;
-        else std::cout << ">>> 失败: 请使用 sudo 运行，或确认系统支持 cpufreq。" << std::endl;
+        if (ok) out() << ">>> 成功。" << std::endl;
+        else out() << ">>> 失败: 请使用 sudo 运行，或确认系统支持 cpufreq。" << std::endl;
     }
     else if (resp.find("RESTORE") != std::string::npos) {
-        std::cout << ">>> 正在恢复默认模式..." << std::endl;
+        out() << ">>> 正在恢复默认模式..." << std::endl;
         cpuControl->restoreDefault();
-        std::cout << ">>> 已执行。" << std::endl;
+        out() << ">>> 已执行。" << std::endl;
     }
     else {
-        std::cout << ">>> (CPU模块) 无法理解的具体操作。" << std::endl;
+        out() << ">>> (CPU模块) 无法理解的具体操作。" << std::endl;
     }
-    std::cout << std::endl;
+    out() << std::endl;
 }
 
 // ==========================================
 //           功能区 2: 内存模块
 // ==========================================
 
-std::string AiEngine::buildMemPrompt(const std::string& input) {
+AiEngine::Prompt AiEngine::buildMemPrompt(const std::string& input) {
     // 这里的 Prompt 只有内存的概念
-    return "用户指令: [" + input + "]。\n"
-           "请分类为:\n"
-           "1. [CHECK] (查询内存)\n"
-           "2. [CLEAN] (清理/释放内存)\n"
-           "只回复标签。";
+    return {"你是内存指令分类器。把之后给出的用户指令分类为:\n"
+            "1. [CHECK] (查询内存)\n"
+            "2. [CLEAN] (清理/释放内存)\n"
+            "只回复标签。",
+            userQuery(input)};
 }
 
 void AiEngine::runMemModule(const std::string& input) {
-    std::cout << "[内存模块] 处理中..." << std::endl;
-    std::string resp = callOllama(buildMemPrompt(input));
+    out() << "[内存模块] 处理中..." << std::endl;
+
+    // 同 CPU 模块：查询读最新快照；CLEAN 之后立即重新采样发布
+    MemoryStatus sample = *memMonitor->snapshot();
+
+    std::string resp = classify("mem", input, &AiEngine::buildMemPrompt, {"CHECK", "CLEAN"});
+    auto guard = beginAction("mem", resp);
+    if (!guard) return;
 
     if (resp.find("CHECK") != std::string::npos) {
-        auto ms = memMonitor->getMemoryStatus();
-        std::cout << ">>> 总内存: " << ms.totalMB << " MB" << std::endl;
-        std::cout << ">>> 已用  : " << ms.usedMB << " MB (" << ms.usagePercent << "%)" << std::endl;
-        std::cout << ">>> 可用  : " << ms.availableMB << " MB" << std::endl;
+        const MemoryStatus& ms = sample;
+        out() << ">>> 总内存: " << ms.totalMB << " MB" << std::endl;
+        out() << ">>> 已用  : " << ms.usedMB << " MB (" << ms.usagePercent << "%)" << std::endl;
+        out() << ">>> 可用  : " << ms.availableMB << " MB" << std::endl;
     }
     else if (resp.find("CLEAN") != std::string::npos) {
-        std::cout << ">>> 正在清理缓存..." << std::endl;
+        out() << ">>> 正在清理缓存..." << std::endl;
         bool ok = memControl->dropCache();
         if (ok) {
-            auto ms = memMonitor->getMemoryStatus();
-            std::cout << ">>> 清理完成。当前可用: " << ms.availableMB << " MB" << std::endl;
+            memMonitor->sample();
+            out() << ">>> 清理完成。当前可用: " << memMonitor->snapshot()->availableMB << " MB" << std::endl;
         } else {
-            std::cout << ">>> 失败: 权限不足 (必须 sudo)。" << std::endl;
+            out() << ">>> 失败: 权限不足 (必须 sudo)。" << std::endl;
         }
     }
-    std::cout << std::endl;
+    out() << std::endl;
 }
 
 // ==========================================
 //           功能区 3: 监控控制 (Monitor)
 // ==========================================
 
-std::string AiEngine::buildMonitorPrompt(const std::string& input) {
-    return "用户指令: [" + input + "]。\n"
-           "这是一个系统监控开关任务。请分类：\n"
-           "1. 开启监控/打开哨兵 -> [START_MONITOR]\n"
-           "2. 关闭监控/停止哨兵 -> [STOP_MONITOR]\n"
-           "3. 查询监控状态 -> [STATUS_MONITOR]\n"
-           "只回复标签。";
+AiEngine::Prompt AiEngine::buildMonitorPrompt(const std::string& input) {
+    return {"这是一个系统监控开关任务。把之后给出的用户指令分类：\n"
+            "1. 开启监控/打开哨兵 -> [START_MONITOR]\n"
+            "2. 关闭监控/停止哨兵 -> [STOP_MONITOR]\n"
+            "3. 查询监控状态 -> [STATUS_MONITOR]\n"
+            "只回复标签。",
+            userQuery(input)};
 }
 
 void AiEngine::runMonitorModule(const std::string& input) {
-    std::string resp = callOllama(buildMonitorPrompt(input));
+    std::string resp = classify("monitor", input, &AiEngine::buildMonitorPrompt, {"START_MONITOR", "STOP_MONITOR", "STATUS_MONITOR"});
+    auto guard = beginAction("monitor", resp);
+    if (!guard) return;
 
     if (resp.find("START_MONITOR") != std::string::npos) {
         startMonitor();
@@ -326,11 +1001,21 @@ void AiEngine::runMonitorModule(const std::string& input) {
         stopMonitor();
     }
     else if (resp.find("STATUS_MONITOR") != std::string::npos) {
-        if (isMonitorRunning) std::cout << ">>> [状态] 监控正在运行 (Active)。" << std::endl;
-        else std::cout << ">>> [状态] 监控处于关闭状态 (Inactive)。" << std::endl;
+        if (isMonitorRunning) {
+            out() << ">>> [状态] 监控正在运行 (Active)。" << std::endl;
+            for (const auto& src : monitorScheduler->status()) {
+                out() << "    " << src.name << ": 每 " << src.currentMs << " ms"
+                      << (src.currentMs > src.intervalMs ? " (超时退避中)" : "")
+                      << "，已运行 " << src.runs << " 次，超时 " << src.overruns << " 次" << std::endl;
+            }
+        }
+        else out() << ">>> [状态] 监控处于关闭状态 (Inactive)。" << std::endl;
+        for (const auto& t : psiMonitor->triggerStatus()) {
+            out() << "    PSI " << t.first.describe() << ": 已触发 " << t.second << " 次" << std::endl;
+        }
     }
     else {
-        std::cout << ">>> 未识别的监控指令。" << std::endl;
+        out() << ">>> 未识别的监控指令。" << std::endl;
     }
 }
 
@@ -338,70 +1023,129 @@ void AiEngine::runMonitorModule(const std::string& input) {
 //           功能区 3: 进程模块
 // ==========================================
 
-std::string AiEngine::buildProcPrompt(const std::string& input) {
+AiEngine::Prompt AiEngine::buildProcPrompt(const std::string& input) {
     // 专精于进程名转换，这是小模型最容易晕的地方，单独训练它
-    return "用户指令: [" + input + "]。\n"
-           "如果是查询，回复 [LIST]。\n"
-           "如果是杀进程，回复 [KILL:进程英文名]。\n"
-           "翻译规则：\n"
-           "- 火狐 -> firefox\n"
-           "- 谷歌/Chrome -> chrome\n"
-           "- 代码/VSCode -> code\n"
-           "- 终端 -> gnome-terminal\n"
-           "- 文本 -> gedit\n"
-           "只回复标签。";
+    return {"你是进程指令分类器。对之后给出的用户指令：\n"
+            "如果是查询，回复 [LIST]。\n"
+            "如果是杀进程，回复 [KILL:进程英文名]。\n"
+            "翻译规则：\n"
+            "- 火狐 -> firefox\n"
+            "- 谷歌/Chrome -> chrome\n"
+            "- 代码/VSCode -> code\n"
+            "- 终端 -> gnome-terminal\n"
+            "- 文本 -> gedit\n"
+            "只回复标签。",
+            userQuery(input)};
 }
 
 void AiEngine::runProcModule(const std::string& input) {
-    std::cout << "[进程模块] 处理中..." << std::endl;
+    out() << "[进程模块] 处理中..." << std::endl;
     
     // 特殊优化：如果用户只输入 "top" 或 "ps"，直接列出，不用 AI 思考
     if (input == "top" || input == "ps" || input == "进程") {
-        std::cout << ">>> 快速列表:" << std::endl;
+        auto guard = beginAction("proc", "LIST");
+        if (!guard) return;
+        out() << ">>> 快速列表:" << std::endl;
         auto procs = procMonitor->getTopCpuProcesses(5);
-        std::cout << "PID\tCPU%\tNAME" << std::endl;
-        for (auto& p : procs) std::cout << p.pid << "\t" << p.cpuPercent << "\t" << p.name << std::endl;
-        std::cout << std::endl;
+        out() << "PID\tCPU%\tNAME" << std::endl;
+        for (auto& p : procs) out() << p.pid << "\t" << p.cpuPercent << "\t" << p.name << std::endl;
+        out() << std::endl;
         return;
     }
 
     // 复杂指令才调用 AI
-    std::string resp = callOllama(buildProcPrompt(input));
+    std::string resp = classify("proc", input, &AiEngine::buildProcPrompt, {"LIST", "KILL:"});
+    if (resp.find("LIST") == std::string::npos && resp.find("KILL") != std::string::npos) {
+        runProcKill(resp);
+        out() << std::endl;
+        return;
+    }
 
+    auto guard = beginAction("proc", resp);
+    if (!guard) return;
     if (resp.find("LIST") != std::string::npos) {
         auto procs = procMonitor->getTopCpuProcesses(5);
-        std::cout << "PID\tCPU%\tNAME" << std::endl;
-        for (auto& p : procs) std::cout << p.pid << "\t" << p.cpuPercent << "\t" << p.name << std::endl;
+        out() << "PID\tCPU%\tNAME" << std::endl;
+        for (auto& p : procs) out() << p.pid << "\t" << p.cpuPercent << "\t" << p.name << std::endl;
     }
-    else if (resp.find("KILL") != std::string::npos) {
-        // 提取 [KILL:xxxx]
-        std::string name = "";
-        size_t s = resp.find(":");
-        size_t e = resp.find("]");
-        if (s != std::string::npos && e != std::string::npos) name = resp.substr(s+1, e-s-1);
-        
-        // 去空格
-        name.erase(0, name.find_first_not_of(" "));
-        name.erase(name.find_last_not_of(" ") + 1);
+    out() << std::endl;
+}
 
-        if (name.empty()) {
-            std::cout << ">>> AI 未能识别进程名。" << std::endl;
-        } else {
-            std::cout << ">>> 目标锁定: " << name << std::endl;
-            int pid = procMonitor->findPidByName(name);
-            if (pid > 0) {
-                // 实机保护：不杀 PID < 1000
-                if (pid < 1000) std::cout << ">>> 警告: 系统进程，禁止查杀。" << std::endl;
-                else {
-                    if (procControl->killProcess(pid)) std::cout << ">>> 进程已终止。" << std::endl;
-                    else std::cout << ">>> 终止失败 (权限不足?)。" << std::endl;
-                }
-            } else {
-                std::cout << ">>> 未找到运行中的进程: " << name << std::endl;
+void AiEngine::runProcKill(const std::string& label) {
+    // 提取 [KILL:xxxx]
+    std::string name = "";
+    size_t s = label.find(":");
+    size_t e = label.find("]");
+    if (s != std::string::npos && e != std::string::npos && e > s) name = label.substr(s + 1, e - s - 1);
+
+    // 去空格
+    name.erase(0, name.find_first_not_of(" "));
+    name.erase(name.find_last_not_of(" ") + 1);
+    if (name.empty()) {
+        out() << ">>> AI 未能识别进程名。" << std::endl;
+        return;
+    }
+
+    out() << ">>> 目标锁定: " << name << std::endl;
+    std::vector<ProcessInfo> matches;
+    bool exact = false;
+    {
+        // 查找只读快照；等用户回答期间不占着独占锁
+        auto guard = beginAction("proc", "LIST");
+        if (!guard) return;
+        matches = procMonitor->findProcessesByName(name, &exact);
+    }
+    if (matches.empty()) {
+        out() << ">>> 未找到运行中的进程: " << name << std::endl;
+        return;
+    }
+
+    ProcessInfo target = matches.front();
+    if (!exact || matches.size() > 1) {
+        // 模糊匹配 (名字或命令行包含它) 或者同名的不止一个：不替用户挑，列出来让用户选
+        const size_t kMaxCandidates = 10;
+        if (exact) out() << ">>> 共 " << matches.size() << " 个名为 " << name << " 的进程:" << std::endl;
+        else out() << ">>> 没有名为 " << name << " 的进程，名字或命令行包含它的有 " << matches.size() << " 个:" << std::endl;
+        size_t shown = std::min(matches.size(), kMaxCandidates);
+        out() << "  #\tPID\tCPU%\tNAME" << std::endl;
+        for (size_t i = 0; i < shown; ++i) {
+            out() << "  " << i + 1 << "\t" << matches[i].pid << "\t" << matches[i].cpuPercent << "\t"
+                  << matches[i].name << std::endl;
+        }
+        if (matches.size() > shown) out() << "  ... (只列出 CPU 最高的 " << shown << " 个)" << std::endl;
+
+        std::string choice = askUser(">>> 输入序号终止对应进程 (直接回车取消): ");
+        char* end = nullptr;
+        long idx = strtol(choice.c_str(), &end, 10);
+        if (choice.empty() || *end != '\0' || idx < 1 || idx > static_cast<long>(shown)) {
+            out() << ">>> 已取消。" << std::endl;
+            return;
+        }
+        target = matches[idx - 1];
+    }
+
+    // 实机保护：不杀 PID < 1000
+    if (target.pid < 1000) {
+        out() << ">>> 警告: 系统进程，禁止查杀。" << std::endl;
+        return;
+    }
+
+    auto guard = beginAction("proc", label);
+    if (!guard) return;
+    // 等用户回答期间进程可能已经退出、PID 被别的进程复用：按最新快照核对一次名字
+    bool alive = false;
+    {
+        auto snap = procMonitor->snapshot();
+        for (const auto& p : snap->procs) {
+            if (p.pid == target.pid) {
+                alive = (p.name == target.name);
+                break;
             }
         }
     }
-    std::cout << std::endl;
+    if (!alive) out() << ">>> 进程 " << target.pid << " (" << target.name << ") 已不在运行。" << std::endl;
+    else if (procControl->killProcess(target.pid)) out() << ">>> 进程已终止。" << std::endl;
+    else out() << ">>> 终止失败 (权限不足?)。" << std::endl;
 }
 
 // ==========================================
@@ -443,17 +1187,19 @@ double _getFileSizeFromInput(const std::string& input) {
     return 0.0;
 }
 
-std::string AiEngine::buildFilePrompt(const std::string& input) {
-    return "用户指令: [" + input + "]。\n"
-           "请分类：\n"
-           "1. [FIND_LARGE] (找大文件，如：大于1G，找文件，清理磁盘)\n"
-           "2. [SCAN_DISK] (强制重新扫描，建立索引)\n"
-           "只回复标签。";
+AiEngine::Prompt AiEngine::buildFilePrompt(const std::string& input) {
+    return {"你是磁盘文件指令分类器。把之后给出的用户指令分类：\n"
+            "1. [FIND_LARGE] (找大文件，如：大于1G，找文件，清理磁盘)\n"
+            "2. [SCAN_DISK] (强制重新扫描，建立索引)\n"
+            "只回复标签。",
+            userQuery(input)};
 }
 
 void AiEngine::runFileModule(const std::string& input) {
-    std::cout << "[DataRadar] 解析指令..." << std::endl;
-    std::string resp = callOllama(buildFilePrompt(input));
+    out() << "[DataRadar] 解析指令..." << std::endl;
+    std::string resp = classify("file", input, &AiEngine::buildFilePrompt, {"FIND_LARGE", "SCAN_DISK"});
+    auto guard = beginAction("file", resp);
+    if (!guard) return;
 
     // 1. C++ 强行介入：检查用户是否指定了大小
     double userSize = _getFileSizeFromInput(input);
@@ -464,66 +1210,66 @@ void AiEngine::runFileModule(const std::string& input) {
     if (hasSizeRequest || resp.find("FIND_LARGE") != std::string::npos) {
         double threshold = (userSize > 0) ? userSize : 100.0; // 有指定用指定的，没指定默认100M
         
-        std::cout << ">>> 正在检索大于 " << threshold << " MB 的文件..." << std::endl;
+        out() << ">>> 正在检索大于 " << threshold << " MB 的文件..." << std::endl;
         
         auto files = fileMonitor->getLargeFiles(threshold, 50);
         
         // 自动补救：如果没找到且索引为空，触发扫描
         if (files.empty()) {
-            std::cout << ">>> (索引为空，正在自动全盘扫描...)" << std::endl;
+            out() << ">>> (索引为空，正在自动全盘扫描...)" << std::endl;
             fileMonitor->scanDirectory(fileMonitor->getCurrentRoot());
             files = fileMonitor->getLargeFiles(threshold, 50);
         }
 
         if (files.empty()) {
-            std::cout << ">>> 未找到大于 " << threshold << " MB 的文件。" << std::endl;
+            out() << ">>> 未找到大于 " << threshold << " MB 的文件。" << std::endl;
         } else {
-            std::cout << "\n[大小]\t\t[路径] (Top " << files.size() << ")" << std::endl;
-            std::cout << "----------------------------------------" << std::endl;
+            out() << "\n[大小]\t\t[路径] (Top " << files.size() << ")" << std::endl;
+            out() << "----------------------------------------" << std::endl;
             for (const auto& f : files) {
-                std::cout << "[" << f.sizeStr << "]\t" << f.path << std::endl;
+                out() << "[" << f.sizeStr << "]\t" << f.path << std::endl;
             }
-            std::cout << "----------------------------------------\n" << std::endl;
+            out() << "----------------------------------------\n" << std::endl;
         }
     }
     // 情况 B：纯扫描 (用户只说了 "扫描" 且没提数字)
     else if (resp.find("SCAN_DISK") != std::string::npos) {
-        std::cout << ">>> 启动全盘扫描 (根目录: " << fileMonitor->getCurrentRoot() << ")..." << std::endl;
+        out() << ">>> 启动全盘扫描 (根目录: " << fileMonitor->getCurrentRoot() << ")..." << std::endl;
         int count = fileMonitor->scanDirectory(fileMonitor->getCurrentRoot());
-        std::cout << ">>> 扫描完成! 发现 " << count << " 个大文件 (>10MB)。" << std::endl;
+        out() << ">>> 扫描完成! 发现 " << count << " 个大文件 (>10MB)。" << std::endl;
         
         // 顺手展示一下最大的
         auto files = fileMonitor->getLargeFiles(100.0, 5);
         if (!files.empty()) {
-            std::cout << ">>> 最大的 5 个文件:" << std::endl;
-            for (const auto& f : files) std::cout << "[" << f.sizeStr << "]\t" << f.path << std::endl;
+            out() << ">>> 最大的 5 个文件:" << std::endl;
+            for (const auto& f : files) out() << "[" << f.sizeStr << "]\t" << f.path << std::endl;
         }
     }
     else {
         // 兜底
-        std::cout << ">>> 指令模糊，默认列出 >100MB 文件:" << std::endl;
+        out() << ">>> 指令模糊，默认列出 >100MB 文件:" << std::endl;
         auto files = fileMonitor->getLargeFiles(100.0, 20);
-        for (const auto& f : files) std::cout << "[" << f.sizeStr << "]\t" << f.path << std::endl;
+        for (const auto& f : files) out() << "[" << f.sizeStr << "]\t" << f.path << std::endl;
     }
-    std::cout << std::endl;
+    out() << std::endl;
 }
 
 // ==========================================
 //      功能区 5: 文件控制 (File Control)
 // ==========================================
 
-std::string AiEngine::buildFileControlPrompt(const std::string& input) {
-    return "用户指令: [" + input + "]。\n"
-           "这是一个文件操作任务。请分类：\n"
-           "1. 搜索/查找文件 -> [SEARCH:文件名]\n"
-           "2. 打开/运行文件 -> [OPEN:文件名]\n"
-           "3. 删除/移除文件 -> [DELETE:文件名]\n"
-           "只回复标签。";
+AiEngine::Prompt AiEngine::buildFileControlPrompt(const std::string& input) {
+    return {"这是一个文件操作任务。把之后给出的用户指令分类：\n"
+            "1. 搜索/查找文件 -> [SEARCH:文件名]\n"
+            "2. 打开/运行文件 -> [OPEN:文件名]\n"
+            "3. 删除/移除文件 -> [DELETE:文件名]\n"
+            "只回复标签。",
+            userQuery(input)};
 }
 
 void AiEngine::runFileControlModule(const std::string& input) {
-    std::cout << "[FileControl] 处理操作指令..." << std::endl;
-    std::string resp = callOllama(buildFileControlPrompt(input));
+    out() << "[FileControl] 处理操作指令..." << std::endl;
+    std::string resp = classify("file_control", input, &AiEngine::buildFileControlPrompt, {"SEARCH:", "OPEN:", "DELETE:"});
 
     // 提取文件名
     std::string targetName = "";
@@ -538,59 +1284,72 @@ void AiEngine::runFileControlModule(const std::string& input) {
     }
 
     if (targetName.empty()) {
-        std::cout << ">>> AI 无法识别文件名，请说清楚点。" << std::endl;
+        out() << ">>> AI 无法识别文件名，请说清楚点。" << std::endl;
+        return;
+    }
+
+    // 删除要等用户确认，不能整段持有独占锁：定位只按查询加锁，确认在锁外，独占锁只包住删除本身
+    if (resp.find("DELETE") != std::string::npos) {
+        runFileDelete(targetName, resp);
         return;
     }
+    auto guard = beginAction("file_control", resp);
+    if (!guard) return;
 
     // === 逻辑：先搜索，再操作 ===
     
     // 1. 搜索
     if (resp.find("SEARCH") != std::string::npos) {
-        std::cout << ">>> 正在搜索: " << targetName << " ..." << std::endl;
+        out() << ">>> 正在搜索: " << targetName << " ..." << std::endl;
         auto results = fileControl->searchFile(targetName);
-        if (results.empty()) std::cout << ">>> 未找到。" << std::endl;
+        if (results.empty()) out() << ">>> 未找到。" << std::endl;
         else {
-            std::cout << ">>> 找到 " << results.size() << " 个文件:" << std::endl;
-            for (const auto& path : results) std::cout << " - " << path << std::endl;
+            out() << ">>> 找到 " << results.size() << " 个文件:" << std::endl;
+            for (const auto& path : results) out() << " - " << path << std::endl;
         }
     }
     // 2. 打开
     else if (resp.find("OPEN") != std::string::npos) {
-        std::cout << ">>> 正在定位: " << targetName << " ..." << std::endl;
+        out() << ">>> 正在定位: " << targetName << " ..." << std::endl;
         auto results = fileControl->searchFile(targetName);
         
         if (results.empty()) {
-            std::cout << ">>> 找不到文件，无法打开。" << std::endl;
+            out() << ">>> 找不到文件，无法打开。" << std::endl;
         } else if (results.size() == 1) {
-            std::cout << ">>> 打开: " << results[0] << std::endl;
+            out() << ">>> 打开: " << results[0] << std::endl;
             fileControl->openFile(results[0]);
         } else {
-            std::cout << ">>> 找到多个文件，请指定全名:" << std::endl;
-            for (const auto& path : results) std::cout << " - " << path << std::endl;
+            out() << ">>> 找到多个文件，请指定全名:" << std::endl;
+            for (const auto& path : results) out() << " - " << path << std::endl;
         }
     }
-    // 3. 删除
-    else if (resp.find("DELETE") != std::string::npos) {
-        std::cout << ">>> [危险] 正在定位: " << targetName << " ..." << std::endl;
-        auto results = fileControl->searchFile(targetName);
-        
-        if (results.empty()) {
-            std::cout << ">>> 文件不存在。" << std::endl;
-        } else if (results.size() == 1) {
-            std::cout << ">>> 目标: " << results[0] << std::endl;
-            std::cout << ">>> 确认删除? (输入 yes): ";
-            std::string confirm;
-            std::getline(std::cin, confirm);
-            if (confirm == "yes") {
-                if (fileControl->deleteFile(results[0])) std::cout << ">>> 已删除。" << std::endl;
-                else std::cout << ">>> 删除失败。" << std::endl;
-            } else {
-                std::cout << ">>> 已取消。" << std::endl;
-            }
+}
+
+void AiEngine::runFileDelete(const std::string& targetName, const std::string& label) {
+    out() << ">>> [危险] 正在定位: " << targetName << " ..." << std::endl;
+    std::vector<std::string> results;
+    {
+        auto guard = beginAction("file_control", "[SEARCH]");
+        if (!guard) return;
+        results = fileControl->searchFile(targetName);
+    }
+
+    if (results.empty()) {
+        out() << ">>> 文件不存在。" << std::endl;
+    } else if (results.size() == 1) {
+        out() << ">>> 目标: " << results[0] << std::endl;
+        std::string confirm = askUser(">>> 确认删除? (输入 yes): ");
+        if (confirm == "yes") {
+            auto guard = beginAction("file_control", label);
+            if (!guard) return;
+            if (fileControl->deleteFile(results[0])) out() << ">>> 已删除。" << std::endl;
+            else out() << ">>> 删除失败。" << std::endl;
         } else {
-            std::cout << ">>> 找到多个文件，无法模糊删除:" << std::endl;
-            for (const auto& path : results) std::cout << " - " << path << std::endl;
+            out() << ">>> 已取消。" << std::endl;
         }
+    } else {
+        out() << ">>> 找到多个文件，无法模糊删除:" << std::endl;
+        for (const auto& path : results) out() << " - " << path << std::endl;
     }
 }
 
@@ -598,18 +1357,18 @@ void AiEngine::runFileControlModule(const std::string& input) {
 //           功能区 6: 文件创建 (FileCreator)
 // ==========================================
 
-std::string AiEngine::buildFileCreatePrompt(const std::string& input) {
-    return "用户指令: [" + input + "]。\n"
-           "这是一个创建文件的任务。\n"
-           "请提取用户想要创建的文件路径或文件名。\n"
-           "格式: [CREATE:文件名]\n"
-           "如果用户没指定后缀，默认加上 .txt\n"
-           "只回复标签。";
+AiEngine::Prompt AiEngine::buildFileCreatePrompt(const std::string& input) {
+    return {"这是一个创建文件的任务。\n"
+            "请从之后给出的用户指令中提取用户想要创建的文件路径或文件名。\n"
+            "格式: [CREATE:文件名]\n"
+            "如果用户没指定后缀，默认加上 .txt\n"
+            "只回复标签。",
+            userQuery(input)};
 }
 
 void AiEngine::runFileCreateModule(const std::string& input) {
-    std::cout << "[FileCreator] 解析创建指令..." << std::endl;
-    std::string resp = callOllama(buildFileCreatePrompt(input));
+    out() << "[FileCreator] 解析创建指令..." << std::endl;
+    std::string resp = classify("file_create", input, &AiEngine::buildFileCreatePrompt, {"CREATE:"});
 
     std::string fileName = "";
     if (resp.find("CREATE:") != std::string::npos) {
@@ -622,27 +1381,25 @@ void AiEngine::runFileCreateModule(const std::string& input) {
     }
 
     if (fileName.empty()) {
-        std::cout << ">>> AI 没听懂你想创建什么文件名，请重试。" << std::endl;
+        out() << ">>> AI 没听懂你想创建什么文件名，请重试。" << std::endl;
         return;
     }
 
     // 强制 .txt 检查 (虽然 FileCreator 也会检查，这里做个预判更好)
     if (fileName.find(".txt") == std::string::npos) {
         fileName += ".txt";
-        std::cout << ">>> (自动添加 .txt 后缀)" << std::endl;
+        out() << ">>> (自动添加 .txt 后缀)" << std::endl;
     }
 
-    std::cout << ">>> 准备创建文件: " << fileName << std::endl;
+    out() << ">>> 准备创建文件: " << fileName << std::endl;
     
     // === 交互环节 ===
-    std::cout << ">>> 是否需要 AI 自动生成一些日志/内容写入该文件? (yes/no): ";
-    std::string choice;
-    std::getline(std::cin, choice);
+    std::string choice = askUser(">>> 是否需要 AI 自动生成一些日志/内容写入该文件? (yes/no): ");
 
     std::string contentToWrite = "";
 
     if (choice == "yes" || choice == "y") {
-        std::cout << ">>> AI 正在生成日志内容..." << std::endl;
+        out() << ">>> AI 正在生成日志内容..." << std::endl;
         // 让 AI 生成一段假日志
         std::string logPrompt = "请生成一段简短的、看起来很专业的系统运行日志，包含时间戳，3行左右。不要包含其他解释。";
         contentToWrite = callOllama(logPrompt);
@@ -650,16 +1407,240 @@ void AiEngine::runFileCreateModule(const std::string& input) {
         // 清理一下 AI 回复里可能带的引号
         contentToWrite.erase(std::remove(contentToWrite.begin(), contentToWrite.end(), '"'), contentToWrite.end());
         
-        std::cout << ">>> 生成内容预览:\n" << contentToWrite << std::endl;
+        out() << ">>> 生成内容预览:\n" << contentToWrite << std::endl;
     } else {
-        std::cout << ">>> 已跳过内容生成，将创建一个空文件。" << std::endl;
+        out() << ">>> 已跳过内容生成，将创建一个空文件。" << std::endl;
     }
 
-    // 执行创建
+    // 追问和生成内容都在锁外，独占锁只包住写文件
+    auto guard = beginAction("file_create", resp);
+    if (!guard) return;
     if (fileCreator->createTxtFile(fileName, contentToWrite)) {
-        std::cout << ">>> [成功] 文件已创建。" << std::endl;
+        out() << ">>> [成功] 文件已创建。" << std::endl;
     } else {
-        std::cout << ">>> [失败] 创建过程出错。" << std::endl;
+        out() << ">>> [失败] 创建过程出错。" << std::endl;
+    }
+}
+
+// ==========================================
+//           异步指令管线
+// ==========================================
+
+bool AiEngine::isCancelled() const {
+    return tlsCancel && tlsCancel->load();
+}
+
+AiEngine::ActionGuard AiEngine::beginAction(const std::string& module, const std::string& label,
+                                            LatencyStats::Stage stage) {
+    // 会改变系统状态的动作彼此串行，也不和任何查询并发
+    static const char* kMutating[] = {"BOOST", "RESTORE", "CLEAN", "KILL", "DELETE", "CREATE",
+                                      "START_MONITOR", "STOP_MONITOR"};
+    ActionGuard g;
+    if (isCancelled()) return g;
+    int moduleIdx = latency->moduleIndex(module);
+    LatencyStats::Span wait(latency.get(), moduleIdx, LatencyStats::LOCK_WAIT);
+
+    bool mutating = false;
+    for (const char* tag : kMutating) {
+        if (label.find(tag) != std::string::npos) mutating = true;
+    }
+    if (mutating) g.exclusive = std::unique_lock<std::shared_mutex>(actionLock);
+    else g.shared = std::shared_lock<std::shared_mutex>(actionLock);
+    g.module = std::unique_lock<std::mutex>(moduleLocks.at(module));
+
+    wait.stop();
+
+    // 排队等锁期间可能已被取消
+    g.ok = !isCancelled();
+    if (g.ok) g.timing = std::make_unique<LatencyStats::Span>(latency.get(), moduleIdx, stage);
+    return g;
+}
+
+std::string AiEngine::askUser(const std::string& question) {
+    // 不在工作线程里 (没有指令缓冲区) 时直接读终端
+    if (tlsOut == &std::cout) {
+        std::cout << question << std::flush;
+        std::string line;
+        std::getline(std::cin, line);
+        return line;
+    }
+
+    // 把目前为止的输出连同问题一起交给主循环显示，回答经 promise 传回
+    std::ostringstream* buf = static_cast<std::ostringstream*>(tlsOut);
+    LoopEvent ev{LoopEvent::QUESTION, tlsCommandId, buf->str() + question,
+                 std::make_shared<std::promise<std::string>>()};
+    buf->str("");
+    std::future<std::string> answer = ev.answer->get_future();
+    postEvent(std::move(ev));
+
+    while (answer.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready) {
+        if (isCancelled()) return "";
+    }
+    return answer.get();
+}
+
+void AiEngine::postEvent(LoopEvent ev) {
+    {
+        std::lock_guard<std::mutex> g(eventLock);
+        events.push_back(std::move(ev));
+    }
+    uint64_t one = 1;
+    if (write(eventFd, &one, sizeof(one)) < 0) {
+        // 计数器溢出才会失败，此时主循环本来就有未处理的唤醒
+    }
+}
+
+void AiEngine::submitCommand(const std::string& input) {
+    auto cmd = std::make_shared<Command>();
+    cmd->id = nextCommandId++;
+    cmd->input = input;
+    cmd->cancelled = false;
+    running[cmd->id] = cmd;
+
+    cmd->done = workers->submit([this, cmd]() {
+        tlsOut = &cmd->output;
+        tlsCancel = &cmd->cancelled;
+        tlsCommandId = cmd->id;
+        try {
+            routeAndProcess(cmd->input);
+        } catch (const std::exception& e) {
+            cmd->output << "[Error] " << e.what() << std::endl;
+        }
+        tlsOut = &std::cout;
+        tlsCancel = nullptr;
+        tlsCommandId = 0;
+        postEvent({LoopEvent::COMPLETED, cmd->id, "", nullptr});
+    });
+}
+
+void AiEngine::answerQuestion(LoopEvent& question, const std::string& answer) {
+    question.answer->set_value(answer);
+}
+
+void AiEngine::cancelCommands(int id) {
+    int count = 0;
+    for (auto& kv : running) {
+        if (id > 0 && kv.first != id) continue;
+        kv.second->cancelled = true;
+        count++;
+    }
+    // 被取消的指令如果正在等回答，它的问题也作废
+    for (auto it = pendingQuestions.begin(); it != pendingQuestions.end();) {
+        if (id <= 0 || it->commandId == id) {
+            answerQuestion(*it, "");
+            it = pendingQuestions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (count == 0) std::cout << ">>> 没有可取消的指令。" << std::endl;
+    else std::cout << ">>> 已请求取消 " << count << " 条指令。" << std::endl;
+    promptShown = false;
+}
+
+void AiEngine::handleLine(const std::string& line) {
+    // 取消、查看、统计永远立即生效，不排队，也不会被当成追问的回答
+    if (line == "cancel" || line.compare(0, 7, "cancel ") == 0) {
+        int id = (line.size() > 7) ? std::atoi(line.c_str() + 7) : 0;
+        cancelCommands(id);
+        return;
+    }
+    if (line == "stats") {
+        latency->report(std::cout);
+        promptShown = false;
+        return;
+    }
+    if (line == "history") {
+        std::cout << ">>> 最近 " << kHistoryWindowMs / 1000 << " 秒 (历史共占 "
+                  << history->memoryBytes() / 1024 << " KB):" << std::endl;
+        history->report(std::cout, kHistoryWindowMs);
+        if (store) {
+            MetricStore::Stats st = store->stats();
+            std::cout << std::fixed << std::setprecision(1);
+            std::cout << ">>> 磁盘历史: " << st.series << " 个指标 " << st.points << " 个点，跨度 "
+                      << (st.newestMs - st.oldestMs) / 3600000.0 << " 小时，占用 " << st.usedBytes / 1024 << " KB";
+            if (st.points > 0) std::cout << " (每点 " << static_cast<double>(st.usedBytes) / st.points << " 字节)";
+            std::cout << "；'history <指标> [时长] [步长]' 查看走势" << std::endl;
+            std::cout.unsetf(std::ios::floatfield);
+            std::cout << std::setprecision(6);
+        }
+        promptShown = false;
+        return;
+    }
+    if (line.compare(0, 8, "history ") == 0) {
+        showStoredHistory(line.substr(8));
+        promptShown = false;
+        return;
+    }
+    if (line == "pressure") {
+        showPressure();
+        promptShown = false;
+        return;
+    }
+    if (line == "jobs") {
+        if (running.empty()) std::cout << ">>> 没有正在执行的指令。" << std::endl;
+        for (const auto& kv : running) {
+            std::cout << ">>> [#" << kv.first << "] " << kv.second->input
+                      << (kv.second->cancelled ? " (取消中)" : "") << std::endl;
+        }
+        promptShown = false;
+        return;
+    }
+    if (!pendingQuestions.empty()) {
+        answerQuestion(pendingQuestions.front(), line);
+        pendingQuestions.pop_front();
+        promptShown = false;
+        return;
+    }
+    if (line == "exit") {
+        inputClosed = true;
+        return;
+    }
+    if (line.empty()) {
+        promptShown = false;
+        return;
+    }
+
+    // 核心入口：先分流，再处理 (在工作线程上)
+    submitCommand(line);
+    promptShown = false;
+}
+
+void AiEngine::handleEvents() {
+    std::deque<LoopEvent> batch;
+    {
+        std::lock_guard<std::mutex> g(eventLock);
+        batch.swap(events);
+    }
+
+    for (auto& ev : batch) {
+        if (ev.type == LoopEvent::MESSAGE) {
+            std::cout << "\r\033[K" << ev.text << std::flush;
+            promptShown = false;
+        }
+        else if (ev.type == LoopEvent::QUESTION) {
+            std::cout << "\r\033[K" << ev.text << std::flush;
+            // 只有问题显示出来之后输入的行才算回答，之前的行已经作为新指令提交
+            if (inputClosed) {
+                std::cout << std::endl;
+                answerQuestion(ev, "");
+                promptShown = false;
+            } else {
+                pendingQuestions.push_back(ev);
+                promptShown = true;   // 问题本身就是提示符
+            }
+        }
+        else {
+            auto it = running.find(ev.commandId);
+            if (it == running.end()) continue;
+            std::shared_ptr<Command> cmd = it->second;
+            running.erase(it);
+            cmd->done.wait();
+            std::cout << "\r\033[K" << cmd->output.str();
+            if (cmd->cancelled) std::cout << ">>> [#" << cmd->id << "] 已取消。" << std::endl;
+            std::cout << std::flush;
+            promptShown = false;
+        }
     }
 }
 
@@ -669,16 +1650,59 @@ void AiEngine::runFileCreateModule(const std::string& input) {
 
 void AiEngine::start() {
     std::cout << "\n=== AIOS Dome v0.8 (物理分块版) ===" << std::endl;
-    std::cout << "输入 'exit' 退出。" << std::endl;
-    
-    std::string input;
-    while (true) {
-        std::cout << "Admin@AIOS:~$ ";
-        std::getline(std::cin, input);
-        if (input == "exit") break;
-        if (input.empty()) continue;
-        
-        // 核心入口：先分流，再处理
-        routeAndProcess(input);
+    std::cout << "输入 'exit' 退出；指令在后台执行，'jobs' 查看，'stats' 看耗时，'history' 看指标走势，'pressure' 看资源停顿，'cancel [编号]' 取消。" << std::endl;
+
+    // 主线程只负责读输入和打印结果，模型思考期间仍可继续输入
+    std::string pending;
+    bool stdinOpen = true;
+    while (!(inputClosed && running.empty())) {
+        if (!inputClosed && !promptShown && pendingQuestions.empty()) {
+            std::cout << "Admin@AIOS:~$ " << std::flush;
+            promptShown = true;
+        }
+
+        pollfd fds[2] = {{eventFd, POLLIN, 0}, {STDIN_FILENO, POLLIN, 0}};
+        nfds_t nfds = (stdinOpen && !inputClosed) ? 2 : 1;
+        if (poll(fds, nfds, -1) < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "[Error] poll: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            uint64_t count;
+            if (read(eventFd, &count, sizeof(count)) < 0) {
+                // EAGAIN：已被上一轮读走
+            }
+            handleEvents();
+        }
+
+        if (nfds == 2 && (fds[1].revents & (POLLIN | POLLHUP | POLLERR))) {
+            char buf[4096];
+            ssize_t n = read(STDIN_FILENO, buf, sizeof(buf));
+            if (n <= 0) {
+                if (n < 0 && errno == EINTR) continue;
+                // 输入结束：剩下的半行也算一行，之后的追问一律按空回答处理
+                stdinOpen = false;
+                if (!pending.empty()) handleLine(pending);
+                pending.clear();
+                inputClosed = true;
+                while (!pendingQuestions.empty()) {
+                    answerQuestion(pendingQuestions.front(), "");
+                    pendingQuestions.pop_front();
+                }
+                continue;
+            }
+            pending.append(buf, n);
+            size_t start = 0;
+            size_t nl;
+            while (!inputClosed && (nl = pending.find('\n', start)) != std::string::npos) {
+                std::string line = pending.substr(start, nl - start);
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                start = nl + 1;
+                handleLine(line);
+            }
+            pending.erase(0, start);
+        }
     }
-}
\ No newline at end of file
+}
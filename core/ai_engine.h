@@ -11,17 +11,37 @@
 #include <vector>
 #include <thread> // 新增: 线程库
 #include <atomic> // 新增: 原子变量控制线程退出
+#include <map>
+#include <unordered_map>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <shared_mutex>
+#include <future>
+#include <chrono>
+#include <sstream>
 
 // 引入硬件模块
 #include "modules/cpu/cpu_monitor.h"
 #include "modules/cpu/cpu_control.h"
 #include "modules/memory/mem_monitor.h"
 #include "modules/memory/mem_control.h"
+#include "modules/pressure/psi_monitor.h"
 #include "process/proc_monitor.h"
 #include "process/proc_control.h"
 #include "file/file_monitor.h"
 #include "file/file_control.h"
 #include "file/file_creator.h"
+#include "core/http_client.h"
+#include "core/intent_cache.h"
+#include "core/intent_classifier.h"
+#include "core/keyword_router.h"
+#include "core/task_pool.h"
+#include "core/prompt_context.h"
+#include "core/latency_stats.h"
+#include "core/sampling_scheduler.h"
+#include "core/metric_series.h"
+#include "core/metric_store.h"
 
 class AiEngine {
 public:
@@ -36,6 +56,7 @@ private:
     std::unique_ptr<CpuControl> cpuControl;
     std::unique_ptr<MemMonitor> memMonitor;
     std::unique_ptr<MemControl> memControl;
+    std::unique_ptr<PsiMonitor> psiMonitor;   // 压力停顿：哨兵的触发器和 'pressure' 查询
     std::unique_ptr<ProcMonitor> procMonitor;
     std::unique_ptr<ProcControl> procControl;
     std::unique_ptr<FileMonitor> fileMonitor; // 新增：数据雷达
@@ -44,17 +65,109 @@ private:
 
     const std::string modelName = "qwen2.5-coder:1.5b"; 
     const std::string ollamaUrl = "http://localhost:11434/api/generate";
+    std::string ollamaHost;             // 由 ollamaUrl 解析
+    int ollamaPort;
+    std::string ollamaPath;
+    // 与 Ollama 的持久连接池：并发的指令各借一条连接，用完归还
+    std::vector<std::unique_ptr<HttpClient>> idleClients;
+    std::mutex clientLock;
+    std::unique_ptr<HttpClient> acquireClient();
+    void releaseClient(std::unique_ptr<HttpClient> client);
+    std::unique_ptr<IntentCache> intentCache; // 常用指令的分类结果缓存
+    std::unique_ptr<IntentClassifier> localModel; // 本地意图分类器 (LLM 之前的快速路径)
+    std::unique_ptr<PromptContextCache> promptContexts; // 各模块固定说明的 context
+    std::unique_ptr<LatencyStats> latency;  // 各模块各阶段耗时，'stats' 查看，退出时写 JSON
+    // 指纹的 /api/show 请求不在锁内发：同一时刻只有一个线程去取，其余的在 modelStampCv 上等结果
+    std::mutex modelStampLock;
+    std::condition_variable modelStampCv;
+    std::string modelStamp;             // 模型名 + 修改时间 + 模板，空表示还没取到
+    std::chrono::steady_clock::time_point modelStampAt;   // 上次取到指纹的时间
+    bool modelStampFetching = false;    // 有线程正在请求 /api/show
+    uint64_t modelStampFetches = 0;     // 完成 (成功或失败) 的请求次数，等待者据此判断那次请求结束了
+    std::atomic<bool> shuttingDown;     // 析构时置位，中断后台预热请求
 
     // === 后台监控相关 ===
     std::atomic<bool> isMonitorRunning; // 标记当前是否正在运行
-    std::atomic<bool> keepRunning; // 控制线程开关
-    std::thread monitorThread;     // 监控线程对象
-    void backgroundMonitorTask();  // 线程要执行的具体函数
+    std::unique_ptr<SamplingScheduler> monitorScheduler; // 每个检查项一个定时器，各跑各的周期
+    void checkNewProcesses();      // 采样源：新进程
+    void checkAbnormalProcesses(); // 采样源：高负载进程 (内核没有 PSI 触发器时才定时跑)
+    void onPressure(const PsiTrigger& trigger, const PsiStatus& status);   // PSI 触发器越线 (监听线程)
+    std::map<std::string, std::chrono::steady_clock::time_point> lastPressureAlert;   // 只在 PSI 监听线程上访问
+    void showPressure();
     void startMonitor();          // 启动线程 (封装)
     void stopMonitor();           // 停止线程 (封装)
     
+    // === 异步指令管线 ===
+    // 主循环用 poll 同时等待 stdin 和事件 (指令完成 / 哨兵消息 / 指令追问)，
+    // 指令交给工作线程执行，模型思考期间输入不被阻塞
+    struct Command {
+        int id;
+        std::string input;
+        std::atomic<bool> cancelled;
+        std::ostringstream output;     // 指令输出先写这里，完成后整块打印
+        std::future<void> done;
+    };
+    struct LoopEvent {
+        enum Type { COMPLETED, MESSAGE, QUESTION };
+        Type type;
+        int commandId;
+        std::string text;
+        std::shared_ptr<std::promise<std::string>> answer;  // QUESTION 的回答
+    };
+    std::unique_ptr<TaskPool> workers;
+    int eventFd;                       // 有新事件时写入，唤醒主循环
+    std::mutex eventLock;
+    std::deque<LoopEvent> events;
+    // 以下只在主循环线程访问
+    int nextCommandId;
+    bool inputClosed;                  // 已 exit 或 stdin 已结束
+    bool promptShown;
+    std::map<int, std::shared_ptr<Command>> running;
+    std::deque<LoopEvent> pendingQuestions;
+
+    void postEvent(LoopEvent ev);
+    void submitCommand(const std::string& input);
+    void handleLine(const std::string& line);
+    void handleEvents();
+    void answerQuestion(LoopEvent& question, const std::string& answer);
+    void cancelCommands(int id);       // id <= 0 表示全部
+    std::string askUser(const std::string& question);
+    bool isCancelled() const;
+
+    // === 并发控制 ===
+    // 只读动作共享 actionLock，修改系统状态的动作 (BOOST/CLEAN/KILL/DELETE...) 独占；
+    // 同一模块的动作互斥。加锁顺序固定为 actionLock -> 模块锁。
+    struct ActionGuard {
+        std::shared_lock<std::shared_mutex> shared;
+        std::unique_lock<std::shared_mutex> exclusive;
+        std::unique_lock<std::mutex> module;
+        std::unique_ptr<LatencyStats::Span> timing;   // 先于锁析构：只计持锁执行的时间
+        bool ok = false;
+        explicit operator bool() const { return ok; }
+    };
+    std::shared_mutex actionLock;
+    std::map<std::string, std::mutex> moduleLocks;   // 构造时建好，之后只读
+    ActionGuard beginAction(const std::string& module, const std::string& label,
+                            LatencyStats::Stage stage = LatencyStats::ACTION);
+
+    // === 快照采样 ===
+    // samplers 周期性地让 CPU/内存/进程监控读一遍 /proc 并发布快照 (耗时记在 probe 阶段)，
+    // 指令和哨兵只读最新快照，无锁，也不会因为查询触发新的读取。
+    // probes 只跑后台预热之类不等指令的任务。
+    std::unique_ptr<SamplingScheduler> samplers;
+    std::unique_ptr<TaskPool> probes;
+    void startSamplers();
+    // 每次采样后把关键读数追加进各自的环形时间序列，'history' 查看最近一段的统计
+    std::unique_ptr<MetricHistory> history;
+    // 同样的读数和 CPU/内存前几名进程的用量再追加到磁盘，保留数天，'history <指标>' 查询
+    std::unique_ptr<MetricStore> store;
+    std::unordered_map<std::string, std::pair<double, double>> procTotals;   // 同名进程合并 (采样线程专用)
+    void recordProcessHistory(const ProcTable& table, int64_t nowMs);
+    void showStoredHistory(const std::string& args);
+
     // === 核心路由 ===
     // 负责判断用户是在说哪个领域的话
+    KeywordRouter router;
     void routeAndProcess(const std::string& input);
    
 
@@ -62,23 +175,46 @@ private:
     void runCpuModule(const std::string& input);
     void runMemModule(const std::string& input);
     void runProcModule(const std::string& input);
+    void runProcKill(const std::string& label);   // 模糊或多个匹配时先列出候选让用户选，确认在锁外
     void runMonitorModule(const std::string& input);
     void runFileModule(const std::string& input); // 新增处理函数
     void runFileControlModule(const std::string& input); // 新增功能区 (负责搜索/打开/删除)
+    void runFileDelete(const std::string& targetName, const std::string& label); // 确认在锁外，只对删除本身加独占锁
     void runFileCreateModule(const std::string& input); // 新增处理函数
 
     // === 独立提示词生成器 ===
-    std::string buildCpuPrompt(const std::string& input);
-    std::string buildMemPrompt(const std::string& input);
-    std::string buildProcPrompt(const std::string& input);
-    std::string buildMonitorPrompt(const std::string& input);
-    std::string buildFilePrompt(const std::string& input); // 新增 Prompt
-    std::string buildFileControlPrompt(const std::string& input); // 新增 Prompt
-    std::string buildFileCreatePrompt(const std::string& input); // 新增 Prompt
+    // 提示词分两段：固定说明在前 (预热一次，之后用 context 复用)，用户指令在后
+    struct Prompt {
+        std::string preamble;
+        std::string query;
+        std::string full() const { return preamble + "\n" + query; }
+    };
+    Prompt buildCpuPrompt(const std::string& input);
+    Prompt buildMemPrompt(const std::string& input);
+    Prompt buildProcPrompt(const std::string& input);
+    Prompt buildMonitorPrompt(const std::string& input);
+    Prompt buildFilePrompt(const std::string& input); // 新增 Prompt
+    Prompt buildFileControlPrompt(const std::string& input); // 新增 Prompt
+    Prompt buildFileCreatePrompt(const std::string& input); // 新增 Prompt
+    using PromptBuilder = Prompt (AiEngine::*)(const std::string& input);
 
     // === 通用工具 ===
-    std::string callOllama(const std::string& prompt);
-    std::string extractJson(const std::string& json);
+    // 模块分类入口：先查意图缓存，再问本地分类器，都没把握才问 LLM，得到完整标签后写回缓存
+    // (提示词只在真正要问 LLM 时才生成)
+    std::string classify(const std::string& module, const std::string& input,
+                         PromptBuilder build, const std::vector<std::string>& labels);
+    // labels 非空时走流式接口：一旦输出中出现完整标签就立即中断生成
+    // context 非空时接在这段 token 之后继续 (只发送 prompt 本身)
+    // httpStatus 非空时写入 HTTP 状态码 (请求失败、没收到响应时为 0)
+    std::string callOllama(const std::string& prompt, const std::vector<std::string>& labels = {},
+                           const std::string& context = "", int* httpStatus = nullptr);
+    // 取模块说明对应的 context，没有就预热一次；模型不可用时返回空字符串
+    std::string moduleContext(const std::string& module, const std::string& preamble);
+    bool loadModelStamp(std::string& stamp);
+    bool warmPrompt(const std::string& preamble, std::string& context);
+    void prewarmContexts();
+    // 取出一个回复对象里的 "response" 字段 (反转义后写入 out)
+    bool extractJson(const char* data, size_t len, std::string& out);
 };
 
 #endif // AI_ENGINE_H
\ No newline at end of file
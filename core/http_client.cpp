@@ -0,0 +1,397 @@
+/**
+ * @file http_client.cpp
+ * @brief 极简 HTTP/1.1 客户端实现
+ */
+
+#include "core/http_client.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace {
+
+std::string lowerAscii(std::string s) {
+    for (auto& c : s) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+    return s;
+}
+
+std::string trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t");
+    if (b == std::string::npos) return "";
+    size_t e = s.find_last_not_of(" \t");
+    return s.substr(b, e - b + 1);
+}
+
+const int kCancelCheckMs = 100;   // 等待时多久检查一次取消标志
+
+// 块大小行：十六进制数字，之后可以有 ";扩展"
+bool parseChunkSize(const std::string& line, size_t& size) {
+    size = 0;
+    size_t i = 0;
+    for (; i < line.size(); ++i) {
+        char c = line[i];
+        int digit;
+        if (c >= '0' && c <= '9') digit = c - '0';
+        else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+        else break;
+        if (size > (static_cast<size_t>(-1) >> 4)) return false;
+        size = (size << 4) | static_cast<size_t>(digit);
+    }
+    if (i == 0) return false;
+    while (i < line.size() && (line[i] == ' ' || line[i] == '\t')) ++i;
+    return i == line.size() || line[i] == ';';
+}
+
+} // namespace
+
+HttpClient::HttpClient(const std::string& h, int p)
+    : host(h), port(p), fd(-1), connectTimeoutMs(2000), ioTimeoutMs(60000), responseTimeoutMs(600000),
+      readTimeoutMs(60000), cancel(nullptr), inPos(0), peerClosed(false), gotEof(false),
+      gotBytes(false) {}
+
+HttpClient::~HttpClient() {
+    closeSocket();
+}
+
+bool HttpClient::parseUrl(const std::string& url, std::string& outHost, int& outPort, std::string& outPath) {
+    const std::string scheme = "http://";
+    if (url.compare(0, scheme.size(), scheme) != 0) return false;
+
+    size_t hostBegin = scheme.size();
+    size_t pathBegin = url.find('/', hostBegin);
+    std::string authority = url.substr(hostBegin, pathBegin == std::string::npos ? std::string::npos : pathBegin - hostBegin);
+    outPath = (pathBegin == std::string::npos) ? "/" : url.substr(pathBegin);
+
+    outPort = 80;
+    size_t colon = authority.rfind(':');
+    size_t bracket = authority.rfind(']');
+    if (colon != std::string::npos && (bracket == std::string::npos || colon > bracket)) {
+        outPort = atoi(authority.c_str() + colon + 1);
+        authority.resize(colon);
+    }
+    if (authority.size() > 2 && authority.front() == '[' && authority.back() == ']') {
+        authority = authority.substr(1, authority.size() - 2);  // [::1]
+    }
+    outHost = authority;
+    return !outHost.empty() && outPort > 0 && outPort < 65536;
+}
+
+// 等待 sock 可读/可写；超时 (timeoutMs < 0 表示不限)、出错或被取消时返回 false 并设置 error
+bool HttpClient::waitReady(int sock, short events, int timeoutMs) {
+    pollfd p{sock, events, 0};
+    int waited = 0;
+    for (;;) {
+        if (cancel && cancel->load()) {
+            error = "cancelled";
+            return false;
+        }
+        int slice = (timeoutMs < 0) ? kCancelCheckMs : std::min(kCancelCheckMs, timeoutMs - waited);
+        int n = poll(&p, 1, slice);
+        if (n > 0) return true;
+        if (n < 0 && errno != EINTR) {
+            error = std::string("poll: ") + strerror(errno);
+            return false;
+        }
+        if (n == 0) waited += slice;
+        if (timeoutMs >= 0 && waited >= timeoutMs) {
+            error = "timeout";
+            return false;
+        }
+    }
+}
+
+bool HttpClient::resolve() {
+    addrs.clear();
+    addrLens.clear();
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* res = nullptr;
+    int rc = getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &res);
+    if (rc != 0) {
+        error = std::string("resolve ") + host + ": " + gai_strerror(rc);
+        return false;
+    }
+    for (addrinfo* ai = res; ai; ai = ai->ai_next) {
+        sockaddr_storage ss;
+        memcpy(&ss, ai->ai_addr, ai->ai_addrlen);
+        addrs.push_back(ss);
+        addrLens.push_back(ai->ai_addrlen);
+    }
+    freeaddrinfo(res);
+    return !addrs.empty();
+}
+
+bool HttpClient::connectSocket() {
+    closeSocket();
+    if (addrs.empty() && !resolve()) return false;
+
+    for (int round = 0; round < 2; ++round) {
+        for (size_t i = 0; i < addrs.size(); ++i) {
+            const sockaddr* sa = reinterpret_cast<const sockaddr*>(&addrs[i]);
+            int s = socket(sa->sa_family, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+            if (s < 0) continue;
+
+            bool ok = (connect(s, sa, addrLens[i]) == 0);
+            if (!ok && errno == EINPROGRESS) {
+                if (!waitReady(s, POLLOUT, connectTimeoutMs)) {
+                    close(s);
+                    if (error == "cancelled") return false;
+                    error = "connect " + host + ":" + std::to_string(port) + ": timeout";
+                    continue;
+                }
+                int soErr = 0;
+                socklen_t len = sizeof(soErr);
+                ok = (getsockopt(s, SOL_SOCKET, SO_ERROR, &soErr, &len) == 0 && soErr == 0);
+                if (!ok) errno = soErr;
+            }
+            if (!ok) {
+                error = "connect " + host + ":" + std::to_string(port) + ": " + strerror(errno);
+                close(s);
+                continue;
+            }
+
+            int one = 1;
+            setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            fd = s;
+            return true;
+        }
+        // 地址可能已经变了 (比如服务换了容器)，重新解析后再试一轮
+        if (round == 0 && !resolve()) break;
+    }
+    return false;
+}
+
+void HttpClient::closeSocket() {
+    if (fd >= 0) close(fd);
+    fd = -1;
+    inBuf.clear();
+    inPos = 0;
+}
+
+bool HttpClient::sendAll(const std::string& data) {
+    size_t off = 0;
+    while (off < data.size()) {
+        ssize_t n = send(fd, data.data() + off, data.size() - off, MSG_NOSIGNAL);
+        if (n > 0) {
+            off += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (!waitReady(fd, POLLOUT, ioTimeoutMs)) return false;
+            continue;
+        }
+        if (errno == EPIPE || errno == ECONNRESET) peerClosed = true;
+        error = std::string("send: ") + strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+bool HttpClient::fill() {
+    if (inPos > 0 && inPos == inBuf.size()) {
+        inBuf.clear();
+        inPos = 0;
+    } else if (inPos > 65536) {
+        inBuf.erase(0, inPos);
+        inPos = 0;
+    }
+
+    char buf[16384];
+    for (;;) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n > 0) {
+            inBuf.append(buf, static_cast<size_t>(n));
+            gotBytes = true;
+            return true;
+        }
+        if (n == 0) {
+            peerClosed = true;
+            gotEof = true;
+            error = "connection closed by peer";
+            return false;
+        }
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            if (!waitReady(fd, POLLIN, readTimeoutMs)) return false;
+            continue;
+        }
+        if (errno == ECONNRESET) peerClosed = true;
+        error = std::string("recv: ") + strerror(errno);
+        return false;
+    }
+}
+
+bool HttpClient::readLine(std::string& line) {
+    for (;;) {
+        size_t nl = inBuf.find('\n', inPos);
+        if (nl != std::string::npos) {
+            size_t end = (nl > inPos && inBuf[nl - 1] == '\r') ? nl - 1 : nl;
+            line.assign(inBuf, inPos, end - inPos);
+            inPos = nl + 1;
+            return true;
+        }
+        if (inBuf.size() - inPos > 65536) {
+            error = "header line too long";
+            return false;
+        }
+        if (!fill()) return false;
+    }
+}
+
+bool HttpClient::readExact(size_t n, const BodySink& sink, bool& stopped) {
+    while (n > 0) {
+        if (inPos == inBuf.size() && !fill()) return false;
+        size_t take = std::min(n, inBuf.size() - inPos);
+        if (!stopped && sink && !sink(inBuf.data() + inPos, take)) stopped = true;
+        inPos += take;
+        n -= take;
+        if (stopped) return true;
+    }
+    return true;
+}
+
+bool HttpClient::doRequest(const std::string& path, const std::string& body, const BodySink& sink,
+                           int& status, bool& retryable) {
+    retryable = false;
+    peerClosed = false;
+    gotEof = false;
+    gotBytes = false;
+    bool reused = (fd >= 0);
+    if (!reused && !connectSocket()) return false;
+
+    std::string req;
+    req.reserve(body.size() + 192);
+    req += "POST " + path + " HTTP/1.1\r\n";
+    req += "Host: " + host + ":" + std::to_string(port) + "\r\n";
+    req += "Content-Type: application/json\r\n";
+    req += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+    req += "Connection: keep-alive\r\n\r\n";
+    req += body;
+
+    // 复用的连接可能已被服务端关掉：只有对端关闭/重置、且一个响应字节都没收到时才能确定请求没被处理；
+    // 超时则可能是服务端还在生成，重发会让它从头再算一遍
+    if (!sendAll(req)) {
+        retryable = reused && peerClosed && !gotBytes;
+        return false;
+    }
+
+    std::string line;
+    bool keepAlive = true;
+    long long contentLength = -1;
+    bool chunked = false;
+
+    for (;;) {
+        if (!readLine(line)) {
+            retryable = reused && peerClosed && !gotBytes;
+            return false;
+        }
+        if (line.compare(0, 5, "HTTP/") != 0) {
+            error = "malformed status line";
+            return false;
+        }
+        size_t sp = line.find(' ');
+        status = (sp == std::string::npos) ? 0 : atoi(line.c_str() + sp + 1);
+        if (line.compare(0, 8, "HTTP/1.0") == 0) keepAlive = false;
+
+        for (;;) {
+            if (!readLine(line)) return false;
+            if (line.empty()) break;
+            size_t colon = line.find(':');
+            if (colon == std::string::npos) continue;
+            std::string name = lowerAscii(line.substr(0, colon));
+            std::string value = lowerAscii(trim(line.substr(colon + 1)));
+            if (name == "content-length") contentLength = atoll(value.c_str());
+            else if (name == "transfer-encoding") chunked = (value.find("chunked") != std::string::npos);
+            else if (name == "connection") keepAlive = (value.find("close") == std::string::npos);
+        }
+        if (status >= 200) break;
+        // 1xx 临时响应，继续读真正的响应
+        contentLength = -1;
+        chunked = false;
+    }
+
+    bool stopped = false;
+    if (chunked) {
+        for (;;) {
+            if (!readLine(line)) return false;
+            size_t size;
+            if (!parseChunkSize(line, size)) {
+                error = "malformed chunk";
+                return false;
+            }
+            if (size == 0) {
+                do {
+                    if (!readLine(line)) return false;   // trailer 直到空行
+                } while (!line.empty());
+                break;
+            }
+            if (!readExact(size, sink, stopped)) return false;
+            if (stopped) break;
+            if (!readLine(line)) return false;   // 块尾的 CRLF
+        }
+    } else if (contentLength >= 0) {
+        if (!readExact(static_cast<size_t>(contentLength), sink, stopped)) return false;
+    } else {
+        // 没有长度信息：读到连接关闭为止。只有对端正常关闭才算读完，
+        // 超时、重置等说明响应体不完整，按失败返回
+        keepAlive = false;
+        for (;;) {
+            if (inPos < inBuf.size()) {
+                if (!stopped && sink && !sink(inBuf.data() + inPos, inBuf.size() - inPos)) stopped = true;
+                inPos = inBuf.size();
+            }
+            if (stopped) break;
+            if (!fill()) {
+                if (!gotEof) return false;
+                error.clear();
+                break;
+            }
+        }
+    }
+
+    // 提前放弃时剩余数据还在路上，这条连接不能再用
+    if (stopped || !keepAlive) closeSocket();
+    return true;
+}
+
+bool HttpClient::postStream(const std::string& path, const std::string& body, const BodySink& sink, int& status) {
+    readTimeoutMs = ioTimeoutMs;
+    return execute(path, body, sink, status);
+}
+
+bool HttpClient::execute(const std::string& path, const std::string& body, const BodySink& sink, int& status) {
+    status = 0;
+    error.clear();
+    bool retryable = false;
+    if (doRequest(path, body, sink, status, retryable)) return true;
+    closeSocket();
+    if (!retryable || error == "cancelled") return false;
+    if (doRequest(path, body, sink, status, retryable)) {
+        error.clear();
+        return true;
+    }
+    closeSocket();
+    return false;
+}
+
+bool HttpClient::post(const std::string& path, const std::string& body, std::string& response, int& status) {
+    response.clear();
+    readTimeoutMs = responseTimeoutMs;
+    return execute(path, body, [&response](const char* data, size_t len) {
+        response.append(data, len);
+        return true;
+    }, status);
+}
@@ -0,0 +1,104 @@
+/**
+ * @file http_client.h
+ * @brief 极简 HTTP/1.1 客户端 (持久连接)
+ * @details 只覆盖与本地 Ollama 通信需要的部分：POST + keep-alive。
+ *          连接建立一次后重复使用；服务端关掉空闲连接时自动重连并重发一次
+ *          (仅限对端关闭/重置、且还没收到任何响应字节的情况，超时不重发)。
+ *          响应体支持 Content-Length、chunked 以及"读到连接关闭"三种形式。
+ *          不是线程安全的，同一时刻只能有一个请求在进行 (并发请求请每个线程各用一个实例)。
+ */
+
+#ifndef HTTP_CLIENT_H
+#define HTTP_CLIENT_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <atomic>
+#include <sys/socket.h>
+
+class HttpClient {
+public:
+    /**
+     * @brief 响应体数据回调
+     * @return 返回 false 表示不再需要剩余数据 (连接会被关闭，下次请求重连)
+     */
+    using BodySink = std::function<bool(const char* data, size_t len)>;
+
+    HttpClient(const std::string& host, int port);
+    ~HttpClient();
+
+    HttpClient(const HttpClient&) = delete;
+    HttpClient& operator=(const HttpClient&) = delete;
+
+    /**
+     * @brief 解析 "http://host:port/path" 形式的地址
+     * @return 不是 http:// 开头或端口非法时返回 false
+     */
+    static bool parseUrl(const std::string& url, std::string& host, int& port, std::string& path);
+
+    /**
+     * @brief 发送 POST 请求并读取完整响应体
+     * @details 非流式响应要等服务端全部算完才开始返回，读等待用 responseMs 而不是 ioMs
+     * @param status 输出 HTTP 状态码
+     * @return 网络错误或超时返回 false，原因见 lastError()
+     */
+    bool post(const std::string& path, const std::string& body, std::string& response, int& status);
+
+    /**
+     * @brief 发送 POST 请求，响应体边收边交给 sink
+     * @details 每次读等待最多 ioMs (流式响应的两块数据之间不应隔太久)
+     */
+    bool postStream(const std::string& path, const std::string& body, const BodySink& sink, int& status);
+
+    /**
+     * @brief 连接超时 / 单次读写等待超时 / 非流式请求等响应的超时 (毫秒，负数表示不限)
+     */
+    void setTimeouts(int connectMs, int ioMs, int responseMs) {
+        connectTimeoutMs = connectMs;
+        ioTimeoutMs = ioMs;
+        responseTimeoutMs = responseMs;
+    }
+
+    /**
+     * @brief 取消标志：置位后正在等待的连接/读写会在 100ms 内返回失败 (lastError 为 "cancelled")
+     */
+    void setCancelFlag(const std::atomic<bool>* flag) { cancel = flag; }
+
+    const std::string& lastError() const { return error; }
+    bool isConnected() const { return fd >= 0; }
+
+private:
+    std::string host;
+    int port;
+    int fd;
+    int connectTimeoutMs;
+    int ioTimeoutMs;
+    int responseTimeoutMs;
+    int readTimeoutMs;      // 本次请求读等待用的超时
+    const std::atomic<bool>* cancel;
+    std::string error;
+    std::string inBuf;      // 已收到但尚未消费的数据 (可能属于下一个响应)
+    size_t inPos;
+    bool peerClosed;        // 本次请求中对端关闭或重置了连接
+    bool gotEof;            // 本次请求中读到了 EOF (对端正常关闭，不含重置)
+    bool gotBytes;          // 本次请求已收到响应数据
+
+    // 解析后的地址缓存，连接失败时重新解析
+    std::vector<sockaddr_storage> addrs;
+    std::vector<socklen_t> addrLens;
+
+    bool resolve();
+    bool waitReady(int sock, short events, int timeoutMs);
+    bool connectSocket();
+    void closeSocket();
+    bool sendAll(const std::string& data);
+    bool fill();                        // 再读一些数据到 inBuf
+    bool readLine(std::string& line);   // 读一行 (去掉 CRLF)
+    bool readExact(size_t n, const BodySink& sink, bool& stopped);
+    bool doRequest(const std::string& path, const std::string& body, const BodySink& sink,
+                   int& status, bool& retryable);
+    bool execute(const std::string& path, const std::string& body, const BodySink& sink, int& status);
+};
+
+#endif // HTTP_CLIENT_H
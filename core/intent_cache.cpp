@@ -0,0 +1,181 @@
+/**
+ * @file intent_cache.cpp
+ * @brief LLM 分类结果缓存实现
+ */
+
+#include "core/intent_cache.h"
+#include "core/text_match.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+const char* const kFileMagic = "AIOS_INTENT_CACHE 1";
+const size_t kSaveEvery = 16;   // 新增多少条后顺手落盘一次
+
+int64_t nowSeconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::string makeKey(const std::string& module, const std::string& input) {
+    return module + '\x1f' + IntentCache::normalize(input);
+}
+
+// 持久化文件按行、按 tab 分列，值里不能带这两种字符
+std::string sanitize(const std::string& s) {
+    std::string out = s;
+    for (auto& c : out) {
+        if (c == '\t' || c == '\n' || c == '\r') c = ' ';
+    }
+    return out;
+}
+
+} // namespace
+
+IntentCache::IntentCache(const std::string& filePath, size_t cap, int64_t ttlSeconds)
+    : path(filePath), capacity(cap == 0 ? 1 : cap), ttl(ttlSeconds), unsaved(0), hits(0), misses(0) {
+    load();
+}
+
+IntentCache::~IntentCache() {
+    std::lock_guard<std::mutex> g(lock);
+    if (unsaved > 0) saveLocked();
+}
+
+std::string IntentCache::normalize(const std::string& input) {
+    std::string folded = TextMatcher::foldFullwidth(input.data(), input.size());
+
+    std::string out;
+    out.reserve(folded.size());
+    bool pendingSpace = false;
+    for (char c : folded) {
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            pendingSpace = !out.empty();
+            continue;
+        }
+        if (pendingSpace) out += ' ';
+        pendingSpace = false;
+        out += (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    // 去掉句末标点 ("。" 在 UTF-8 中为 E3 80 82)
+    for (;;) {
+        if (!out.empty() && std::string(".!?,;~").find(out.back()) != std::string::npos) {
+            out.pop_back();
+        } else if (out.size() >= 3 && out.compare(out.size() - 3, 3, "\xE3\x80\x82") == 0) {
+            out.resize(out.size() - 3);
+        } else {
+            break;
+        }
+        while (!out.empty() && out.back() == ' ') out.pop_back();
+    }
+    return out;
+}
+
+bool IntentCache::lookup(const std::string& module, const std::string& input, std::string& label) {
+    std::string key = makeKey(module, input);
+    std::lock_guard<std::mutex> g(lock);
+    auto it = byKey.find(key);
+    if (it == byKey.end()) {
+        misses++;
+        return false;
+    }
+    if (it->second->expiresAt <= nowSeconds()) {
+        lru.erase(it->second);
+        byKey.erase(it);
+        misses++;
+        return false;
+    }
+    lru.splice(lru.begin(), lru, it->second);
+    label = it->second->label;
+    hits++;
+    return true;
+}
+
+void IntentCache::store(const std::string& module, const std::string& input, const std::string& label) {
+    std::string key = makeKey(module, input);
+    std::lock_guard<std::mutex> g(lock);
+    insertLocked(key, sanitize(label), nowSeconds() + ttl);
+    if (++unsaved >= kSaveEvery) saveLocked();
+}
+
+void IntentCache::insertLocked(const std::string& key, const std::string& label, int64_t expiresAt) {
+    auto it = byKey.find(key);
+    if (it != byKey.end()) {
+        it->second->label = label;
+        it->second->expiresAt = expiresAt;
+        lru.splice(lru.begin(), lru, it->second);
+        return;
+    }
+    lru.push_front(Entry{key, label, expiresAt});
+    byKey[key] = lru.begin();
+    while (lru.size() > capacity) {
+        byKey.erase(lru.back().key);
+        lru.pop_back();
+    }
+}
+
+size_t IntentCache::size() const {
+    std::lock_guard<std::mutex> g(lock);
+    return lru.size();
+}
+
+void IntentCache::clear() {
+    std::lock_guard<std::mutex> g(lock);
+    lru.clear();
+    byKey.clear();
+    unsaved = 1;   // 让析构时把空表写回去
+}
+
+void IntentCache::load() {
+    if (path.empty()) return;
+    std::ifstream in(path);
+    if (!in.is_open()) return;
+
+    std::string line;
+    if (!std::getline(in, line) || line != kFileMagic) return;
+
+    // 文件里最近使用的在前；倒着插入才能还原 LRU 顺序
+    std::vector<Entry> loaded;
+    int64_t now = nowSeconds();
+    while (std::getline(in, line)) {
+        size_t t1 = line.find('\t');
+        size_t t2 = (t1 == std::string::npos) ? std::string::npos : line.find('\t', t1 + 1);
+        if (t2 == std::string::npos) continue;
+        int64_t expiresAt = atoll(line.substr(0, t1).c_str());
+        if (expiresAt <= now) continue;
+        loaded.push_back(Entry{line.substr(t1 + 1, t2 - t1 - 1), line.substr(t2 + 1), expiresAt});
+    }
+
+    std::lock_guard<std::mutex> g(lock);
+    for (auto it = loaded.rbegin(); it != loaded.rend(); ++it) {
+        insertLocked(it->key, it->label, it->expiresAt);
+    }
+}
+
+bool IntentCache::save() {
+    std::lock_guard<std::mutex> g(lock);
+    return saveLocked();
+}
+
+bool IntentCache::saveLocked() {
+    if (path.empty()) return true;
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::trunc);
+        if (!out.is_open()) return false;
+        out << kFileMagic << '\n';
+        for (const auto& e : lru) out << e.expiresAt << '\t' << e.key << '\t' << e.label << '\n';
+        if (!out.good()) return false;
+    }
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    unsaved = 0;
+    return true;
+}
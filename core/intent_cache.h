@@ -0,0 +1,77 @@
+/**
+ * @file intent_cache.h
+ * @brief LLM 分类结果缓存 (LRU + TTL，落盘)
+ * @details 键为 "模块 + 归一化后的用户输入"，值为模型回复的标签。
+ *          归一化：全角 ASCII 转半角、ASCII 转小写、连续空白合并、去掉首尾空白和句末标点，
+ *          所以 "查询CPU"、"查询 cpu。" 命中同一条。
+ *          容量满时淘汰最久未用的条目；过期条目在查询时丢弃。
+ *          析构时写回磁盘，启动时载入，重启后仍然有效。
+ */
+
+#ifndef INTENT_CACHE_H
+#define INTENT_CACHE_H
+
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+class IntentCache {
+public:
+    /**
+     * @param filePath 持久化文件，空字符串表示只在内存中
+     * @param capacity 最多缓存的条目数
+     * @param ttlSeconds 条目有效期
+     */
+    IntentCache(const std::string& filePath, size_t capacity = 512, int64_t ttlSeconds = 24 * 3600);
+    ~IntentCache();
+
+    /**
+     * @brief 查询缓存
+     * @return 命中时写入 label 并返回 true
+     */
+    bool lookup(const std::string& module, const std::string& input, std::string& label);
+
+    void store(const std::string& module, const std::string& input, const std::string& label);
+
+    /**
+     * @brief 写回磁盘 (临时文件 + rename)
+     */
+    bool save();
+
+    void clear();
+
+    uint64_t hitCount() const { return hits; }
+    uint64_t missCount() const { return misses; }
+    size_t size() const;
+
+    /**
+     * @brief 输入归一化规则 (公开出来便于其他模块复用同一规则)
+     */
+    static std::string normalize(const std::string& input);
+
+private:
+    struct Entry {
+        std::string key;
+        std::string label;
+        int64_t expiresAt;   // 墙上时间 (秒)，便于跨进程持久化
+    };
+
+    std::string path;
+    size_t capacity;
+    int64_t ttl;
+    mutable std::mutex lock;
+    std::list<Entry> lru;    // 表头最近使用
+    std::unordered_map<std::string, std::list<Entry>::iterator> byKey;
+    size_t unsaved;          // 上次落盘后新增的条目数
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+
+    void load();
+    void insertLocked(const std::string& key, const std::string& label, int64_t expiresAt);
+    bool saveLocked();
+};
+
+#endif // INTENT_CACHE_H
@@ -0,0 +1,284 @@
+/**
+ * @file intent_classifier.cpp
+ * @brief 本地意图分类器实现
+ */
+
+#include "core/intent_classifier.h"
+#include "core/intent_cache.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sys/stat.h>
+
+namespace {
+
+const char kModelMagic[8] = {'A', 'I', 'O', 'S', 'N', 'B', '0', '1'};
+const double kSmoothing = 0.5;   // 拉普拉斯平滑系数
+const int kMaxGram = 3;
+// 朴素贝叶斯把每个 n-gram 当独立证据，长句的后验会被推到 0/1，完全不可信。
+// 改用平均对数似然乘一个锐度系数，系数在随仓库语料的留一法验证上标定。
+const double kSharpness = 6.0;
+
+uint32_t fnv1a(const char* data, size_t len, uint32_t seed) {
+    uint32_t h = 2166136261u ^ seed;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= static_cast<unsigned char>(data[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+bool statMtime(const std::string& path, int64_t& mtimeNs) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return false;
+    mtimeNs = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+    return true;
+}
+
+template <typename T>
+void writePod(std::ofstream& out, const T& v) {
+    out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template <typename T>
+bool readPod(std::ifstream& in, T& v) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&v), sizeof(T)));
+}
+
+void writeStr(std::ofstream& out, const std::string& s) {
+    uint16_t len = static_cast<uint16_t>(s.size());
+    writePod(out, len);
+    out.write(s.data(), len);
+}
+
+bool readStr(std::ifstream& in, std::string& s) {
+    uint16_t len = 0;
+    if (!readPod(in, len)) return false;
+    s.resize(len);
+    return static_cast<bool>(in.read(&s[0], len));
+}
+
+} // namespace
+
+void IntentClassifier::extractFeatures(const std::string& text, std::vector<uint32_t>& out) {
+    out.clear();
+    std::string norm = IntentCache::normalize(text);
+
+    // 按 UTF-8 码点切分，首尾加边界标记让 "词首/词尾" 也成为特征
+    std::vector<std::string> chars;
+    chars.push_back("\x02");
+    for (size_t i = 0; i < norm.size();) {
+        unsigned char c = static_cast<unsigned char>(norm[i]);
+        size_t n = (c < 0x80) ? 1 : (c >> 5) == 0x6 ? 2 : (c >> 4) == 0xE ? 3 : (c >> 3) == 0x1E ? 4 : 1;
+        n = std::min(n, norm.size() - i);
+        chars.push_back(norm.substr(i, n));
+        i += n;
+    }
+    chars.push_back("\x03");
+
+    std::string gram;
+    for (size_t i = 0; i < chars.size(); ++i) {
+        gram.clear();
+        for (int n = 1; n <= kMaxGram && i + n <= chars.size(); ++n) {
+            gram += chars[i + n - 1];
+            if (n == 1 && (i == 0 || i + 1 == chars.size())) continue;  // 单独的边界标记没有意义
+            out.push_back(fnv1a(gram.data(), gram.size(), static_cast<uint32_t>(n)));
+        }
+    }
+}
+
+bool IntentClassifier::train(const std::string& corpusPath) {
+    std::ifstream in(corpusPath);
+    if (!in.is_open()) return false;
+
+    struct Counts {
+        std::vector<std::string> labels;
+        std::vector<uint32_t> docs;                          // 每个标签的样本数
+        std::vector<double> total;                           // 每个标签的特征总数
+        std::map<uint32_t, std::vector<uint32_t>> feats;    // 特征 -> 每个标签的出现次数
+    };
+    std::map<std::string, Counts> counts;
+
+    std::string line;
+    std::vector<uint32_t> features;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        size_t t1 = line.find('\t');
+        size_t t2 = (t1 == std::string::npos) ? std::string::npos : line.find('\t', t1 + 1);
+        if (t2 == std::string::npos) continue;
+        std::string module = line.substr(0, t1);
+        std::string label = line.substr(t1 + 1, t2 - t1 - 1);
+
+        Counts& c = counts[module];
+        size_t li = std::find(c.labels.begin(), c.labels.end(), label) - c.labels.begin();
+        if (li == c.labels.size()) {
+            c.labels.push_back(label);
+            c.docs.push_back(0);
+            c.total.push_back(0);
+            for (auto& kv : c.feats) kv.second.push_back(0);
+        }
+        c.docs[li]++;
+
+        extractFeatures(line.substr(t2 + 1), features);
+        for (uint32_t f : features) {
+            auto it = c.feats.find(f);
+            if (it == c.feats.end()) it = c.feats.emplace(f, std::vector<uint32_t>(c.labels.size(), 0)).first;
+            it->second[li]++;
+            c.total[li] += 1;
+        }
+    }
+    if (counts.empty()) return false;
+
+    models.clear();
+    for (auto& kv : counts) {
+        Counts& c = kv.second;
+        Model m;
+        size_t labelCount = c.labels.size();
+        double docTotal = 0;
+        for (uint32_t d : c.docs) docTotal += d;
+        double vocab = static_cast<double>(c.feats.size());
+
+        m.labels = c.labels;
+        for (size_t li = 0; li < labelCount; ++li) {
+            double denom = c.total[li] + kSmoothing * vocab;
+            m.logPrior.push_back(static_cast<float>(std::log(c.docs[li] / docTotal)));
+            m.logUnseen.push_back(static_cast<float>(std::log(kSmoothing / denom)));
+        }
+        m.weights.reserve(c.feats.size() * labelCount);
+        for (const auto& f : c.feats) {
+            m.featRow[f.first] = static_cast<uint32_t>(m.weights.size() / labelCount);
+            for (size_t li = 0; li < labelCount; ++li) {
+                double denom = c.total[li] + kSmoothing * vocab;
+                uint32_t cnt = li < f.second.size() ? f.second[li] : 0;
+                m.weights.push_back(static_cast<float>(std::log((cnt + kSmoothing) / denom)));
+            }
+        }
+        models[kv.first] = std::move(m);
+    }
+    return true;
+}
+
+bool IntentClassifier::save(const std::string& modelPath) const {
+    std::string tmpPath = modelPath + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) return false;
+        out.write(kModelMagic, sizeof(kModelMagic));
+        writePod(out, static_cast<uint32_t>(models.size()));
+        for (const auto& kv : models) {
+            const Model& m = kv.second;
+            writeStr(out, kv.first);
+            writePod(out, static_cast<uint16_t>(m.labels.size()));
+            for (const auto& l : m.labels) writeStr(out, l);
+            out.write(reinterpret_cast<const char*>(m.logPrior.data()), m.logPrior.size() * sizeof(float));
+            out.write(reinterpret_cast<const char*>(m.logUnseen.data()), m.logUnseen.size() * sizeof(float));
+            writePod(out, static_cast<uint32_t>(m.featRow.size()));
+            for (const auto& f : m.featRow) {
+                writePod(out, f.first);
+                out.write(reinterpret_cast<const char*>(&m.weights[f.second * m.labels.size()]),
+                          m.labels.size() * sizeof(float));
+            }
+        }
+        if (!out.good()) return false;
+    }
+    if (std::rename(tmpPath.c_str(), modelPath.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool IntentClassifier::load(const std::string& modelPath) {
+    std::ifstream in(modelPath, std::ios::binary);
+    if (!in.is_open()) return false;
+
+    char magic[sizeof(kModelMagic)];
+    if (!in.read(magic, sizeof(magic)) || memcmp(magic, kModelMagic, sizeof(magic)) != 0) return false;
+
+    uint32_t moduleCount = 0;
+    if (!readPod(in, moduleCount)) return false;
+
+    std::unordered_map<std::string, Model> loaded;
+    for (uint32_t i = 0; i < moduleCount; ++i) {
+        std::string name;
+        uint16_t labelCount = 0;
+        if (!readStr(in, name) || !readPod(in, labelCount) || labelCount == 0) return false;
+
+        Model m;
+        m.labels.resize(labelCount);
+        for (auto& l : m.labels) {
+            if (!readStr(in, l)) return false;
+        }
+        m.logPrior.resize(labelCount);
+        m.logUnseen.resize(labelCount);
+        if (!in.read(reinterpret_cast<char*>(m.logPrior.data()), labelCount * sizeof(float))) return false;
+        if (!in.read(reinterpret_cast<char*>(m.logUnseen.data()), labelCount * sizeof(float))) return false;
+
+        uint32_t featCount = 0;
+        if (!readPod(in, featCount)) return false;
+        m.featRow.reserve(featCount);
+        m.weights.resize(static_cast<size_t>(featCount) * labelCount);
+        for (uint32_t f = 0; f < featCount; ++f) {
+            uint32_t hash = 0;
+            if (!readPod(in, hash)) return false;
+            if (!in.read(reinterpret_cast<char*>(&m.weights[static_cast<size_t>(f) * labelCount]),
+                         labelCount * sizeof(float))) return false;
+            m.featRow[hash] = f;
+        }
+        loaded[name] = std::move(m);
+    }
+    models = std::move(loaded);
+    return true;
+}
+
+bool IntentClassifier::loadOrTrain(const std::string& modelPath, const std::string& corpusPath) {
+    int64_t modelTime = 0;
+    int64_t corpusTime = 0;
+    bool haveModel = statMtime(modelPath, modelTime);
+    bool haveCorpus = statMtime(corpusPath, corpusTime);
+
+    if (haveModel && (!haveCorpus || modelTime >= corpusTime) && load(modelPath)) return true;
+    if (!haveCorpus || !train(corpusPath)) return haveModel && load(modelPath);
+    save(modelPath);   // 写不进去也不影响本次使用
+    return true;
+}
+
+bool IntentClassifier::predict(const std::string& module, const std::string& input, Prediction& out) const {
+    auto it = models.find(module);
+    if (it == models.end()) return false;
+    const Model& m = it->second;
+    size_t labelCount = m.labels.size();
+
+    std::vector<uint32_t> features;
+    extractFeatures(input, features);
+
+    std::vector<double> likelihood(labelCount, 0.0);
+    size_t known = 0;
+    for (uint32_t f : features) {
+        auto row = m.featRow.find(f);
+        if (row == m.featRow.end()) {
+            for (size_t li = 0; li < labelCount; ++li) likelihood[li] += m.logUnseen[li];
+            continue;
+        }
+        known++;
+        const float* w = &m.weights[static_cast<size_t>(row->second) * labelCount];
+        for (size_t li = 0; li < labelCount; ++li) likelihood[li] += w[li];
+    }
+
+    std::vector<double> score(labelCount);
+    double n = static_cast<double>(std::max<size_t>(features.size(), 1));
+    for (size_t li = 0; li < labelCount; ++li) score[li] = m.logPrior[li] + kSharpness * likelihood[li] / n;
+
+    // softmax 得到后验
+    size_t best = std::max_element(score.begin(), score.end()) - score.begin();
+    double sum = 0;
+    for (double s : score) sum += std::exp(s - score[best]);
+
+    out.label = m.labels[best];
+    out.confidence = 1.0 / sum;
+    out.coverage = features.empty() ? 0.0 : static_cast<double>(known) / features.size();
+    return true;
+}
@@ -0,0 +1,63 @@
+/**
+ * @file intent_classifier.h
+ * @brief 本地意图分类器 (字符 n-gram 朴素贝叶斯)
+ * @details 每个模块一个多项式朴素贝叶斯模型，特征是归一化输入的 1~3 字符 n-gram 哈希
+ *          (按 UTF-8 码点切分，中文一个字算一个字符)。
+ *          语料随仓库发布 (data/intent_corpus.tsv)，训练结果序列化为二进制缓存在本地，
+ *          语料比模型新时自动重新训练。
+ *          预测给出后验置信度和覆盖率 (输入 n-gram 中训练时见过的比例)，
+ *          调用方据此决定是否直接采用，还是交给 LLM。
+ */
+
+#ifndef INTENT_CLASSIFIER_H
+#define INTENT_CLASSIFIER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+class IntentClassifier {
+public:
+    struct Prediction {
+        std::string label;
+        double confidence;   // 后验概率 0~1
+        double coverage;     // 已知特征占比 0~1
+    };
+
+    /**
+     * @brief 从 TSV 语料训练 (模块<TAB>标签<TAB>指令，# 开头为注释)
+     */
+    bool train(const std::string& corpusPath);
+
+    bool save(const std::string& modelPath) const;
+    bool load(const std::string& modelPath);
+
+    /**
+     * @brief 模型文件存在且不比语料旧时直接加载，否则重新训练并写回
+     */
+    bool loadOrTrain(const std::string& modelPath, const std::string& corpusPath);
+
+    /**
+     * @brief 在指定模块的标签集合中分类
+     * @return 模块没有模型时返回 false
+     */
+    bool predict(const std::string& module, const std::string& input, Prediction& out) const;
+
+    size_t moduleCount() const { return models.size(); }
+
+private:
+    struct Model {
+        std::vector<std::string> labels;
+        std::vector<float> logPrior;     // 每个标签
+        std::vector<float> logUnseen;    // 训练中没见过的特征
+        std::unordered_map<uint32_t, uint32_t> featRow;  // 特征哈希 -> weights 中的行
+        std::vector<float> weights;      // 行主序: 特征 x 标签 的 log P(f|label)
+    };
+
+    std::unordered_map<std::string, Model> models;
+
+    static void extractFeatures(const std::string& text, std::vector<uint32_t>& out);
+};
+
+#endif // INTENT_CLASSIFIER_H
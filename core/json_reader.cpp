@@ -0,0 +1,277 @@
+/**
+ * @file json_reader.cpp
+ * @brief 只读 JSON 读取器实现
+ */
+
+#include "core/json_reader.h"
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+const int kMaxDepth = 64;
+
+inline const char* skipWs(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) ++p;
+    return p;
+}
+
+// p 指向开头的引号，返回结尾引号之后的位置；字符串没有结束返回 nullptr
+const char* scanString(const char* p, const char* end) {
+    ++p;
+    while (p < end) {
+        const char* q = static_cast<const char*>(memchr(p, '"', end - p));
+        if (!q) return nullptr;
+        // 引号前连续反斜杠为奇数个时，这个引号是被转义的
+        const char* b = q;
+        while (b > p && b[-1] == '\\') --b;
+        if ((q - b) % 2 == 0) return q + 1;
+        p = q + 1;
+    }
+    return nullptr;
+}
+
+bool matchLiteral(const char* p, const char* end, const char* lit, size_t n) {
+    return static_cast<size_t>(end - p) >= n && memcmp(p, lit, n) == 0;
+}
+
+// 跳过从 p 开始的一个值 (p 已跳过空白)
+bool skipValue(const char* p, const char* end, JsonReader::Value& v) {
+    if (p >= end) return false;
+    v.begin = p;
+    char c = *p;
+    if (c == '"') {
+        v.type = JsonReader::STRING;
+        v.end = scanString(p, end);
+        return v.end != nullptr;
+    }
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        v.type = JsonReader::NUMBER;
+        while (p < end && ((*p >= '0' && *p <= '9') || *p == '-' || *p == '+' || *p == '.' ||
+                           *p == 'e' || *p == 'E')) ++p;
+        v.end = p;
+        return true;
+    }
+    if (c == 't' || c == 'f' || c == 'n') {
+        const char* lit = (c == 't') ? "true" : (c == 'f') ? "false" : "null";
+        size_t n = strlen(lit);
+        if (!matchLiteral(p, end, lit, n)) return false;
+        v.type = (c == 'n') ? JsonReader::NUL : JsonReader::BOOL;
+        v.end = p + n;
+        return true;
+    }
+    if (c != '{' && c != '[') return false;
+
+    // 容器：只检查括号配对，里面的字符串整体跳过
+    v.type = (c == '{') ? JsonReader::OBJECT : JsonReader::ARRAY;
+    char stack[kMaxDepth];
+    int depth = 0;
+    while (p < end) {
+        c = *p;
+        if (c == '"') {
+            p = scanString(p, end);
+            if (!p) return false;
+            continue;
+        }
+        if (c == '{' || c == '[') {
+            if (depth == kMaxDepth) return false;
+            stack[depth++] = (c == '{') ? '}' : ']';
+        } else if (c == '}' || c == ']') {
+            if (depth == 0 || stack[depth - 1] != c) return false;
+            if (--depth == 0) {
+                v.end = p + 1;
+                return true;
+            }
+        }
+        ++p;
+    }
+    return false;
+}
+
+inline int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool readHex4(const char* p, const char* end, unsigned& cp) {
+    if (end - p < 4) return false;
+    cp = 0;
+    for (int i = 0; i < 4; ++i) {
+        int h = hexValue(p[i]);
+        if (h < 0) return false;
+        cp = (cp << 4) | static_cast<unsigned>(h);
+    }
+    return true;
+}
+
+void appendUtf8(std::string& out, unsigned cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+} // namespace
+
+bool JsonReader::unescape(const Value& v, std::string& out) {
+    out.clear();
+    if (v.type != STRING) return false;
+    const char* p = v.begin + 1;
+    const char* end = v.end - 1;
+
+    // 大部分片段没有转义，整段拷贝
+    const char* bs = static_cast<const char*>(memchr(p, '\\', end - p));
+    if (!bs) {
+        out.assign(p, end - p);
+        return true;
+    }
+
+    out.reserve(end - p);
+    while (bs) {
+        out.append(p, bs - p);
+        p = bs + 1;
+        if (p >= end) return false;
+        char c = *p++;
+        switch (c) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                unsigned cp;
+                if (!readHex4(p, end, cp)) return false;
+                p += 4;
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    // 高代理后面必须跟低代理，否则按替换字符处理
+                    unsigned lo;
+                    if (end - p >= 6 && p[0] == '\\' && p[1] == 'u' && readHex4(p + 2, end, lo) &&
+                        lo >= 0xDC00 && lo <= 0xDFFF) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                        p += 6;
+                    } else {
+                        cp = 0xFFFD;
+                    }
+                } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                    cp = 0xFFFD;
+                }
+                appendUtf8(out, cp);
+                break;
+            }
+            default:
+                return false;
+        }
+        bs = static_cast<const char*>(memchr(p, '\\', end - p));
+    }
+    out.append(p, end - p);
+    return true;
+}
+
+bool JsonReader::find(const char* key, Value& out) const {
+    const char* end = data + len;
+    const char* p = skipWs(data, end);
+    if (p >= end || *p != '{') return false;
+    ++p;
+
+    size_t keyLen = strlen(key);
+    std::string decoded;
+    for (;;) {
+        p = skipWs(p, end);
+        if (p >= end || *p != '"') return false;   // 包括 '}'：空对象或找完了
+
+        Value k;
+        k.type = STRING;
+        k.begin = p;
+        k.end = scanString(p, end);
+        if (!k.end) return false;
+
+        // 键名一般没有转义，直接比较原始字节
+        const char* raw = k.begin + 1;
+        size_t rawLen = k.end - k.begin - 2;
+        bool match;
+        if (!memchr(raw, '\\', rawLen)) match = (rawLen == keyLen && memcmp(raw, key, keyLen) == 0);
+        else match = unescape(k, decoded) && decoded == key;
+
+        p = skipWs(k.end, end);
+        if (p >= end || *p != ':') return false;
+        p = skipWs(p + 1, end);
+
+        Value v;
+        if (!skipValue(p, end, v)) return false;
+        if (match) {
+            out = v;
+            return true;
+        }
+
+        p = skipWs(v.end, end);
+        if (p >= end) return false;
+        if (*p == ',') ++p;
+        else return false;   // '}' 表示找完了没有，其他字符是格式错误
+    }
+}
+
+bool JsonReader::getString(const char* key, std::string& out) const {
+    Value v;
+    if (!find(key, v) || v.type != STRING) return false;
+    return unescape(v, out);
+}
+
+bool JsonReader::getBool(const char* key, bool& out) const {
+    Value v;
+    if (!find(key, v) || v.type != BOOL) return false;
+    out = (*v.begin == 't');
+    return true;
+}
+
+bool JsonReader::getNumber(const char* key, double& out) const {
+    Value v;
+    if (!find(key, v) || v.type != NUMBER) return false;
+    char buf[64];
+    size_t n = v.end - v.begin;
+    if (n == 0 || n >= sizeof(buf)) return false;
+    memcpy(buf, v.begin, n);
+    buf[n] = '\0';
+    char* stop = nullptr;
+    out = strtod(buf, &stop);
+    return stop == buf + n;
+}
+
+bool JsonReader::nextLine(const char* buf, size_t bufLen, size_t& pos, const char*& line, size_t& lineLen,
+                          bool requireNewline) {
+    size_t p = pos;
+    while (p < bufLen) {
+        const char* nl = static_cast<const char*>(memchr(buf + p, '\n', bufLen - p));
+        size_t stop = nl ? static_cast<size_t>(nl - buf) : bufLen;
+        if (!nl && requireNewline) return false;
+
+        size_t next = nl ? stop + 1 : bufLen;
+        size_t e = stop;
+        if (e > p && buf[e - 1] == '\r') --e;
+        const char* s = skipWs(buf + p, buf + e);
+        if (s < buf + e) {
+            line = buf + p;
+            lineLen = e - p;
+            pos = next;
+            return true;
+        }
+        p = next;   // 空行
+        pos = p;
+    }
+    return false;
+}
@@ -0,0 +1,69 @@
+/**
+ * @file json_reader.h
+ * @brief 按需查找字段的只读 JSON 读取器
+ * @details 不建 DOM：构造时只记下缓冲区，find() 在顶层对象里逐个比较键名，
+ *          其余成员的值只做跳过 (检查括号配对和字符串结束)，不拷贝。
+ *          取字符串时才做反转义 (含 \uXXXX 与代理对 -> UTF-8)，写进调用方复用的缓冲区；
+ *          没有转义字符的字符串直接整段拷贝。
+ *          Ollama 的两种响应都适用：非流式是一个对象，流式 (NDJSON) 每行一个对象，
+ *          用 nextLine() 逐行切出来再分别读取。
+ */
+
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include <string>
+#include <cstddef>
+
+class JsonReader {
+public:
+    enum Type { INVALID, OBJECT, ARRAY, STRING, NUMBER, BOOL, NUL };
+
+    /**
+     * @brief 原始缓冲区中的一个值 (不持有数据)
+     */
+    struct Value {
+        Type type = INVALID;
+        const char* begin = nullptr;   // 值的第一个字节 (字符串为开头的引号)
+        const char* end = nullptr;     // 值之后的位置
+    };
+
+    JsonReader(const char* data, size_t len) : data(data), len(len) {}
+    explicit JsonReader(const std::string& s) : data(s.data()), len(s.size()) {}
+    // 只记指针，临时字符串在构造完就析构了
+    explicit JsonReader(std::string&&) = delete;
+
+    /**
+     * @brief 在顶层对象中查找成员
+     * @return 顶层不是对象、JSON 残缺或没有该键时返回 false
+     */
+    bool find(const char* key, Value& out) const;
+
+    /**
+     * @brief 读取字符串成员，反转义后写入 out (覆盖原内容，容量复用)
+     */
+    bool getString(const char* key, std::string& out) const;
+    bool getBool(const char* key, bool& out) const;
+    bool getNumber(const char* key, double& out) const;
+
+    /**
+     * @brief 把字符串值反转义到 out
+     * @return 值不是字符串或转义非法时返回 false
+     */
+    static bool unescape(const Value& v, std::string& out);
+
+    /**
+     * @brief 从 pos 开始切出下一行 (NDJSON)，跳过空行，行尾的 \r 去掉
+     * @param pos 输入输出：读取位置，返回时指向下一行开头
+     * @param requireNewline 为 true 时最后一行没有换行就不返回 (可能还没收全)
+     * @return 没有完整行时返回 false (pos 只会越过已读到的空行)
+     */
+    static bool nextLine(const char* buf, size_t bufLen, size_t& pos, const char*& line, size_t& lineLen,
+                         bool requireNewline = true);
+
+private:
+    const char* data;
+    size_t len;
+};
+
+#endif // JSON_READER_H
@@ -0,0 +1,146 @@
+/**
+ * @file keyword_router.cpp
+ * @brief 关键词路由实现
+ */
+
+#include "core/keyword_router.h"
+#include "core/intent_cache.h"
+#include <cstring>
+#include <mutex>
+#include <queue>
+
+namespace {
+
+inline bool isAsciiAlnum(unsigned char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+bool isPureAscii(const std::string& s) {
+    for (char c : s) {
+        if (static_cast<unsigned char>(c) >= 0x80) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+KeywordRouter::KeywordRouter() : dirty(true), classCount(1) {
+    memset(byteClass, 0, sizeof(byteClass));
+}
+
+void KeywordRouter::addKeyword(const std::string& keyword, const std::string& route, double weight) {
+    std::string text = IntentCache::normalize(keyword);
+    if (text.empty()) return;
+
+    std::unique_lock<std::shared_mutex> g(lock);
+    int routeId = -1;
+    for (size_t i = 0; i < routes.size(); ++i) {
+        if (routes[i] == route) routeId = static_cast<int>(i);
+    }
+    if (routeId < 0) {
+        routeId = static_cast<int>(routes.size());
+        routes.push_back(route);
+    }
+    keywords.push_back(Keyword{text, routeId, weight, isPureAscii(text)});
+    dirty = true;
+}
+
+size_t KeywordRouter::keywordCount() const {
+    std::shared_lock<std::shared_mutex> g(lock);
+    return keywords.size();
+}
+
+void KeywordRouter::buildLocked() const {
+    // 1. 压缩字母表：只有关键词里出现过的字节才需要独立的列
+    memset(byteClass, 0, sizeof(byteClass));
+    classCount = 1;
+    for (const auto& k : keywords) {
+        for (char c : k.text) {
+            uint16_t& cls = byteClass[static_cast<unsigned char>(c)];
+            if (cls == 0) cls = static_cast<uint16_t>(classCount++);
+        }
+    }
+
+    // 2. 建 trie (-1 表示没有边)
+    std::vector<int32_t> trie(classCount, -1);
+    outputs.assign(1, {});
+    for (size_t ki = 0; ki < keywords.size(); ++ki) {
+        int state = 0;
+        for (char c : keywords[ki].text) {
+            int cls = byteClass[static_cast<unsigned char>(c)];
+            int32_t& next = trie[state * classCount + cls];
+            if (next < 0) {
+                next = static_cast<int32_t>(outputs.size());
+                outputs.emplace_back();
+                trie.resize(trie.size() + classCount, -1);
+            }
+            state = trie[state * classCount + cls];
+        }
+        outputs[state].push_back(static_cast<int>(ki));
+    }
+
+    // 3. BFS 求失败链接，同时把缺失的边补成完整的 DFA 转移
+    size_t stateCount = outputs.size();
+    delta.assign(stateCount * classCount, 0);
+    std::vector<int> fail(stateCount, 0);
+    std::queue<int> q;
+    for (int c = 0; c < classCount; ++c) {
+        int32_t next = trie[c];
+        if (next >= 0) {
+            delta[c] = next;
+            q.push(next);
+        }
+    }
+    while (!q.empty()) {
+        int s = q.front();
+        q.pop();
+        const auto& failOut = outputs[fail[s]];
+        outputs[s].insert(outputs[s].end(), failOut.begin(), failOut.end());
+        for (int c = 0; c < classCount; ++c) {
+            int32_t next = trie[s * classCount + c];
+            if (next >= 0) {
+                fail[next] = delta[fail[s] * classCount + c];
+                delta[s * classCount + c] = next;
+                q.push(next);
+            } else {
+                delta[s * classCount + c] = delta[fail[s] * classCount + c];
+            }
+        }
+    }
+    dirty = false;
+}
+
+std::string KeywordRouter::route(const std::string& input) const {
+    std::string text = IntentCache::normalize(input);
+
+    std::shared_lock<std::shared_mutex> rg(lock);
+    if (dirty) {
+        rg.unlock();
+        {
+            std::unique_lock<std::shared_mutex> wg(lock);
+            if (dirty) buildLocked();
+        }
+        rg.lock();
+    }
+
+    std::vector<double> score(routes.size(), 0.0);
+    int32_t state = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        state = delta[state * classCount + byteClass[static_cast<unsigned char>(text[i])]];
+        for (int ki : outputs[state]) {
+            const Keyword& k = keywords[ki];
+            if (k.wholeWord) {
+                size_t begin = i + 1 - k.text.size();
+                if (begin > 0 && isAsciiAlnum(static_cast<unsigned char>(text[begin - 1]))) continue;
+                if (i + 1 < text.size() && isAsciiAlnum(static_cast<unsigned char>(text[i + 1]))) continue;
+            }
+            score[k.route] += k.weight;
+        }
+    }
+
+    int best = -1;
+    for (size_t r = 0; r < score.size(); ++r) {
+        if (score[r] > 0 && (best < 0 || score[r] > score[best])) best = static_cast<int>(r);
+    }
+    return best < 0 ? "" : routes[best];
+}
@@ -0,0 +1,60 @@
+/**
+ * @file keyword_router.h
+ * @brief 关键词路由 (Aho–Corasick 自动机 + 加权打分)
+ * @details 所有关键词编译成一个自动机，对输入只扫描一遍就收集到每个模块的全部命中，
+ *          命中的权重按模块累加，得分最高的模块胜出；同分时先注册的模块优先。
+ *          输入与关键词先做同样的归一化 (全角转半角、ASCII 小写)。
+ *          纯 ASCII 关键词要求整词匹配 (前后不是字母数字)，"renew" 不会命中 "new"；
+ *          中文关键词按子串匹配。
+ *          关键词可以在运行时追加，自动机在下一次查询时重新编译。
+ */
+
+#ifndef KEYWORD_ROUTER_H
+#define KEYWORD_ROUTER_H
+
+#include <string>
+#include <vector>
+#include <shared_mutex>
+#include <cstdint>
+
+class KeywordRouter {
+public:
+    KeywordRouter();
+
+    /**
+     * @brief 追加关键词 (线程安全)
+     * @param route 模块名，第一次出现的顺序决定同分时的优先级
+     * @param weight 命中一次加的分，越具体的词应给越高的分
+     */
+    void addKeyword(const std::string& keyword, const std::string& route, double weight);
+
+    /**
+     * @brief 对输入打分并返回得分最高的模块名，没有任何命中时返回空字符串
+     */
+    std::string route(const std::string& input) const;
+
+    size_t keywordCount() const;
+
+private:
+    struct Keyword {
+        std::string text;     // 归一化后的关键词
+        int route;
+        double weight;
+        bool wholeWord;
+    };
+
+    mutable std::shared_mutex lock;
+    std::vector<std::string> routes;
+    std::vector<Keyword> keywords;
+
+    // 编译后的自动机 (mutable：查询时按需重建)
+    mutable bool dirty;
+    mutable uint16_t byteClass[256];          // 字节 -> 字母表编号，关键词里没出现过的字节都是 0
+    mutable int classCount;
+    mutable std::vector<int32_t> delta;       // 完整状态转移表: 状态 x 字母表
+    mutable std::vector<std::vector<int>> outputs;  // 状态 -> 在此结束的关键词 (含后缀链上的)
+
+    void buildLocked() const;
+};
+
+#endif // KEYWORD_ROUTER_H
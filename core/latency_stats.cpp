@@ -0,0 +1,186 @@
+/**
+ * @file latency_stats.cpp
+ * @brief 阶段耗时统计实现
+ */
+
+#include "core/latency_stats.h"
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+
+LatencyHistogram::LatencyHistogram() : total(0), sum(0), maxValue(0) {
+    for (auto& b : buckets) b.store(0, std::memory_order_relaxed);
+}
+
+int LatencyHistogram::bucketOf(uint64_t v) {
+    if (v < static_cast<uint64_t>(kSubCount)) return static_cast<int>(v);   // 小值精确计数
+    int e = 63 - __builtin_clzll(v);
+    int sub = static_cast<int>((v >> (e - kSubBits)) & (kSubCount - 1));
+    return (e - kSubBits + 1) * kSubCount + sub;
+}
+
+uint64_t LatencyHistogram::bucketLow(int b) {
+    if (b < kSubCount) return static_cast<uint64_t>(b);
+    int e = b / kSubCount + kSubBits - 1;
+    uint64_t sub = static_cast<uint64_t>(b % kSubCount);
+    return (kSubCount + sub) << (e - kSubBits);
+}
+
+uint64_t LatencyHistogram::bucketWidth(int b) {
+    if (b < kSubCount) return 1;
+    int e = b / kSubCount + kSubBits - 1;
+    return 1ull << (e - kSubBits);
+}
+
+void LatencyHistogram::record(uint64_t micros) {
+    buckets[bucketOf(micros)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(micros, std::memory_order_relaxed);
+    uint64_t cur = maxValue.load(std::memory_order_relaxed);
+    while (micros > cur && !maxValue.compare_exchange_weak(cur, micros, std::memory_order_relaxed)) {
+    }
+}
+
+double LatencyHistogram::mean() const {
+    uint64_t n = count();
+    return n == 0 ? 0.0 : static_cast<double>(sum.load(std::memory_order_relaxed)) / n;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    uint64_t n = count();
+    if (n == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(p / 100.0 * n + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > n) rank = n;
+
+    uint64_t seen = 0;
+    for (int b = 0; b < kBucketCount; ++b) {
+        seen += buckets[b].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            uint64_t mid = bucketLow(b) + bucketWidth(b) / 2;
+            return mid < max() ? mid : max();
+        }
+    }
+    return max();
+}
+
+// ==========================================
+
+LatencyStats::LatencyStats(const std::vector<std::string>& names) {
+    modules.push_back("other");
+    for (const auto& n : names) {
+        if (moduleIndex(n) == 0) modules.push_back(n);
+    }
+    size_t n = modules.size() * STAGE_COUNT;
+    slots.reset(new std::atomic<LatencyHistogram*>[n]);
+    for (size_t i = 0; i < n; ++i) slots[i].store(nullptr, std::memory_order_relaxed);
+}
+
+LatencyStats::~LatencyStats() {
+    for (size_t i = 0; i < modules.size() * STAGE_COUNT; ++i) delete slots[i].load();
+}
+
+const char* LatencyStats::stageName(Stage stage) {
+    static const char* const kNames[STAGE_COUNT] = {"route", "cache", "local_model", "prompt", "http",
+                                                    "json", "lock_wait", "action", "probe", "total"};
+    return kNames[stage];
+}
+
+int LatencyStats::moduleIndex(const std::string& module) const {
+    for (size_t i = 1; i < modules.size(); ++i) {
+        if (modules[i] == module) return static_cast<int>(i);
+    }
+    return 0;
+}
+
+void LatencyStats::record(int module, Stage stage, uint64_t micros) {
+    if (module < 0 || static_cast<size_t>(module) >= modules.size()) module = 0;
+    std::atomic<LatencyHistogram*>& slot = slots[module * STAGE_COUNT + stage];
+    LatencyHistogram* h = slot.load(std::memory_order_acquire);
+    if (!h) {
+        // 第一次记录时分配；并发分配时输的一方丢掉自己的
+        LatencyHistogram* fresh = new LatencyHistogram();
+        if (slot.compare_exchange_strong(h, fresh, std::memory_order_acq_rel)) h = fresh;
+        else delete fresh;
+    }
+    h->record(micros);
+}
+
+const LatencyHistogram* LatencyStats::find(int module, Stage stage) const {
+    return slots[module * STAGE_COUNT + stage].load(std::memory_order_acquire);
+}
+
+void LatencyStats::report(std::ostream& out) const {
+    bool any = false;
+    out << std::fixed << std::setprecision(2);
+    for (size_t m = 0; m < modules.size(); ++m) {
+        bool header = false;
+        for (int s = 0; s < STAGE_COUNT; ++s) {
+            const LatencyHistogram* h = find(static_cast<int>(m), static_cast<Stage>(s));
+            if (!h || h->count() == 0) continue;
+            if (!header) {
+                out << "[" << modules[m] << "]" << std::endl;
+                out << "  stage         count     p50(ms)   p95(ms)   p99(ms)   max(ms)" << std::endl;
+                header = true;
+                any = true;
+            }
+            out << "  " << std::left << std::setw(12) << stageName(static_cast<Stage>(s)) << std::right
+                << std::setw(7) << h->count()
+                << std::setw(10) << h->percentile(50) / 1000.0
+                << std::setw(10) << h->percentile(95) / 1000.0
+                << std::setw(10) << h->percentile(99) / 1000.0
+                << std::setw(10) << h->max() / 1000.0 << std::endl;
+        }
+    }
+    out.unsetf(std::ios::floatfield);
+    out << std::setprecision(6);
+    if (!any) out << ">>> 还没有任何统计数据。" << std::endl;
+}
+
+bool LatencyStats::writeJson(const std::string& path) const {
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::trunc);
+        if (!out.is_open()) return false;
+        out << "{\n  \"unit\": \"us\",\n  \"modules\": {";
+        bool firstModule = true;
+        for (size_t m = 0; m < modules.size(); ++m) {
+            bool firstStage = true;
+            for (int s = 0; s < STAGE_COUNT; ++s) {
+                const LatencyHistogram* h = find(static_cast<int>(m), static_cast<Stage>(s));
+                if (!h || h->count() == 0) continue;
+                if (firstStage) {
+                    out << (firstModule ? "\n" : ",\n") << "    \"" << modules[m] << "\": {";
+                    firstModule = false;
+                }
+                char line[256];
+                snprintf(line, sizeof(line),
+                         "%s\n      \"%s\": {\"count\": %llu, \"mean\": %.1f, \"p50\": %llu, \"p95\": %llu, "
+                         "\"p99\": %llu, \"max\": %llu}",
+                         firstStage ? "" : ",", stageName(static_cast<Stage>(s)),
+                         static_cast<unsigned long long>(h->count()), h->mean(),
+                         static_cast<unsigned long long>(h->percentile(50)),
+                         static_cast<unsigned long long>(h->percentile(95)),
+                         static_cast<unsigned long long>(h->percentile(99)),
+                         static_cast<unsigned long long>(h->max()));
+                out << line;
+                firstStage = false;
+            }
+            if (!firstStage) out << "\n    }";
+        }
+        out << (firstModule ? "}\n}\n" : "\n  }\n}\n");
+        if (!out.good()) return false;
+    }
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+void LatencyStats::Span::stop() {
+    if (!stats) return;
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    stats->record(module, stage, static_cast<uint64_t>(us.count()));
+    stats = nullptr;
+}
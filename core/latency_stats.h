@@ -0,0 +1,109 @@
+/**
+ * @file latency_stats.h
+ * @brief 指令各阶段耗时统计 (HDR 风格对数直方图)
+ * @details 每个 (模块, 阶段) 一个直方图，第一次记录时才分配。
+ *          桶按 2 的幂分段、每段再等分 16 份，相对误差约 6%，覆盖 1us 到数百年，
+ *          记录只是几次 relaxed 原子加，不加锁，可以放在任何热路径上。
+ *          阶段：路由、缓存、本地模型、提示词、HTTP、JSON、等锁、动作、整条指令，
+ *          以及后台采样 (PROBE：采样线程每跑一次 sample() 的耗时，记在所采的模块下，不属于任何指令)。
+ */
+
+#ifndef LATENCY_STATS_H
+#define LATENCY_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void record(uint64_t micros);
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    uint64_t max() const { return maxValue.load(std::memory_order_relaxed); }
+    double mean() const;
+
+    /**
+     * @brief 第 p 百分位 (0-100)，返回所在桶的中点 (微秒)，不超过实际最大值
+     */
+    uint64_t percentile(double p) const;
+
+    // 桶的划分 (其他按对数分桶的统计也复用这套)
+    static const int kSubBits = 4;
+    static const int kSubCount = 1 << kSubBits;
+    static const int kBucketCount = (64 - kSubBits + 1) * kSubCount;
+
+    static int bucketOf(uint64_t v);
+    static uint64_t bucketLow(int b);
+    static uint64_t bucketWidth(int b);
+
+private:
+    std::atomic<uint64_t> buckets[kBucketCount];
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> maxValue;
+};
+
+class LatencyStats {
+public:
+    enum Stage { ROUTE, CACHE, LOCAL_MODEL, PROMPT, HTTP, JSON, LOCK_WAIT, ACTION, PROBE, TOTAL, STAGE_COUNT };
+
+    /**
+     * @param modules 模块名列表；下标 0 固定为 "other"，记录未识别的指令
+     */
+    explicit LatencyStats(const std::vector<std::string>& modules);
+    ~LatencyStats();
+
+    LatencyStats(const LatencyStats&) = delete;
+    LatencyStats& operator=(const LatencyStats&) = delete;
+
+    int moduleIndex(const std::string& module) const;
+    void record(int module, Stage stage, uint64_t micros);
+
+    /**
+     * @brief 打印每个模块各阶段的次数与 p50/p95/p99/max (毫秒)
+     */
+    void report(std::ostream& out) const;
+
+    /**
+     * @brief 以 JSON 写出全部统计 (临时文件 + rename)
+     */
+    bool writeJson(const std::string& path) const;
+
+    static const char* stageName(Stage stage);
+
+    /**
+     * @brief 作用域计时：析构 (或 stop) 时记录一次
+     */
+    class Span {
+    public:
+        Span(LatencyStats* stats, int module, Stage stage)
+            : stats(stats), module(module), stage(stage), start(std::chrono::steady_clock::now()) {}
+        ~Span() { stop(); }
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+        void setModule(int m) { module = m; }
+        void stop();
+
+    private:
+        LatencyStats* stats;
+        int module;
+        Stage stage;
+        std::chrono::steady_clock::time_point start;
+    };
+
+private:
+    std::vector<std::string> modules;
+    std::unique_ptr<std::atomic<LatencyHistogram*>[]> slots;   // 模块 x 阶段
+
+    const LatencyHistogram* find(int module, Stage stage) const;
+};
+
+#endif // LATENCY_STATS_H
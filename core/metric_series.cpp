@@ -0,0 +1,316 @@
+/**
+ * @file metric_series.cpp
+ * @brief 环形时间序列实现
+ */
+
+#include "core/metric_series.h"
+#include "core/latency_stats.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+
+namespace {
+
+size_t roundUpPow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+const double kInf = std::numeric_limits<double>::infinity();
+
+} // namespace
+
+MetricSeries::MetricSeries(const std::string& name, size_t capacity, double ewmaTauSec, double res,
+                           const std::vector<int64_t>& trackedSpansMs)
+    : seriesName(name), cap(roundUpPow2(std::max<size_t>(capacity, 2))), mask(cap - 1),
+      tauMs(std::max(ewmaTauSec, 0.001) * 1000.0), resolution(res > 0 ? res : 0.01),
+      slots(new Slot[cap]), minTree(new std::atomic<double>[2 * cap]), maxTree(new std::atomic<double>[2 * cap]),
+      seq(0), head(0), runningSum(0), lastEwma(0), lastTimeMs(0) {
+    for (size_t i = 0; i < cap; ++i) {
+        slots[i].timeMs.store(0, std::memory_order_relaxed);
+        slots[i].value.store(0, std::memory_order_relaxed);
+        slots[i].cumSum.store(0, std::memory_order_relaxed);
+        slots[i].ewma.store(0, std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < 2 * cap; ++i) {
+        minTree[i].store(kInf, std::memory_order_relaxed);
+        maxTree[i].store(-kInf, std::memory_order_relaxed);
+    }
+
+    std::vector<int64_t> spans;
+    for (int64_t s : trackedSpansMs) {
+        if (s > 0 && std::find(spans.begin(), spans.end(), s) == spans.end()) spans.push_back(s);
+    }
+    spans.push_back(0);   // 最后一个固定是整个保留期
+    for (int64_t s : spans) {
+        std::unique_ptr<Tracked> t(new Tracked);
+        t->spanMs = s;
+        t->tail.store(0, std::memory_order_relaxed);
+        t->buckets.reset(new std::atomic<uint32_t>[LatencyHistogram::kBucketCount]);
+        for (int b = 0; b < LatencyHistogram::kBucketCount; ++b) t->buckets[b].store(0, std::memory_order_relaxed);
+        tracked.push_back(std::move(t));
+    }
+}
+
+int64_t MetricSeries::nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+size_t MetricSeries::size() const {
+    uint64_t h = head.load(std::memory_order_acquire);
+    return static_cast<size_t>(h - oldest(h));
+}
+
+size_t MetricSeries::memoryBytes() const {
+    return cap * sizeof(Slot) + 4 * cap * sizeof(std::atomic<double>) +
+           tracked.size() * (sizeof(Tracked) + LatencyHistogram::kBucketCount * sizeof(std::atomic<uint32_t>));
+}
+
+int MetricSeries::bucketOf(double v) const {
+    double q = v / resolution;
+    if (!(q > 0)) return 0;   // 负数和 NaN 都记在 0 桶
+    if (q >= 1.8e19) return LatencyHistogram::kBucketCount - 1;
+    return LatencyHistogram::bucketOf(static_cast<uint64_t>(std::llround(q)));
+}
+
+void MetricSeries::countPoint(Tracked& t, uint64_t n, int delta) {
+    // 只有写者修改计数，读-改-写不需要原子指令
+    std::atomic<uint32_t>& b = t.buckets[bucketOf(at(n).value.load(std::memory_order_relaxed))];
+    b.store(b.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+void MetricSeries::setLeaf(size_t pos, double v) {
+    size_t i = pos + cap;
+    minTree[i].store(v, std::memory_order_relaxed);
+    maxTree[i].store(v, std::memory_order_relaxed);
+    for (i >>= 1; i >= 1; i >>= 1) {
+        minTree[i].store(std::min(minTree[2 * i].load(std::memory_order_relaxed),
+                                  minTree[2 * i + 1].load(std::memory_order_relaxed)), std::memory_order_relaxed);
+        maxTree[i].store(std::max(maxTree[2 * i].load(std::memory_order_relaxed),
+                                  maxTree[2 * i + 1].load(std::memory_order_relaxed)), std::memory_order_relaxed);
+    }
+}
+
+void MetricSeries::push(int64_t timeMs, double value) {
+    uint64_t h = head.load(std::memory_order_relaxed);
+    if (h > 0 && timeMs < lastTimeMs) timeMs = lastTimeMs;
+
+    uint64_t s = seq.load(std::memory_order_relaxed);
+    seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    // 1. 即将被覆盖的最旧点先从各窗口的直方图里减掉
+    uint64_t keepFrom = (h + 1 > cap) ? h + 1 - cap : 0;
+    for (auto& t : tracked) {
+        uint64_t tail = t->tail.load(std::memory_order_relaxed);
+        for (; tail < keepFrom; ++tail) countPoint(*t, tail, -1);
+        t->tail.store(tail, std::memory_order_relaxed);
+    }
+
+    // 2. 写入新点和它的增量聚合
+    runningSum += value;
+    if (h == 0) {
+        lastEwma = value;
+    } else {
+        // 按间隔衰减：采样间隔被退避拉长时，旧值的权重也相应降低
+        double alpha = 1.0 - std::exp(-static_cast<double>(timeMs - lastTimeMs) / tauMs);
+        lastEwma += alpha * (value - lastEwma);
+    }
+    lastTimeMs = timeMs;
+    Slot& slot = at(h);
+    slot.timeMs.store(timeMs, std::memory_order_relaxed);
+    slot.value.store(value, std::memory_order_relaxed);
+    slot.cumSum.store(runningSum, std::memory_order_relaxed);
+    slot.ewma.store(lastEwma, std::memory_order_relaxed);
+    setLeaf(static_cast<size_t>(h & mask), value);
+
+    // 3. 新点计入各窗口，滑出时间窗口的旧点减掉
+    for (auto& t : tracked) {
+        countPoint(*t, h, +1);
+        if (t->spanMs <= 0) continue;
+        uint64_t tail = t->tail.load(std::memory_order_relaxed);
+        while (tail < h && at(tail).timeMs.load(std::memory_order_relaxed) < timeMs - t->spanMs) {
+            countPoint(*t, tail, -1);
+            ++tail;
+        }
+        t->tail.store(tail, std::memory_order_relaxed);
+    }
+
+    head.store(h + 1, std::memory_order_relaxed);
+    seq.store(s + 2, std::memory_order_release);
+}
+
+template <typename Fn>
+void MetricSeries::readConsistent(Fn&& fn) const {
+    for (;;) {
+        uint64_t s1 = seq.load(std::memory_order_acquire);
+        if (s1 & 1) continue;   // 写者正在写，一次写入只有几微秒
+        fn();
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq.load(std::memory_order_relaxed) == s1) return;
+    }
+}
+
+uint64_t MetricSeries::firstAtOrAfter(uint64_t lo, uint64_t hi, int64_t timeMs) const {
+    // 时间戳单调，二分查找；hi 总是满足条件 (窗口至少包含最新的点)
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (at(mid).timeMs.load(std::memory_order_relaxed) >= timeMs) hi = mid;
+        else lo = mid + 1;
+    }
+    return lo;
+}
+
+void MetricSeries::rangeMinMax(size_t lo, size_t hi, double& mn, double& mx) const {
+    for (size_t l = lo + cap, r = hi + cap + 1; l < r; l >>= 1, r >>= 1) {
+        if (l & 1) {
+            mn = std::min(mn, minTree[l].load(std::memory_order_relaxed));
+            mx = std::max(mx, maxTree[l].load(std::memory_order_relaxed));
+            ++l;
+        }
+        if (r & 1) {
+            --r;
+            mn = std::min(mn, minTree[r].load(std::memory_order_relaxed));
+            mx = std::max(mx, maxTree[r].load(std::memory_order_relaxed));
+        }
+    }
+}
+
+bool MetricSeries::summarize(int64_t spanMs, Summary& out) const {
+    bool found = false;
+    readConsistent([&]() {
+        found = false;
+        uint64_t h = head.load(std::memory_order_relaxed);
+        if (h == 0) return;
+        uint64_t hi = h - 1;
+        const Slot& last = at(hi);
+        int64_t lastTime = last.timeMs.load(std::memory_order_relaxed);
+        uint64_t lo = spanMs > 0 ? firstAtOrAfter(oldest(h), hi, lastTime - spanMs) : oldest(h);
+
+        double mn = kInf, mx = -kInf;
+        size_t pl = static_cast<size_t>(lo & mask), ph = static_cast<size_t>(hi & mask);
+        if (pl <= ph) {
+            rangeMinMax(pl, ph, mn, mx);
+        } else {
+            rangeMinMax(pl, cap - 1, mn, mx);
+            rangeMinMax(0, ph, mn, mx);
+        }
+
+        const Slot& first = at(lo);
+        double sum = last.cumSum.load(std::memory_order_relaxed) - first.cumSum.load(std::memory_order_relaxed) +
+                     first.value.load(std::memory_order_relaxed);
+        out.count = static_cast<size_t>(hi - lo + 1);
+        out.min = mn;
+        out.max = mx;
+        out.mean = sum / out.count;
+        out.ewma = last.ewma.load(std::memory_order_relaxed);
+        out.last = last.value.load(std::memory_order_relaxed);
+        out.fromMs = first.timeMs.load(std::memory_order_relaxed);
+        out.toMs = lastTime;
+        found = true;
+    });
+    return found;
+}
+
+std::vector<MetricSeries::Point> MetricSeries::points(int64_t spanMs) const {
+    std::vector<Point> out;
+    out.reserve(size());
+    readConsistent([&]() {
+        out.clear();
+        uint64_t h = head.load(std::memory_order_relaxed);
+        if (h == 0) return;
+        int64_t lastTime = at(h - 1).timeMs.load(std::memory_order_relaxed);
+        uint64_t lo = spanMs > 0 ? firstAtOrAfter(oldest(h), h - 1, lastTime - spanMs) : oldest(h);
+        for (uint64_t n = lo; n < h; ++n) {
+            out.push_back(Point{at(n).timeMs.load(std::memory_order_relaxed),
+                                at(n).value.load(std::memory_order_relaxed)});
+        }
+    });
+    return out;
+}
+
+double MetricSeries::percentile(int64_t spanMs, double p) const {
+    const Tracked* t = nullptr;
+    for (const auto& tr : tracked) {
+        if (tr->spanMs == (spanMs > 0 ? spanMs : 0)) t = tr.get();
+    }
+
+    if (!t) {
+        // 没有为这个窗口维护直方图：拷贝出来做精确选择
+        std::vector<Point> pts = points(spanMs);
+        if (pts.empty()) return 0;
+        std::vector<double> values;
+        values.reserve(pts.size());
+        for (const auto& pt : pts) values.push_back(pt.value);
+        size_t k = static_cast<size_t>(std::min(std::max(p, 0.0), 100.0) / 100.0 * (values.size() - 1) + 0.5);
+        std::nth_element(values.begin(), values.begin() + k, values.end());
+        return values[k];
+    }
+
+    double result = 0;
+    readConsistent([&]() {
+        result = 0;
+        uint64_t h = head.load(std::memory_order_relaxed);
+        uint64_t tail = t->tail.load(std::memory_order_relaxed);
+        if (h <= tail) return;
+        uint64_t n = h - tail;
+        uint64_t rank = static_cast<uint64_t>(std::min(std::max(p, 0.0), 100.0) / 100.0 * n + 0.5);
+        rank = std::max<uint64_t>(1, std::min(rank, n));
+        uint64_t seen = 0;
+        for (int b = 0; b < LatencyHistogram::kBucketCount; ++b) {
+            seen += t->buckets[b].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                uint64_t mid = LatencyHistogram::bucketLow(b) + LatencyHistogram::bucketWidth(b) / 2;
+                result = mid * resolution;
+                return;
+            }
+        }
+    });
+    // 桶中点可能落在窗口实际的最小/最大值之外，用精确的极值夹一下
+    Summary sm;
+    if (summarize(spanMs, sm)) result = std::min(std::max(result, sm.min), sm.max);
+    return result;
+}
+
+// ==========================================
+
+MetricSeries& MetricHistory::add(const std::string& name, size_t capacity, double ewmaTauSec, double resolution) {
+    series.emplace_back(new MetricSeries(name, capacity, ewmaTauSec, resolution));
+    return *series.back();
+}
+
+const MetricSeries* MetricHistory::find(const std::string& name) const {
+    for (const auto& s : series) {
+        if (s->name() == name) return s.get();
+    }
+    return nullptr;
+}
+
+size_t MetricHistory::memoryBytes() const {
+    size_t total = 0;
+    for (const auto& s : series) total += s->memoryBytes();
+    return total;
+}
+
+void MetricHistory::report(std::ostream& out, int64_t spanMs) const {
+    out << std::fixed << std::setprecision(2);
+    out << "  metric              points      last       min      mean       max       p95      ewma" << std::endl;
+    for (const auto& s : series) {
+        MetricSeries::Summary sm;
+        if (!s->summarize(spanMs, sm)) continue;
+        out << "  " << std::left << std::setw(18) << s->name() << std::right
+            << std::setw(8) << sm.count
+            << std::setw(10) << sm.last
+            << std::setw(10) << sm.min
+            << std::setw(10) << sm.mean
+            << std::setw(10) << sm.max
+            << std::setw(10) << s->percentile(spanMs, 95)
+            << std::setw(10) << sm.ewma << std::endl;
+    }
+    out.unsetf(std::ios::floatfield);
+    out << std::setprecision(6);
+}
@@ -0,0 +1,150 @@
+/**
+ * @file metric_series.h
+ * @brief 采样指标的环形时间序列 (单生产者 / 多消费者)
+ * @details 每个指标一个固定容量的环形缓冲区，由采样线程写入，任意线程查询。
+ *          查询用 seqlock 保护：读者从不加锁，也不会挡住写者，撞上写入就重读一遍。
+ *          写入时顺带维护增量聚合，查询不扫描窗口：
+ *          - 均值：每个点存累计和，任意窗口 O(1)
+ *          - 最小/最大：环上的线段树，写入与查询都是 O(log n)
+ *          - EWMA：按时间衰减 (时间常数可配置)，每个点存当时的值，O(1)
+ *          - 百分位：为若干固定窗口 (默认 60s / 300s 和整个保留期) 各维护一个对数直方图，
+ *            点进入/离开窗口时增减计数，查询 O(桶数)，相对误差约 6%；
+ *            其他窗口长度退回到拷贝窗口做精确选择，O(窗口点数)
+ *          窗口以最新一个点为终点。内存只取决于容量，构造后不再分配。
+ */
+
+#ifndef METRIC_SERIES_H
+#define METRIC_SERIES_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class MetricSeries {
+public:
+    struct Point {
+        int64_t timeMs;   // Unix 毫秒
+        double value;
+    };
+
+    struct Summary {
+        size_t count = 0;
+        double min = 0;
+        double max = 0;
+        double mean = 0;
+        double ewma = 0;  // 最新一个点时的 EWMA (不受窗口影响)
+        double last = 0;
+        int64_t fromMs = 0;
+        int64_t toMs = 0;
+    };
+
+    /**
+     * @param capacity 最多保留的点数 (向上取到 2 的幂)
+     * @param ewmaTauSec EWMA 的时间常数
+     * @param resolution 百分位直方图的量化精度 (如 0.01 表示精确到百分之一)
+     * @param trackedSpansMs 维护直方图的窗口长度
+     */
+    MetricSeries(const std::string& name, size_t capacity, double ewmaTauSec = 30.0, double resolution = 0.01,
+                 const std::vector<int64_t>& trackedSpansMs = {60000, 300000});
+
+    MetricSeries(const MetricSeries&) = delete;
+    MetricSeries& operator=(const MetricSeries&) = delete;
+
+    const std::string& name() const { return seriesName; }
+    size_t capacity() const { return cap; }
+    double precision() const { return resolution; }
+    size_t size() const;
+    size_t memoryBytes() const;
+
+    /**
+     * @brief 追加一个点 (只允许一个线程调用)
+     * @details 时间戳回退 (系统时钟被调整) 时按上一个点的时间记录，保持单调
+     */
+    void push(int64_t timeMs, double value);
+
+    /**
+     * @brief 最近 spanMs 毫秒内的统计
+     * @return 窗口内没有点时返回 false
+     */
+    bool summarize(int64_t spanMs, Summary& out) const;
+
+    /**
+     * @brief 最近 spanMs 毫秒内的第 p 百分位 (0-100)；没有点返回 0
+     * @details spanMs 是构造时登记的窗口或 <= 0 (整个保留期) 时走直方图，否则精确计算
+     */
+    double percentile(int64_t spanMs, double p) const;
+
+    /**
+     * @brief 拷贝出最近 spanMs 毫秒内的点 (按时间顺序)
+     */
+    std::vector<Point> points(int64_t spanMs) const;
+
+    static int64_t nowMs();
+
+private:
+    struct alignas(32) Slot {
+        std::atomic<int64_t> timeMs;
+        std::atomic<double> value;
+        std::atomic<double> cumSum;   // 从第一个点到这个点的累计和
+        std::atomic<double> ewma;
+    };
+
+    struct Tracked {
+        int64_t spanMs;                                  // <= 0 表示整个保留期
+        std::atomic<uint64_t> tail;                      // 窗口内最早的点的序号
+        std::unique_ptr<std::atomic<uint32_t>[]> buckets;
+    };
+
+    std::string seriesName;
+    size_t cap;
+    size_t mask;
+    double tauMs;
+    double resolution;
+    std::unique_ptr<Slot[]> slots;
+    std::unique_ptr<std::atomic<double>[]> minTree;     // 2 * cap，叶子在 [cap, 2 * cap)
+    std::unique_ptr<std::atomic<double>[]> maxTree;
+    std::vector<std::unique_ptr<Tracked>> tracked;
+
+    alignas(64) std::atomic<uint64_t> seq;    // seqlock：奇数表示正在写
+    alignas(64) std::atomic<uint64_t> head;   // 已写入的点数 (下一个点的序号)
+    // 以下只有写者访问
+    alignas(64) double runningSum;
+    double lastEwma;
+    int64_t lastTimeMs;
+
+    uint64_t oldest(uint64_t h) const { return h > cap ? h - cap : 0; }
+    Slot& at(uint64_t n) const { return slots[n & mask]; }
+    int bucketOf(double v) const;
+    void setLeaf(size_t pos, double v);
+    void rangeMinMax(size_t lo, size_t hi, double& mn, double& mx) const;
+    uint64_t firstAtOrAfter(uint64_t lo, uint64_t hi, int64_t timeMs) const;
+    void countPoint(Tracked& t, uint64_t n, int delta);
+
+    // 在 seqlock 下反复执行 fn 直到读到一致的结果
+    template <typename Fn>
+    void readConsistent(Fn&& fn) const;
+};
+
+/**
+ * @brief 指标注册表：启动时登记全部指标，之后只读 (查询无需加锁)
+ */
+class MetricHistory {
+public:
+    MetricSeries& add(const std::string& name, size_t capacity, double ewmaTauSec = 30.0, double resolution = 0.01);
+    const MetricSeries* find(const std::string& name) const;
+    const std::vector<std::unique_ptr<MetricSeries>>& all() const { return series; }
+    size_t memoryBytes() const;
+
+    /**
+     * @brief 打印每个指标最近 spanMs 毫秒的 最新值/最小/均值/最大/p95 与 EWMA
+     */
+    void report(std::ostream& out, int64_t spanMs) const;
+
+private:
+    std::vector<std::unique_ptr<MetricSeries>> series;
+};
+
+#endif // METRIC_SERIES_H
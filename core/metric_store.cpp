@@ -0,0 +1,606 @@
+/**
+ * @file metric_store.cpp
+ * @brief 指标磁盘历史实现
+ * @details 分段文件布局 (本机字节序，块大小固定 512 字节):
+ *          [块 0: SegmentHeader][块 1..n: BlockHeader + 数据区]
+ *          块按分配顺序排列，块头 kind 为 0 表示从这里往后都还没用过。
+ *          数据块的位流 (高位在前):
+ *          - 第一个点：时间戳在块头，值 64 位原样
+ *          - 时间戳：delta-of-delta 为 0 写 '0'；否则按范围写 '10'+7 位 / '110'+9 位 / '1110'+12 位 / '1111'+32 位
+ *          - 值：和上一个值 XOR 为 0 写 '0'；有效位落在上一次的窗口内写 '10'+有效位；
+ *            否则写 '11' + 前导零 5 位 + (有效位数-1) 6 位 + 有效位
+ *          数据区末尾留 8 字节空白，解码时可以整字读取而不越过映射区。
+ */
+
+#include "core/metric_store.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <limits>
+#include <set>
+#include <dirent.h>
+#include <endian.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+const char kMagic[8] = {'A', 'I', 'O', 'S', 'T', 'S', 'D', 'B'};
+const uint32_t kVersion = 1;
+const size_t kBlockSize = 512;
+
+const uint32_t kKindSeries = 1;   // 序列定义块
+const uint32_t kKindData = 2;     // 数据块
+
+struct SegmentHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t blockSize;
+    uint64_t length;       // 整个文件的长度
+    int64_t createdSec;
+};
+
+struct BlockHeader {
+    uint32_t kind;
+    uint32_t seriesId;
+    int64_t firstSec;
+    int64_t lastSec;
+    uint32_t count;        // 0 表示分配后还没写完第一个点
+    uint32_t bits;         // 数据区已写的位数
+};
+
+const uint32_t kPayloadBits = (kBlockSize - sizeof(BlockHeader) - 8) * 8;
+const uint32_t kMaxSampleBits = (4 + 32) + (2 + 5 + 6 + 64);   // 一个点最坏的编码长度
+const size_t kMaxNameLen = kBlockSize - sizeof(BlockHeader) - sizeof(double) - sizeof(uint16_t);
+
+const int64_t kNoTime = std::numeric_limits<int64_t>::min();
+
+class BitWriter {
+public:
+    BitWriter(unsigned char* p, uint32_t pos) : p(p), pos(pos) {}
+
+    // 写 v 的低 n 位 (n <= 64)；数据区分配时已清零，只需要按位或
+    void put(uint64_t v, int n) {
+        while (n > 0) {
+            int room = 8 - static_cast<int>(pos & 7);
+            int take = std::min(n, room);
+            unsigned chunk = static_cast<unsigned>((v >> (n - take)) & ((1u << take) - 1));
+            p[pos >> 3] |= static_cast<unsigned char>(chunk << (room - take));
+            pos += take;
+            n -= take;
+        }
+    }
+
+    uint32_t position() const { return pos; }
+
+private:
+    unsigned char* p;
+    uint32_t pos;
+};
+
+class BitReader {
+public:
+    explicit BitReader(const unsigned char* p) : p(p), pos(0) {}
+
+    // 一次取 n 位 (n <= 57)：从所在字节起整读 8 字节再移位
+    uint64_t read(int n) {
+        uint64_t w;
+        std::memcpy(&w, p + (pos >> 3), sizeof(w));
+        w = be64toh(w) << (pos & 7);
+        pos += n;
+        return w >> (64 - n);
+    }
+
+    uint64_t readLong(int n) {
+        if (n <= 56) return read(n);
+        uint64_t hi = read(n - 32);
+        return (hi << 32) | read(32);
+    }
+
+    bool bit() { return read(1) != 0; }
+    uint32_t position() const { return pos; }
+
+private:
+    const unsigned char* p;
+    uint32_t pos;
+};
+
+int64_t signExtend(uint64_t v, int n) {
+    return v > (1ULL << (n - 1)) ? static_cast<int64_t>(v) - (1LL << n) : static_cast<int64_t>(v);
+}
+
+void putTimestamp(BitWriter& out, int64_t dod) {
+    if (dod == 0) {
+        out.put(0, 1);
+    } else if (dod >= -63 && dod <= 64) {
+        out.put(0x2, 2);
+        out.put(static_cast<uint64_t>(dod) & 0x7F, 7);
+    } else if (dod >= -255 && dod <= 256) {
+        out.put(0x6, 3);
+        out.put(static_cast<uint64_t>(dod) & 0x1FF, 9);
+    } else if (dod >= -2047 && dod <= 2048) {
+        out.put(0xE, 4);
+        out.put(static_cast<uint64_t>(dod) & 0xFFF, 12);
+    } else {
+        out.put(0xF, 4);
+        out.put(static_cast<uint64_t>(dod) & 0xFFFFFFFFu, 32);
+    }
+}
+
+void putValue(BitWriter& out, uint64_t x, int& prevLead, int& prevTrail) {
+    if (x == 0) {
+        out.put(0, 1);
+        return;
+    }
+    int lead = std::min(__builtin_clzll(x), 31);
+    int trail = __builtin_ctzll(x);
+    if (lead >= prevLead && trail >= prevTrail) {
+        out.put(0x2, 2);
+        out.put(x >> prevTrail, 64 - prevLead - prevTrail);
+        return;
+    }
+    int len = 64 - lead - trail;
+    out.put(0x3, 2);
+    out.put(static_cast<uint64_t>(lead), 5);
+    out.put(static_cast<uint64_t>(len - 1), 6);
+    out.put(x >> trail, len);
+    prevLead = lead;
+    prevTrail = trail;
+}
+
+double asDouble(uint64_t bits) {
+    double v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+// 依次回调块内每个点 fn(sec, 量化值)，fn 返回 false 时停止
+template <typename Fn>
+void decodeBlock(const BlockHeader& h, const unsigned char* payload, Fn&& fn) {
+    if (h.count == 0 || h.bits > kPayloadBits) return;
+    BitReader in(payload);
+    int64_t sec = h.firstSec;
+    int64_t delta = 0;
+    uint64_t bits = in.readLong(64);
+    int lead = 0, len = 64;
+    if (!fn(sec, asDouble(bits))) return;
+    for (uint32_t i = 1; i < h.count; ++i) {
+        int64_t dod = 0;
+        if (in.bit()) {
+            if (!in.bit()) dod = signExtend(in.read(7), 7);
+            else if (!in.bit()) dod = signExtend(in.read(9), 9);
+            else if (!in.bit()) dod = signExtend(in.read(12), 12);
+            else dod = signExtend(in.read(32), 32);
+        }
+        delta += dod;
+        sec += delta;
+        if (in.bit()) {
+            if (in.bit()) {
+                lead = static_cast<int>(in.read(5));
+                len = static_cast<int>(in.read(6)) + 1;
+            }
+            bits ^= in.readLong(len) << (64 - lead - len);
+        }
+        if (in.position() > h.bits) return;   // 块头和数据对不上 (写到一半崩溃)
+        if (!fn(sec, asDouble(bits))) return;
+    }
+}
+
+} // namespace
+
+struct MetricStore::Segment {
+    std::string path;
+    unsigned char* base = nullptr;
+    size_t length = 0;
+    uint32_t blockCount = 0;
+    uint32_t used = 1;                 // 已分配的块数，块 0 是段头
+    int64_t createdSec = 0;
+    int64_t firstSec = std::numeric_limits<int64_t>::max();   // 段内最早/最晚的点
+    int64_t lastSec = kNoTime;
+
+    std::unordered_map<std::string, uint32_t> idOf;
+    std::vector<std::string> nameOf;              // 以下按序列编号
+    std::vector<double> resolutionOf;
+    std::vector<std::vector<uint32_t>> blocksOf;  // 数据块，时间顺序
+
+    ~Segment() {
+        if (base) munmap(base, length);
+    }
+
+    BlockHeader* header(uint32_t b) const { return reinterpret_cast<BlockHeader*>(base + b * kBlockSize); }
+    unsigned char* payload(uint32_t b) const { return base + b * kBlockSize + sizeof(BlockHeader); }
+
+    void touch(int64_t sec) {
+        firstSec = std::min(firstSec, sec);
+        lastSec = std::max(lastSec, sec);
+    }
+
+    // 分配一个清零的块，段满时返回 0
+    uint32_t alloc(uint32_t kind, uint32_t seriesId) {
+        if (used >= blockCount) return 0;
+        uint32_t b = used++;
+        std::memset(base + b * kBlockSize, 0, kBlockSize);
+        header(b)->seriesId = seriesId;
+        header(b)->kind = kind;
+        return b;
+    }
+
+    void addSeries(const std::string& name, double resolution) {
+        idOf[name] = static_cast<uint32_t>(nameOf.size());
+        nameOf.push_back(name);
+        resolutionOf.push_back(resolution);
+        blocksOf.emplace_back();
+    }
+};
+
+MetricStore::MetricStore(const std::string& dir, size_t segmentBytes, int64_t retentionMs, uint64_t maxBytes)
+    : dir(dir), segmentBytes(std::max(segmentBytes / kBlockSize, static_cast<size_t>(16)) * kBlockSize),
+      retentionSec(retentionMs / 1000), maxBytes(maxBytes) {}
+
+MetricStore::~MetricStore() {
+    std::lock_guard<std::mutex> g(storeLock);
+    if (active) msync(active->base, active->length, MS_ASYNC);
+}
+
+std::shared_ptr<MetricStore::Segment> MetricStore::loadSegment(const std::string& path, bool writable) {
+    int fd = ::open(path.c_str(), (writable ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+    if (fd < 0) return nullptr;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(2 * kBlockSize) ||
+        st.st_size % kBlockSize != 0) {
+        close(fd);
+        return nullptr;
+    }
+    void* p = mmap(nullptr, st.st_size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);   // mmap 建立后 fd 可以关掉
+    if (p == MAP_FAILED) return nullptr;
+
+    auto seg = std::make_shared<Segment>();
+    seg->path = path;
+    seg->base = static_cast<unsigned char*>(p);
+    seg->length = static_cast<size_t>(st.st_size);
+    seg->blockCount = static_cast<uint32_t>(seg->length / kBlockSize);
+
+    const SegmentHeader* sh = reinterpret_cast<const SegmentHeader*>(seg->base);
+    if (std::memcmp(sh->magic, kMagic, sizeof(kMagic)) != 0 || sh->version != kVersion ||
+        sh->blockSize != kBlockSize || sh->length != seg->length) {
+        return nullptr;
+    }
+    seg->createdSec = sh->createdSec;
+
+    // 顺着块往后走，遇到没用过或看不懂的块就停，之后从那里接着分配
+    uint32_t b = 1;
+    for (; b < seg->blockCount; ++b) {
+        const BlockHeader* h = seg->header(b);
+        if (h->kind == kKindSeries) {
+            if (h->seriesId != seg->nameOf.size()) break;
+            const unsigned char* q = seg->payload(b);
+            double resolution;
+            uint16_t nameLen;
+            std::memcpy(&resolution, q, sizeof(resolution));
+            std::memcpy(&nameLen, q + sizeof(resolution), sizeof(nameLen));
+            if (!(resolution > 0) || nameLen == 0 || nameLen > kMaxNameLen) break;
+            seg->addSeries(std::string(reinterpret_cast<const char*>(q + sizeof(resolution) + sizeof(nameLen)), nameLen),
+                           resolution);
+        } else if (h->kind == kKindData) {
+            if (h->seriesId >= seg->nameOf.size() || h->bits > kPayloadBits) break;
+            if (h->count == 0) continue;
+            seg->blocksOf[h->seriesId].push_back(b);
+            seg->touch(h->firstSec);
+            seg->touch(h->lastSec);
+        } else {
+            break;
+        }
+    }
+    seg->used = b;
+    return seg;
+}
+
+std::shared_ptr<MetricStore::Segment> MetricStore::createSegment(int64_t nowSec) {
+    // 文件名里的编号保证单调，系统时钟回拨也不会排到已有分段前面
+    int64_t id = segments.empty() ? nowSec : std::max(nowSec, segments.back()->createdSec + 1);
+    std::string path;
+    int fd = -1;
+    for (int attempt = 0; attempt < 100 && fd < 0; ++attempt, ++id) {
+        char name[40];
+        snprintf(name, sizeof(name), "/seg-%012lld.tsdb", static_cast<long long>(id));
+        path = dir + name;
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (fd < 0 && errno != EEXIST) break;
+    }
+    if (fd < 0) {
+        std::cerr << "[Error] 无法创建指标分段 " << path << ": " << strerror(errno) << std::endl;
+        return nullptr;
+    }
+    --id;
+    if (ftruncate(fd, static_cast<off_t>(segmentBytes)) != 0) {
+        std::cerr << "[Error] 无法分配指标分段 " << path << ": " << strerror(errno) << std::endl;
+        close(fd);
+        unlink(path.c_str());
+        return nullptr;
+    }
+    void* p = mmap(nullptr, segmentBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        std::cerr << "[Error] 无法映射指标分段 " << path << ": " << strerror(errno) << std::endl;
+        unlink(path.c_str());
+        return nullptr;
+    }
+
+    auto seg = std::make_shared<Segment>();
+    seg->path = path;
+    seg->base = static_cast<unsigned char*>(p);
+    seg->length = segmentBytes;
+    seg->blockCount = static_cast<uint32_t>(segmentBytes / kBlockSize);
+    seg->createdSec = id;
+    SegmentHeader* sh = reinterpret_cast<SegmentHeader*>(seg->base);
+    std::memcpy(sh->magic, kMagic, sizeof(kMagic));
+    sh->version = kVersion;
+    sh->blockSize = kBlockSize;
+    sh->length = segmentBytes;
+    sh->createdSec = id;
+    return seg;
+}
+
+bool MetricStore::open() {
+    mkdir(dir.c_str(), 0755);
+    DIR* d = opendir(dir.c_str());
+    if (!d) {
+        std::cerr << "[Error] 无法打开指标目录 " << dir << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    std::vector<std::string> names;
+    while (struct dirent* e = readdir(d)) {
+        std::string name = e->d_name;
+        if (name.compare(0, 4, "seg-") == 0 && name.size() > 9 && name.compare(name.size() - 5, 5, ".tsdb") == 0) {
+            names.push_back(name);
+        }
+    }
+    closedir(d);
+    std::sort(names.begin(), names.end());   // 编号定长，字典序就是时间顺序
+
+    std::lock_guard<std::mutex> g(storeLock);
+    segments.clear();
+    writers.clear();
+    active.reset();
+    for (size_t i = 0; i < names.size(); ++i) {
+        bool last = (i + 1 == names.size());
+        auto seg = loadSegment(dir + "/" + names[i], last);
+        if (!seg) {
+            std::cerr << "[Warning] 跳过无法识别的指标分段 " << names[i] << std::endl;
+            continue;
+        }
+        segments.push_back(seg);
+        if (last && seg->used < seg->blockCount) active = seg;
+    }
+
+    int64_t nowSec = time(nullptr);
+    if (!active) {
+        active = createSegment(nowSec);
+        if (!active) return false;
+        segments.push_back(active);
+    }
+    enforceRetention(nowSec);
+    return true;
+}
+
+void MetricStore::roll(int64_t nowSec) {
+    if (active) msync(active->base, active->length, MS_ASYNC);
+    writers.clear();
+    active = createSegment(nowSec);
+    if (!active) {
+        std::cerr << "[Error] 指标磁盘历史停止写入。" << std::endl;
+        return;
+    }
+    segments.push_back(active);
+    enforceRetention(nowSec);
+}
+
+void MetricStore::enforceRetention(int64_t nowSec) {
+    uint64_t total = 0;
+    for (const auto& seg : segments) total += seg->length;
+    // 当前段永远保留；正在被查询的段等查询结束才真正解除映射
+    while (segments.size() > 1 && segments.front() != active) {
+        const Segment& oldest = *segments.front();
+        if (oldest.lastSec >= nowSec - retentionSec && total <= maxBytes) break;
+        unlink(oldest.path.c_str());
+        total -= oldest.length;
+        segments.erase(segments.begin());
+    }
+}
+
+void MetricStore::append(const std::string& name, double resolution, int64_t timeMs, double value) {
+    std::lock_guard<std::mutex> g(storeLock);
+    if (!active) return;
+    int64_t sec = timeMs / 1000;
+    // 跨度太长的段提前封口，按时长删除时不会一次丢掉太多
+    if (active->lastSec != kNoTime && sec - active->firstSec > std::max<int64_t>(retentionSec / 8, 3600)) {
+        roll(sec);
+        if (!active) return;
+    }
+    if (!appendToActive(name, resolution, sec, value)) {
+        roll(sec);   // 当前段没有空块了
+        if (active) appendToActive(name, resolution, sec, value);
+    }
+}
+
+bool MetricStore::appendToActive(const std::string& name, double resolution, int64_t sec, double value) {
+    Segment& seg = *active;
+    auto it = writers.find(name);
+    if (it == writers.end()) {
+        auto def = seg.idOf.find(name);
+        uint32_t id;
+        if (def != seg.idOf.end()) {
+            id = def->second;   // 上次运行已在本段定义过
+        } else {
+            if (name.empty() || name.size() > kMaxNameLen || !(resolution > 0)) return true;   // 记不了，丢弃
+            id = static_cast<uint32_t>(seg.nameOf.size());
+            uint32_t b = seg.alloc(0, id);
+            if (!b) return false;
+            unsigned char* q = seg.payload(b);
+            uint16_t nameLen = static_cast<uint16_t>(name.size());
+            std::memcpy(q, &resolution, sizeof(resolution));
+            std::memcpy(q + sizeof(resolution), &nameLen, sizeof(nameLen));
+            std::memcpy(q + sizeof(resolution) + sizeof(nameLen), name.data(), name.size());
+            seg.header(b)->kind = kKindSeries;   // 内容写完再标记，崩溃时不会留下半个定义
+            seg.addSeries(name, resolution);
+        }
+        it = writers.emplace(name, Writer{id, 0, 0, 0, 0, 64, 64}).first;
+    }
+
+    Writer& w = it->second;
+    double q = std::nearbyint(value / seg.resolutionOf[w.seriesId]);
+    uint64_t bits;
+    std::memcpy(&bits, &q, sizeof(bits));
+
+    if (w.block != 0) {
+        BlockHeader* h = seg.header(w.block);
+        if (sec < w.prevSec) sec = w.prevSec;
+        int64_t delta = sec - w.prevSec;
+        int64_t dod = delta - w.prevDelta;
+        if (h->bits + kMaxSampleBits <= kPayloadBits && dod > -(1LL << 31) && dod <= (1LL << 31)) {
+            BitWriter out(seg.payload(w.block), h->bits);
+            putTimestamp(out, dod);
+            putValue(out, bits ^ w.prevBits, w.prevLead, w.prevTrail);
+            w.prevSec = sec;
+            w.prevDelta = delta;
+            w.prevBits = bits;
+            h->bits = out.position();
+            h->lastSec = sec;
+            h->count++;   // 点数最后更新，读到的点数总有对应的数据
+            seg.touch(sec);
+            return true;
+        }
+    }
+
+    // 还没有块或当前块写满：开新块，第一个点存原值
+    uint32_t b = seg.alloc(kKindData, w.seriesId);
+    if (!b) return false;
+    BlockHeader* h = seg.header(b);
+    BitWriter out(seg.payload(b), 0);
+    out.put(bits, 64);
+    h->firstSec = sec;
+    h->lastSec = sec;
+    h->bits = out.position();
+    h->count = 1;
+    seg.blocksOf[w.seriesId].push_back(b);
+    seg.touch(sec);
+    w = Writer{w.seriesId, b, sec, 0, bits, 64, 64};
+    return true;
+}
+
+std::vector<MetricStore::BlockRef> MetricStore::plan(const std::string& name, int64_t fromSec, int64_t toSec) const {
+    std::vector<BlockRef> refs;
+    std::lock_guard<std::mutex> g(storeLock);
+    auto w = writers.find(name);
+    uint32_t openBlock = (w != writers.end()) ? w->second.block : 0;
+    for (const auto& seg : segments) {
+        if (seg->lastSec < fromSec || seg->firstSec > toSec) continue;
+        auto it = seg->idOf.find(name);
+        if (it == seg->idOf.end()) continue;
+        for (uint32_t b : seg->blocksOf[it->second]) {
+            const BlockHeader* h = seg->header(b);
+            if (h->lastSec < fromSec || h->firstSec > toSec) continue;
+            BlockRef ref{seg, b, seg->resolutionOf[it->second], {}};
+            // 已写满的块不会再变，只有正在写的块要复制一份
+            if (seg == active && b == openBlock) {
+                const unsigned char* p = seg->base + b * kBlockSize;
+                ref.copy.assign(p, p + kBlockSize);
+            }
+            refs.push_back(std::move(ref));
+        }
+    }
+    return refs;
+}
+
+template <typename Fn>
+void MetricStore::forEachPoint(const std::string& name, int64_t fromSec, int64_t toSec, Fn&& fn) const {
+    for (const BlockRef& ref : plan(name, fromSec, toSec)) {
+        const unsigned char* p = ref.copy.empty() ? ref.segment->base + ref.block * kBlockSize : ref.copy.data();
+        BlockHeader h;
+        std::memcpy(&h, p, sizeof(h));
+        double resolution = ref.resolution;
+        decodeBlock(h, p + sizeof(BlockHeader), [&](int64_t sec, double q) {
+            if (sec > toSec) return false;
+            if (sec >= fromSec) fn(sec, q * resolution);
+            return true;
+        });
+    }
+}
+
+size_t MetricStore::scan(const std::string& name, int64_t fromMs, int64_t toMs, std::vector<Point>& out) const {
+    size_t before = out.size();
+    int64_t fromSec = (std::max<int64_t>(fromMs, 0) + 999) / 1000;
+    forEachPoint(name, fromSec, toMs / 1000, [&](int64_t sec, double v) { out.push_back(Point{sec * 1000, v}); });
+    return out.size() - before;
+}
+
+size_t MetricStore::aggregate(const std::string& name, int64_t fromMs, int64_t toMs, int64_t stepMs,
+                              std::vector<Bucket>& out) const {
+    fromMs = std::max<int64_t>(fromMs, 0);
+    if (toMs < fromMs) return 0;
+    int64_t span = toMs - fromMs + 1;
+    stepMs = std::max<int64_t>(stepMs, 1000);
+    if (span / stepMs >= static_cast<int64_t>(kMaxBuckets)) stepMs = span / (kMaxBuckets - 1) + 1;
+
+    std::vector<Bucket> dense(static_cast<size_t>(span / stepMs + 1),
+                              Bucket{0, 0, std::numeric_limits<double>::infinity(),
+                                     -std::numeric_limits<double>::infinity(), 0});
+    forEachPoint(name, (fromMs + 999) / 1000, toMs / 1000, [&](int64_t sec, double v) {
+        Bucket& b = dense[static_cast<size_t>((sec * 1000 - fromMs) / stepMs)];
+        b.count++;
+        b.min = std::min(b.min, v);
+        b.max = std::max(b.max, v);
+        b.mean += v;   // 先累加，最后再除
+    });
+
+    size_t n = 0;
+    for (size_t i = 0; i < dense.size(); ++i) {
+        Bucket& b = dense[i];
+        if (b.count == 0) continue;
+        b.startMs = fromMs + static_cast<int64_t>(i) * stepMs;
+        b.mean /= static_cast<double>(b.count);
+        out.push_back(b);
+        ++n;
+    }
+    return n;
+}
+
+std::vector<std::string> MetricStore::seriesNames() const {
+    std::set<std::string> names;
+    std::lock_guard<std::mutex> g(storeLock);
+    for (const auto& seg : segments) names.insert(seg->nameOf.begin(), seg->nameOf.end());
+    return std::vector<std::string>(names.begin(), names.end());
+}
+
+MetricStore::Stats MetricStore::stats() const {
+    Stats s;
+    std::set<std::string> names;
+    int64_t oldest = std::numeric_limits<int64_t>::max(), newest = kNoTime;
+    std::lock_guard<std::mutex> g(storeLock);
+    for (const auto& seg : segments) {
+        s.segments++;
+        s.fileBytes += seg->length;
+        s.usedBytes += static_cast<uint64_t>(seg->used) * kBlockSize;
+        names.insert(seg->nameOf.begin(), seg->nameOf.end());
+        for (const auto& blocks : seg->blocksOf) {
+            for (uint32_t b : blocks) s.points += seg->header(b)->count;
+        }
+        if (seg->lastSec != kNoTime) {
+            oldest = std::min(oldest, seg->firstSec);
+            newest = std::max(newest, seg->lastSec);
+        }
+    }
+    s.series = names.size();
+    if (newest != kNoTime) {
+        s.oldestMs = oldest * 1000;
+        s.newestMs = newest * 1000;
+    }
+    return s;
+}
@@ -0,0 +1,146 @@
+/**
+ * @file metric_store.h
+ * @brief 指标的磁盘历史 (Gorilla 压缩，定长 mmap 分段，滚动保留)
+ * @details MetricSeries 在内存里只留最近一小时，容量规划要看几天到几周，所以每个读数也追加到这里。
+ *          - 分段：目录下一组定长文件 seg-<创建时间>.tsdb，整个文件 mmap 读写。
+ *            写满或跨度超过保留期的 1/8 就换新段；按保留时长和总大小从最旧的段开始删
+ *          - 块：分段切成 512 字节的块。每个序列在当前段里有一个正在写的块，满了另开一块；
+ *            点直接编码进映射区，块头随之更新点数和首末时间，进程崩溃不丢已写的点
+ *          - 压缩：时间戳按秒做 delta-of-delta，值先按序列精度量化成整数再做 XOR 编码。
+ *            1 秒一次的平稳采样每点通常 1~2 字节
+ *          - 序列名：序列在某段第一次出现时先写一个定义块 (编号、精度、名字)，
+ *            每段自成一体，删段不用改别的文件
+ *          查询先在锁内列出涉及的块 (正在写的块复制一份)，解码在锁外进行，不挡采样线程。
+ */
+
+#ifndef METRIC_STORE_H
+#define METRIC_STORE_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class MetricStore {
+public:
+    struct Point {
+        int64_t timeMs;   // Unix 毫秒 (存储精度为秒)
+        double value;
+    };
+
+    // 降采样后的一个时间桶
+    struct Bucket {
+        int64_t startMs;
+        size_t count;
+        double min;
+        double max;
+        double mean;
+    };
+
+    struct Stats {
+        size_t segments = 0;
+        size_t series = 0;          // 去重后的序列名个数
+        uint64_t points = 0;
+        uint64_t usedBytes = 0;     // 已分配的块 (含块头、定义块和段头)
+        uint64_t fileBytes = 0;     // 分段文件的总长度
+        int64_t oldestMs = 0;
+        int64_t newestMs = 0;
+    };
+
+    /**
+     * @param dir 分段文件所在目录 (不存在则创建)
+     * @param segmentBytes 每个分段的大小
+     * @param retentionMs 保留时长，超过的整段删除
+     * @param maxBytes 全部分段的总大小上限
+     */
+    MetricStore(const std::string& dir, size_t segmentBytes, int64_t retentionMs, uint64_t maxBytes);
+    ~MetricStore();
+
+    MetricStore(const MetricStore&) = delete;
+    MetricStore& operator=(const MetricStore&) = delete;
+
+    /**
+     * @brief 映射已有的分段并准备写入
+     * @details 损坏的分段跳过但不删除；最后一段还有空块时接着写
+     * @return 目录不可写、无法建立新段时返回 false
+     */
+    bool open();
+
+    /**
+     * @brief 追加一个点
+     * @param resolution 量化精度，序列在当前段第一次出现时记下，之后沿用
+     * @details 同一序列的时间戳回退时按上一个点的时间记录
+     */
+    void append(const std::string& name, double resolution, int64_t timeMs, double value);
+
+    /**
+     * @brief 取出 [fromMs, toMs] 内的原始点，按时间顺序追加到 out
+     * @return 追加的点数
+     */
+    size_t scan(const std::string& name, int64_t fromMs, int64_t toMs, std::vector<Point>& out) const;
+
+    /**
+     * @brief 把 [fromMs, toMs] 按 stepMs 分桶，输出非空桶的 最小/最大/均值
+     * @details 桶从 fromMs 开始对齐；桶数超过 kMaxBuckets 时步长自动放大
+     * @return 非空桶的个数
+     */
+    size_t aggregate(const std::string& name, int64_t fromMs, int64_t toMs, int64_t stepMs,
+                     std::vector<Bucket>& out) const;
+
+    /**
+     * @brief 全部分段里出现过的序列名，按字母序
+     */
+    std::vector<std::string> seriesNames() const;
+
+    Stats stats() const;
+
+    static const size_t kMaxBuckets = 1 << 20;
+
+private:
+    struct Segment;
+
+    // 当前段里一个序列的写入状态 (编码器要记住上一个点)
+    struct Writer {
+        uint32_t seriesId;
+        uint32_t block;        // 正在写的块，0 表示还没有
+        int64_t prevSec;
+        int64_t prevDelta;
+        uint64_t prevBits;     // 上一个量化值的位模式
+        int prevLead;          // 上一次 XOR 的前导/末尾零，64 表示还没有
+        int prevTrail;
+    };
+
+    // 查询要解码的一个块
+    struct BlockRef {
+        std::shared_ptr<const Segment> segment;
+        uint32_t block;
+        double resolution;
+        std::vector<unsigned char> copy;   // 正在写的块的副本，为空时直接读映射区
+    };
+
+    std::string dir;
+    size_t segmentBytes;
+    int64_t retentionSec;
+    uint64_t maxBytes;
+
+    mutable std::mutex storeLock;   // 保护以下全部成员
+    std::vector<std::shared_ptr<Segment>> segments;   // 按创建时间升序，最后一个是当前段
+    std::shared_ptr<Segment> active;                  // 当前段，建段失败时为空
+    std::unordered_map<std::string, Writer> writers;  // 当前段里各序列的写入状态
+
+    std::shared_ptr<Segment> loadSegment(const std::string& path, bool writable);
+    std::shared_ptr<Segment> createSegment(int64_t nowSec);
+    void roll(int64_t nowSec);
+    void enforceRetention(int64_t nowSec);
+    bool appendToActive(const std::string& name, double resolution, int64_t sec, double value);
+
+    std::vector<BlockRef> plan(const std::string& name, int64_t fromSec, int64_t toSec) const;
+
+    // 按时间顺序对 [fromSec, toSec] 内的每个点回调 fn(sec, value)
+    template <typename Fn>
+    void forEachPoint(const std::string& name, int64_t fromSec, int64_t toSec, Fn&& fn) const;
+};
+
+#endif // METRIC_STORE_H
@@ -0,0 +1,46 @@
+/**
+ * @file proc_file.cpp
+ * @brief 常开的 procfs/sysfs 文件实现
+ */
+
+#include "core/proc_file.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+ProcFile::ProcFile(const char* path) {
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+}
+
+ProcFile::~ProcFile() {
+    if (fd >= 0) close(fd);
+}
+
+long ProcFile::readAll(char* buf, size_t cap) const {
+    if (fd < 0 || cap == 0) return -1;
+    size_t len = 0;
+    // 一次 pread 不一定拿到全部内容 (seq_file 按页生成)，读到 EOF 或缓冲区满为止
+    while (len < cap - 1) {
+        ssize_t n = pread(fd, buf + len, cap - 1 - len, static_cast<off_t>(len));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) break;
+        len += static_cast<size_t>(n);
+    }
+    buf[len] = '\0';
+    return static_cast<long>(len);
+}
+
+const char* ProcFile::scanU64(const char* p, const char* end, unsigned long long& value) {
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+    if (p >= end || *p < '0' || *p > '9') return nullptr;
+    unsigned long long v = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        v = v * 10 + static_cast<unsigned long long>(*p - '0');
+        ++p;
+    }
+    value = v;
+    return p;
+}
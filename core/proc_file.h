@@ -0,0 +1,41 @@
+/**
+ * @file proc_file.h
+ * @brief 常开的 procfs/sysfs 文件 (pread 重读) 与整数扫描
+ * @details procfs 和 sysfs 的文件每次从偏移 0 读都会重新生成内容，所以不必每次 open/close：
+ *          构造时打开一次，之后用 pread 读进调用方的栈缓冲区。
+ *          配合手写的整数扫描，周期采样不需要任何堆分配。
+ */
+
+#ifndef PROC_FILE_H
+#define PROC_FILE_H
+
+#include <cstddef>
+
+class ProcFile {
+public:
+    explicit ProcFile(const char* path);
+    ~ProcFile();
+
+    ProcFile(const ProcFile&) = delete;
+    ProcFile& operator=(const ProcFile&) = delete;
+
+    bool isOpen() const { return fd >= 0; }
+
+    /**
+     * @brief 从头读取文件内容到 buf，末尾补 '\0'
+     * @details 内容超过 cap - 1 字节时截断
+     * @return 读到的字节数；文件没打开或读取失败返回 -1
+     */
+    long readAll(char* buf, size_t cap) const;
+
+    /**
+     * @brief 跳过空白后解析一个十进制无符号整数
+     * @return 数字之后的位置；p 处 (跳过空白后) 不是数字时返回 nullptr，value 不变
+     */
+    static const char* scanU64(const char* p, const char* end, unsigned long long& value);
+
+private:
+    int fd;
+};
+
+#endif // PROC_FILE_H
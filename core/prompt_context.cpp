@@ -0,0 +1,103 @@
+/**
+ * @file prompt_context.cpp
+ * @brief 提示词前缀 context 缓存实现
+ */
+
+#include "core/prompt_context.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+namespace {
+
+const char* const kFileMagic = "AIOS_PROMPT_CONTEXT 1";
+
+// 只接受 "[数字,数字,...]"，文件被改坏时宁可重新预热也不把垃圾发给模型
+bool isTokenArray(const std::string& s) {
+    if (s.size() < 2 || s.front() != '[' || s.back() != ']') return false;
+    for (size_t i = 1; i + 1 < s.size(); ++i) {
+        char c = s[i];
+        if (!(c >= '0' && c <= '9') && c != ',' && c != ' ') return false;
+    }
+    return true;
+}
+
+} // namespace
+
+PromptContextCache::PromptContextCache(const std::string& filePath) : path(filePath) {
+    load();
+}
+
+uint64_t PromptContextCache::fingerprint(std::initializer_list<std::string> parts) {
+    uint64_t h = 14695981039346656037ull;
+    for (const auto& p : parts) {
+        for (unsigned char c : p) {
+            h ^= c;
+            h *= 1099511628211ull;
+        }
+        h ^= 0xff;   // 段分隔
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+bool PromptContextCache::lookup(const std::string& module, uint64_t fp, std::string& context) const {
+    std::lock_guard<std::mutex> g(lock);
+    auto it = entries.find(module);
+    if (it == entries.end() || it->second.fingerprint != fp) return false;
+    context = it->second.context;
+    return true;
+}
+
+void PromptContextCache::store(const std::string& module, uint64_t fp, const std::string& context) {
+    if (!isTokenArray(context)) return;
+    std::lock_guard<std::mutex> g(lock);
+    entries[module] = Entry{fp, context};
+    saveLocked();
+}
+
+void PromptContextCache::invalidate(const std::string& module) {
+    std::lock_guard<std::mutex> g(lock);
+    if (entries.erase(module)) saveLocked();
+}
+
+void PromptContextCache::load() {
+    if (path.empty()) return;
+    std::ifstream in(path);
+    if (!in.is_open()) return;
+
+    std::string line;
+    if (!std::getline(in, line) || line != kFileMagic) return;
+
+    std::lock_guard<std::mutex> g(lock);
+    while (std::getline(in, line)) {
+        size_t t1 = line.find('\t');
+        size_t t2 = (t1 == std::string::npos) ? std::string::npos : line.find('\t', t1 + 1);
+        if (t2 == std::string::npos) continue;
+        std::string context = line.substr(t2 + 1);
+        if (!isTokenArray(context)) continue;
+        uint64_t fp = strtoull(line.substr(t1 + 1, t2 - t1 - 1).c_str(), nullptr, 16);
+        entries[line.substr(0, t1)] = Entry{fp, context};
+    }
+}
+
+bool PromptContextCache::saveLocked() {
+    if (path.empty()) return true;
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::trunc);
+        if (!out.is_open()) return false;
+        out << kFileMagic << '\n';
+        char fp[24];
+        for (const auto& kv : entries) {
+            snprintf(fp, sizeof(fp), "%016llx", static_cast<unsigned long long>(kv.second.fingerprint));
+            out << kv.first << '\t' << fp << '\t' << kv.second.context << '\n';
+        }
+        if (!out.good()) return false;
+    }
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
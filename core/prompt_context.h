@@ -0,0 +1,60 @@
+/**
+ * @file prompt_context.h
+ * @brief 各模块提示词前缀的 Ollama context 缓存 (落盘)
+ * @details 每个模块的固定说明只让模型处理一次：预热请求返回的 context (token 数组)
+ *          按模块保存，之后的请求带上它，只发送用户指令部分。
+ *          每条记录带一个指纹 (模型名 + 模型修改时间 + 模型模板 + 说明文本)，
+ *          指纹对不上就视为失效，需要重新预热。
+ *          context 以 JSON 数组原文保存，拼请求时直接嵌入，不反复序列化。
+ */
+
+#ifndef PROMPT_CONTEXT_H
+#define PROMPT_CONTEXT_H
+
+#include <string>
+#include <map>
+#include <mutex>
+#include <cstdint>
+#include <initializer_list>
+
+class PromptContextCache {
+public:
+    /**
+     * @param filePath 持久化文件，空字符串表示只在内存中
+     */
+    explicit PromptContextCache(const std::string& filePath);
+
+    /**
+     * @brief 查询模块的 context
+     * @return 有记录且指纹一致时写入 context 并返回 true
+     */
+    bool lookup(const std::string& module, uint64_t fingerprint, std::string& context) const;
+
+    /**
+     * @brief 保存模块的 context 并立即落盘
+     * @param context JSON 数组原文，例如 "[1,2,3]"
+     */
+    void store(const std::string& module, uint64_t fingerprint, const std::string& context);
+
+    void invalidate(const std::string& module);
+
+    /**
+     * @brief 多段文本的 64 位 FNV-1a 指纹 (段与段之间有分隔，不会因拼接方式不同而碰撞)
+     */
+    static uint64_t fingerprint(std::initializer_list<std::string> parts);
+
+private:
+    struct Entry {
+        uint64_t fingerprint;
+        std::string context;
+    };
+
+    std::string path;
+    mutable std::mutex lock;
+    std::map<std::string, Entry> entries;
+
+    void load();
+    bool saveLocked();
+};
+
+#endif // PROMPT_CONTEXT_H
@@ -0,0 +1,177 @@
+/**
+ * @file sampling_scheduler.cpp
+ * @brief 后台采样调度器实现
+ */
+
+#include "core/sampling_scheduler.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace {
+
+const double kJitter = 0.10;        // 间隔随机抖动比例
+const int kMaxBackoff = 8;          // 退避后的间隔最多是配置值的几倍
+const uint32_t kWakeId = UINT32_MAX;
+
+} // namespace
+
+SamplingScheduler::SamplingScheduler()
+    : rng(std::random_device{}()), epollFd(-1), wakeFd(-1), stopping(false), running(false) {
+}
+
+SamplingScheduler::~SamplingScheduler() {
+    stop();
+    for (auto& s : sources) close(s->timerFd);
+}
+
+int SamplingScheduler::addSource(const std::string& name, int intervalMs, int budgetMs, Task task) {
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "[Error] timerfd_create: " << strerror(errno) << std::endl;
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> g(lock);
+    intervalMs = std::max(intervalMs, 1);
+    sources.push_back(std::unique_ptr<Source>(
+        new Source{name, intervalMs, intervalMs, std::max(budgetMs, 1), std::move(task), fd, 0, 0, 0}));
+    int id = static_cast<int>(sources.size() - 1);
+    if (running) {
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u32 = static_cast<uint32_t>(id);
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+        armLocked(*sources.back());
+    }
+    return id;
+}
+
+bool SamplingScheduler::setInterval(int id, int intervalMs) {
+    std::lock_guard<std::mutex> g(lock);
+    if (id < 0 || static_cast<size_t>(id) >= sources.size()) return false;
+    Source& s = *sources[id];
+    s.baseMs = s.currentMs = std::max(intervalMs, 1);
+    if (running) armLocked(s);
+    return true;
+}
+
+void SamplingScheduler::armLocked(Source& s) {
+    std::uniform_real_distribution<double> jitter(1.0 - kJitter, 1.0 + kJitter);
+    int64_t delayMs = std::max<int64_t>(1, static_cast<int64_t>(s.currentMs * jitter(rng)));
+    itimerspec spec{};
+    spec.it_value.tv_sec = delayMs / 1000;
+    spec.it_value.tv_nsec = (delayMs % 1000) * 1000000;   // it_interval 为 0：一次性
+    timerfd_settime(s.timerFd, 0, &spec, nullptr);
+}
+
+bool SamplingScheduler::start() {
+    if (running) return true;
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0) {
+        std::cerr << "[Error] SamplingScheduler: " << strerror(errno) << std::endl;
+        if (epollFd >= 0) close(epollFd);
+        if (wakeFd >= 0) close(wakeFd);
+        epollFd = wakeFd = -1;
+        return false;
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u32 = kWakeId;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+
+    {
+        std::lock_guard<std::mutex> g(lock);
+        for (size_t i = 0; i < sources.size(); ++i) {
+            ev.data.u32 = static_cast<uint32_t>(i);
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, sources[i]->timerFd, &ev);
+            armLocked(*sources[i]);
+        }
+        stopping = false;
+        running = true;
+    }
+    thread = std::thread(&SamplingScheduler::loop, this);
+    return true;
+}
+
+void SamplingScheduler::stop() {
+    if (!running) return;
+    stopping = true;
+    uint64_t one = 1;
+    if (write(wakeFd, &one, sizeof(one)) < 0) {
+        // 计数器溢出才会失败，线程本来就处于可唤醒状态
+    }
+    if (thread.joinable()) thread.join();
+
+    std::lock_guard<std::mutex> g(lock);
+    itimerspec disarm{};
+    for (auto& s : sources) timerfd_settime(s->timerFd, 0, &disarm, nullptr);
+    close(epollFd);
+    close(wakeFd);
+    epollFd = wakeFd = -1;
+    running = false;
+}
+
+void SamplingScheduler::runSource(Source& s) {
+    auto started = std::chrono::steady_clock::now();
+    s.task();
+    uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - started).count();
+
+    std::lock_guard<std::mutex> g(lock);
+    s.runs++;
+    s.lastDurationUs = us;
+    uint64_t budgetUs = static_cast<uint64_t>(s.budgetMs) * 1000;
+    if (us > budgetUs) {
+        // 超出预算：拉长间隔，给系统 (和这个源自己) 喘息的时间
+        s.overruns++;
+        s.currentMs = std::min(s.currentMs * 2, s.baseMs * kMaxBackoff);
+    } else if (s.currentMs > s.baseMs && us <= budgetUs / 2) {
+        s.currentMs = std::max(s.currentMs / 2, s.baseMs);
+    }
+    if (!stopping) armLocked(s);
+}
+
+void SamplingScheduler::loop() {
+    epoll_event events[16];
+    while (!stopping) {
+        int n = epoll_wait(epollFd, events, 16, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "[Error] epoll_wait: " << strerror(errno) << std::endl;
+            return;
+        }
+        for (int i = 0; i < n && !stopping; ++i) {
+            uint32_t id = events[i].data.u32;
+            if (id == kWakeId) continue;   // 只用于 stop()
+
+            Source* s;
+            {
+                std::lock_guard<std::mutex> g(lock);
+                if (id >= sources.size()) continue;
+                s = sources[id].get();
+            }
+            uint64_t expirations;
+            if (read(s->timerFd, &expirations, sizeof(expirations)) != sizeof(expirations)) continue;
+            runSource(*s);
+        }
+    }
+}
+
+std::vector<SamplingScheduler::SourceStatus> SamplingScheduler::status() const {
+    std::lock_guard<std::mutex> g(lock);
+    std::vector<SourceStatus> out;
+    for (const auto& s : sources) {
+        out.push_back(SourceStatus{s->name, s->baseMs, s->currentMs, s->runs, s->overruns, s->lastDurationUs});
+    }
+    return out;
+}
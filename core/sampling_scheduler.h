@@ -0,0 +1,99 @@
+/**
+ * @file sampling_scheduler.h
+ * @brief 后台采样调度器 (epoll + 每个采样源一个 timerfd)
+ * @details 每个采样源有自己的周期和耗时预算，互不拖累：便宜的检查可以跑得勤，
+ *          昂贵的全量扫描跑得慢。定时器是一次性的，每次跑完才按下一次的间隔重新上弦，
+ *          所以一次超时不会积压出一串补跑。
+ *          - 抖动：每次间隔随机 ±10%，避免几个源长期在同一时刻扎堆
+ *          - 退避：单次耗时超过预算时间隔翻倍 (最多到 8 倍)，恢复到预算一半以内后逐步减回
+ *          - 停止：通过 eventfd 立即唤醒线程，stop() 不用等完一个周期
+ *          采样任务都在调度线程上依次执行。
+ */
+
+#ifndef SAMPLING_SCHEDULER_H
+#define SAMPLING_SCHEDULER_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+class SamplingScheduler {
+public:
+    using Task = std::function<void()>;
+
+    struct SourceStatus {
+        std::string name;
+        int intervalMs;          // 配置的间隔
+        int currentMs;           // 退避后实际使用的间隔
+        uint64_t runs;
+        uint64_t overruns;       // 超出预算的次数
+        uint64_t lastDurationUs;
+    };
+
+    SamplingScheduler();
+    ~SamplingScheduler();
+
+    SamplingScheduler(const SamplingScheduler&) = delete;
+    SamplingScheduler& operator=(const SamplingScheduler&) = delete;
+
+    /**
+     * @brief 注册采样源 (启动前后都可以)
+     * @param budgetMs 单次执行的耗时预算，超出即退避
+     * @return 采样源编号，失败 (timerfd 创建失败) 返回 -1
+     */
+    int addSource(const std::string& name, int intervalMs, int budgetMs, Task task);
+
+    /**
+     * @brief 修改采样源的间隔，立即按新间隔重新计时
+     */
+    bool setInterval(int id, int intervalMs);
+
+    /**
+     * @brief 启动调度线程
+     * @return epoll/eventfd 创建失败时返回 false
+     */
+    bool start();
+
+    /**
+     * @brief 唤醒并等待调度线程退出；正在执行的采样任务会先做完
+     */
+    void stop();
+
+    bool isRunning() const { return running; }
+    std::vector<SourceStatus> status() const;
+
+private:
+    struct Source {
+        std::string name;
+        int baseMs;
+        int currentMs;
+        int budgetMs;
+        Task task;
+        int timerFd;
+        uint64_t runs;
+        uint64_t overruns;
+        uint64_t lastDurationUs;
+    };
+
+    mutable std::mutex lock;
+    std::deque<std::unique_ptr<Source>> sources;   // 只追加，元素地址不变
+    std::mt19937 rng;
+    int epollFd;
+    int wakeFd;
+    std::atomic<bool> stopping;
+    std::atomic<bool> running;
+    std::thread thread;
+
+    void armLocked(Source& s);
+    void runSource(Source& s);
+    void loop();
+};
+
+#endif // SAMPLING_SCHEDULER_H
@@ -0,0 +1,99 @@
+/**
+ * @file snapshot_bus.h
+ * @brief 采样快照总线 (RCU 风格的双缓冲)
+ * @details 采样线程把一份完整的读数写进后台缓冲，写完再原子地切换前台下标；
+ *          读者拿到的是切换那一刻的前台缓冲，整份数据来自同一次采样，不会读到一半新一半旧。
+ *          - 读者：不加锁、不触发新的采样，只是在所读缓冲的读者计数上加减一次；
+ *            计完数发现前台已经切走就换一个缓冲重试 (只在恰好撞上切换时发生)
+ *          - 写者：之间用互斥锁串行；写后台缓冲前等还停留在上面的旧读者离开，
+ *            所以读句柄要尽快释放 (把需要的字段拷出来即可)，不要跨越耗时操作持有
+ *          模板参数 T 须可默认构造；发布时原地修改后台缓冲，缓冲里原有的容量可以复用。
+ */
+
+#ifndef SNAPSHOT_BUS_H
+#define SNAPSHOT_BUS_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+template <typename T>
+class SnapshotBus {
+private:
+    struct alignas(64) Slot {
+        std::atomic<int> readers{0};
+        uint64_t version = 0;
+        T value{};
+    };
+
+public:
+    /**
+     * @brief 读句柄：存活期间所指的快照不会被改写
+     */
+    class Reader {
+    public:
+        Reader(Reader&& other) noexcept : slot(other.slot) { other.slot = nullptr; }
+        ~Reader() {
+            if (slot) slot->readers.fetch_sub(1, std::memory_order_release);
+        }
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        const T& operator*() const { return slot->value; }
+        const T* operator->() const { return &slot->value; }
+        // 第几次发布的快照 (从 1 开始；0 表示还没有发布过)
+        uint64_t version() const { return slot->version; }
+
+    private:
+        friend class SnapshotBus;
+        explicit Reader(Slot* s) : slot(s) {}
+        Slot* slot;
+    };
+
+    SnapshotBus() : front(0) {}
+
+    SnapshotBus(const SnapshotBus&) = delete;
+    SnapshotBus& operator=(const SnapshotBus&) = delete;
+
+    /**
+     * @brief 取最新快照 (无锁)
+     */
+    Reader read() const {
+        for (;;) {
+            unsigned idx = front.load(std::memory_order_seq_cst);
+            Slot& s = slots[idx];
+            s.readers.fetch_add(1, std::memory_order_seq_cst);
+            // 计数之后前台仍是它：写者要么还没开始等它，要么会等到这个读者离开
+            if (front.load(std::memory_order_seq_cst) == idx) return Reader(&s);
+            s.readers.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    /**
+     * @brief 发布新快照
+     * @param fill 形如 void(T& next)，把新读数写进 next (内容是两次发布之前的旧快照)
+     */
+    template <typename Fill>
+    void publish(Fill&& fill) {
+        std::lock_guard<std::mutex> g(writeLock);
+        unsigned idx = front.load(std::memory_order_relaxed) ^ 1u;
+        Slot& s = slots[idx];
+        while (s.readers.load(std::memory_order_seq_cst) != 0) std::this_thread::yield();
+        fill(s.value);
+        s.version = published.load(std::memory_order_relaxed) + 1;
+        front.store(idx, std::memory_order_seq_cst);
+        published.store(s.version, std::memory_order_release);
+    }
+
+    // 最近一次发布的序号，只看有没有新快照时不必拿读句柄
+    uint64_t version() const { return published.load(std::memory_order_acquire); }
+
+private:
+    mutable Slot slots[2];
+    std::atomic<unsigned> front;
+    std::mutex writeLock;
+    std::atomic<uint64_t> published{0};   // 只在 writeLock 内修改
+};
+
+#endif // SNAPSHOT_BUS_H
@@ -0,0 +1,49 @@
+/**
+ * @file task_pool.cpp
+ * @brief 工作线程池实现
+ */
+
+#include "core/task_pool.h"
+
+TaskPool::TaskPool(size_t threadCount) : stopping(false) {
+    if (threadCount == 0) threadCount = 1;
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads.emplace_back(&TaskPool::workerLoop, this);
+    }
+}
+
+TaskPool::~TaskPool() {
+    {
+        std::lock_guard<std::mutex> g(lock);
+        stopping = true;
+    }
+    cv.notify_all();
+    for (auto& t : threads) {
+        if (t.joinable()) t.join();
+    }
+}
+
+std::future<void> TaskPool::submit(std::function<void()> task) {
+    std::packaged_task<void()> packaged(std::move(task));
+    std::future<void> result = packaged.get_future();
+    {
+        std::lock_guard<std::mutex> g(lock);
+        queue.push_back(std::move(packaged));
+    }
+    cv.notify_one();
+    return result;
+}
+
+void TaskPool::workerLoop() {
+    for (;;) {
+        std::packaged_task<void()> task;
+        {
+            std::unique_lock<std::mutex> g(lock);
+            cv.wait(g, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) return;   // stopping 且队列已空
+            task = std::move(queue.front());
+            queue.pop_front();
+        }
+        task();
+    }
+}
@@ -0,0 +1,42 @@
+/**
+ * @file task_pool.h
+ * @brief 固定大小的工作线程池
+ * @details 任务按提交顺序排队，由空闲线程取走执行；submit 返回 future，
+ *          任务抛出的异常会保存在 future 里，不会打断工作线程。
+ *          析构时先把队列里剩下的任务做完再退出。
+ */
+
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+
+class TaskPool {
+public:
+    explicit TaskPool(size_t threadCount);
+    ~TaskPool();
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    std::future<void> submit(std::function<void()> task);
+
+    size_t threadCount() const { return threads.size(); }
+
+private:
+    std::vector<std::thread> threads;
+    std::mutex lock;
+    std::condition_variable cv;
+    std::deque<std::packaged_task<void()>> queue;
+    bool stopping;
+
+    void workerLoop();
+};
+
+#endif // TASK_POOL_H
@@ -0,0 +1,172 @@
+/**
+ * @file text_match.cpp
+ * @brief 忽略大小写子串匹配实现
+ */
+
+#include "core/text_match.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TEXT_MATCH_X86 1
+#endif
+
+namespace {
+
+inline bool isAsciiAlpha(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+// 校验 hay[0..n) 与关键词在折叠后是否相等
+inline bool verifyAt(const char* hay, const char* needle, const char* mask, size_t n) {
+    for (size_t k = 0; k < n; ++k) {
+        if ((static_cast<unsigned char>(hay[k]) | static_cast<unsigned char>(mask[k])) !=
+            static_cast<unsigned char>(needle[k])) return false;
+    }
+    return true;
+}
+
+using Kernel = size_t (*)(const char*, size_t, const char*, const char*, size_t);
+
+size_t findScalar(const char* hay, size_t len, const char* needle, const char* mask, size_t n) {
+    if (n > len) return TextMatcher::npos;
+    unsigned char first = static_cast<unsigned char>(needle[0]);
+    unsigned char fm = static_cast<unsigned char>(mask[0]);
+    for (size_t i = 0; i + n <= len; ++i) {
+        if ((static_cast<unsigned char>(hay[i]) | fm) != first) continue;
+        if (verifyAt(hay + i + 1, needle + 1, mask + 1, n - 1)) return i;
+    }
+    return TextMatcher::npos;
+}
+
+#ifdef TEXT_MATCH_X86
+
+size_t findSse2(const char* hay, size_t len, const char* needle, const char* mask, size_t n) {
+    if (n > len) return TextMatcher::npos;
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[n - 1]);
+    const __m128i firstMask = _mm_set1_epi8(mask[0]);
+    const __m128i lastMask = _mm_set1_epi8(mask[n - 1]);
+
+    size_t i = 0;
+    for (; i + n - 1 + 16 <= len; i += 16) {
+        __m128i a = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i)), firstMask);
+        __m128i b = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i + n - 1)), lastMask);
+        unsigned bits = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last))));
+        while (bits) {
+            unsigned j = static_cast<unsigned>(__builtin_ctz(bits));
+            if (n <= 2 || verifyAt(hay + i + j + 1, needle + 1, mask + 1, n - 2)) return i + j;
+            bits &= bits - 1;
+        }
+    }
+    size_t tail = findScalar(hay + i, len - i, needle, mask, n);
+    return tail == TextMatcher::npos ? tail : i + tail;
+}
+
+__attribute__((target("avx2")))
+size_t findAvx2(const char* hay, size_t len, const char* needle, const char* mask, size_t n) {
+    if (n > len) return TextMatcher::npos;
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[n - 1]);
+    const __m256i firstMask = _mm256_set1_epi8(mask[0]);
+    const __m256i lastMask = _mm256_set1_epi8(mask[n - 1]);
+
+    size_t i = 0;
+    for (; i + n - 1 + 32 <= len; i += 32) {
+        __m256i a = _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(hay + i)), firstMask);
+        __m256i b = _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(hay + i + n - 1)), lastMask);
+        unsigned bits = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last))));
+        while (bits) {
+            unsigned j = static_cast<unsigned>(__builtin_ctz(bits));
+            if (n <= 2 || verifyAt(hay + i + j + 1, needle + 1, mask + 1, n - 2)) return i + j;
+            bits &= bits - 1;
+        }
+    }
+    // 尾部交给非 VEX 编码的 SSE2 内核，先清掉 ymm 高半部分，否则每次切换都有上百周期的惩罚
+    _mm256_zeroupper();
+    size_t tail = findSse2(hay + i, len - i, needle, mask, n);
+    return tail == TextMatcher::npos ? tail : i + tail;
+}
+
+#endif
+
+struct KernelChoice {
+    Kernel fn;
+    const char* name;
+};
+
+// 启动时按 CPU 能力选一次
+KernelChoice pickKernel() {
+#ifdef TEXT_MATCH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return {findAvx2, "avx2"};
+    return {findSse2, "sse2"};
+#else
+    return {findScalar, "scalar"};
+#endif
+}
+
+const KernelChoice& kernel() {
+    static const KernelChoice choice = pickKernel();
+    return choice;
+}
+
+} // namespace
+
+// UTF-8 中为 EF BC 81 .. EF BD 9E
+std::string TextMatcher::foldFullwidth(const char* s, size_t len) {
+    std::string out;
+    out.reserve(len);
+    for (size_t i = 0; i < len; ++i) {
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        if (c == 0xEF && i + 2 < len) {
+            unsigned char b1 = static_cast<unsigned char>(s[i + 1]);
+            unsigned char b2 = static_cast<unsigned char>(s[i + 2]);
+            unsigned cp = ((c & 0x0F) << 12) | ((b1 & 0x3F) << 6) | (b2 & 0x3F);
+            if ((b1 & 0xC0) == 0x80 && (b2 & 0xC0) == 0x80 && cp >= 0xFF01 && cp <= 0xFF5E) {
+                out += static_cast<char>(cp - 0xFF01 + 0x21);
+                i += 2;
+                continue;
+            }
+        }
+        out += static_cast<char>(c);
+    }
+    return out;
+}
+
+TextMatcher::TextMatcher(const std::string& needle, Mode m) : mode(m) {
+    std::string src = (mode == UTF8) ? foldFullwidth(needle.data(), needle.size()) : needle;
+    folded.resize(src.size());
+    foldMask.resize(src.size());
+    for (size_t i = 0; i < src.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(src[i]);
+        if (isAsciiAlpha(c)) {
+            folded[i] = static_cast<char>(c | 0x20);
+            foldMask[i] = 0x20;
+        } else {
+            folded[i] = static_cast<char>(c);
+            foldMask[i] = 0;
+        }
+    }
+}
+
+const char* TextMatcher::kernelName() {
+    return kernel().name;
+}
+
+size_t TextMatcher::findFolded(const char* hay, size_t len) const {
+    if (folded.empty()) return 0;
+    return kernel().fn(hay, len, folded.data(), foldMask.data(), folded.size());
+}
+
+size_t TextMatcher::find(const char* hay, size_t len) const {
+    // 只有含 0xEF 字节的文本才可能有全角字符，其余直接匹配原始字节
+    if (mode == UTF8 && memchr(hay, 0xEF, len) != nullptr) {
+        std::string norm = foldFullwidth(hay, len);
+        return findFolded(norm.data(), norm.size());
+    }
+    return findFolded(hay, len);
+}
@@ -0,0 +1,58 @@
+/**
+ * @file text_match.h
+ * @brief 忽略大小写的子串匹配器 (SSE2/AVX2 + 标量回退)
+ * @details 构造时把关键词预处理好 (转小写 + 每个字节的折叠掩码)，之后对原始字节直接匹配，
+ *          不再为每次比较复制并 transform 两个字符串。
+ *          向量化思路：把关键词首字节、尾字节广播到整个寄存器，一次比较 16/32 个起点，
+ *          只有首尾都对上的位置才逐字节校验。
+ *          ASCII 字母按位或 0x20 折叠；>= 0x80 的字节原样比较，所以 UTF-8 中文关键词天然安全。
+ *          UTF8 模式额外把全角 ASCII (如 "ＣＰＵ") 折叠成半角后再匹配。
+ */
+
+#ifndef TEXT_MATCH_H
+#define TEXT_MATCH_H
+
+#include <string>
+#include <cstddef>
+
+class TextMatcher {
+public:
+    enum Mode {
+        ASCII,  // 只折叠 ASCII 大小写
+        UTF8    // 另外把全角 ASCII 折叠成半角
+    };
+
+    static const size_t npos = static_cast<size_t>(-1);
+
+    explicit TextMatcher(const std::string& needle, Mode mode = ASCII);
+
+    /**
+     * @brief 在 hay 中查找关键词
+     * @return 首次出现的字节偏移；没找到返回 npos
+     *         (UTF8 模式下是折叠后文本中的偏移，只适合判断是否出现)
+     */
+    size_t find(const char* hay, size_t len) const;
+    size_t find(const std::string& hay) const { return find(hay.data(), hay.size()); }
+
+    bool matches(const char* hay, size_t len) const { return find(hay, len) != npos; }
+    bool matches(const std::string& hay) const { return find(hay.data(), hay.size()) != npos; }
+
+    /**
+     * @brief 当前 CPU 上实际使用的内核 ("avx2" / "sse2" / "scalar")
+     */
+    static const char* kernelName();
+
+    /**
+     * @brief 全角 ASCII (U+FF01..U+FF5E) 转半角，其余字节原样保留
+     */
+    static std::string foldFullwidth(const char* s, size_t len);
+
+private:
+    std::string folded;    // 小写后的关键词
+    std::string foldMask;  // 每个字节：字母为 0x20，其他为 0
+    Mode mode;
+
+    size_t findFolded(const char* hay, size_t len) const;
+};
+
+#endif // TEXT_MATCH_H
@@ -0,0 +1,270 @@
+/**
+ * @file dir_scanner.cpp
+ * @brief 并行目录扫描器实现
+ */
+
+#include "file/dir_scanner.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+namespace {
+
+// 偷不到活时先让出几次 CPU，仍然没有就睡下等新目录入队
+const int kSpinRounds = 4;
+const int kIdleWaitMs = 20;   // 睡眠上限，保证取消标志能及时看到
+
+// getdents64 返回的原始目录项 (glibc 没有导出这个结构)
+struct LinuxDirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+// 每个线程的私有状态
+struct Worker {
+    std::mutex lock;
+    std::deque<std::string> dirs;     // 待扫描目录
+    std::vector<ScanEntry> results;   // 本线程命中的文件
+    std::vector<ScanDir> dirsSeen;    // 本线程扫过的目录
+    size_t reused = 0;
+};
+
+struct ScanContext {
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<long> pending{0};     // 已入队但还没扫完的目录数，为 0 时全部结束
+    std::atomic<int> idle{0};         // 正在睡眠的线程数
+    std::mutex idleLock;
+    std::condition_variable idleCv;   // 有新目录入队或全部结束时唤醒
+    uint64_t minSize = 0;
+    const DirCache* cache = nullptr;
+    int64_t racyAfterNs = 0;
+    const std::atomic<bool>* cancel = nullptr;
+};
+
+int64_t toNs(const struct statx_timestamp& ts) {
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+std::string joinPath(const std::string& dir, const char* name) {
+    std::string full = dir;
+    if (full.back() != '/') full += '/';
+    full += name;
+    return full;
+}
+
+bool isDotOrDotDot(const char* name) {
+    return name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+}
+
+void pushDir(ScanContext& ctx, Worker& self, std::string&& path) {
+    ctx.pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> g(self.lock);
+        self.dirs.push_back(std::move(path));
+    }
+    if (ctx.idle.load() > 0) {
+        std::lock_guard<std::mutex> g(ctx.idleLock);
+        ctx.idleCv.notify_one();
+    }
+}
+
+// 目录没变：沿用缓存的子目录，只刷新缓存里大文件的大小
+bool reuseCachedDir(ScanContext& ctx, Worker& self, const std::string& path, const struct statx& dirStx) {
+    if (!ctx.cache) return false;
+    auto it = ctx.cache->find(path);
+    if (it == ctx.cache->end()) return false;
+    const CachedDir& cd = it->second;
+    int64_t mtime = toNs(dirStx.stx_mtime);
+    if (cd.mtimeNs != mtime || cd.ctimeNs != toNs(dirStx.stx_ctime) || mtime >= ctx.racyAfterNs) return false;
+
+    for (const auto& sub : cd.subdirs) pushDir(ctx, self, joinPath(path, sub.c_str()));
+    for (const auto& f : cd.files) {
+        struct statx stx;
+        if (statx(AT_FDCWD, f.path.c_str(), AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC,
+                  STATX_SIZE | STATX_MTIME, &stx) != 0) continue;
+        if (stx.stx_size >= ctx.minSize) {
+            self.results.push_back(ScanEntry{f.path, stx.stx_size, toNs(stx.stx_mtime)});
+        }
+    }
+    self.reused++;
+    return true;
+}
+
+// 先从自己队尾取，没有再去偷别人的队头
+bool takeDir(ScanContext& ctx, size_t selfIdx, std::string& out) {
+    Worker& self = *ctx.workers[selfIdx];
+    {
+        std::lock_guard<std::mutex> g(self.lock);
+        if (!self.dirs.empty()) {
+            out = std::move(self.dirs.back());
+            self.dirs.pop_back();
+            return true;
+        }
+    }
+    size_t n = ctx.workers.size();
+    for (size_t k = 1; k < n; ++k) {
+        Worker& victim = *ctx.workers[(selfIdx + k) % n];
+        std::lock_guard<std::mutex> g(victim.lock);
+        if (!victim.dirs.empty()) {
+            out = std::move(victim.dirs.front());
+            victim.dirs.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void scanOneDir(ScanContext& ctx, Worker& self, const std::string& path, char* buf, size_t bufSize) {
+    // 先按路径取目录时间戳：目录没变时连 open 都省掉
+    struct statx dirStx;
+    if (statx(AT_FDCWD, path.c_str(), AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC,
+              STATX_TYPE | STATX_MTIME | STATX_CTIME, &dirStx) != 0) return;
+    if (!S_ISDIR(dirStx.stx_mode)) return;
+    self.dirsSeen.push_back(ScanDir{path, toNs(dirStx.stx_mtime), toNs(dirStx.stx_ctime)});
+    if (reuseCachedDir(ctx, self, path, dirStx)) return;
+
+    int dirFd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (dirFd < 0) {
+        self.dirsSeen.pop_back();  // 权限不足或已被删除，不进缓存
+        return;
+    }
+
+    for (;;) {
+        long n = syscall(SYS_getdents64, dirFd, buf, bufSize);
+        if (n <= 0) break;
+
+        for (long off = 0; off < n;) {
+            LinuxDirent64* d = reinterpret_cast<LinuxDirent64*>(buf + off);
+            off += d->d_reclen;
+            if (isDotOrDotDot(d->d_name)) continue;
+
+            unsigned char type = d->d_type;
+            struct statx stx;
+            bool haveStat = false;
+
+            // 部分文件系统不填 d_type，只能 statx 一次拿类型
+            if (type == DT_UNKNOWN) {
+                if (statx(dirFd, d->d_name, AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC,
+                          STATX_TYPE | STATX_SIZE | STATX_MTIME, &stx) != 0) continue;
+                haveStat = true;
+                if (S_ISDIR(stx.stx_mode)) type = DT_DIR;
+                else if (S_ISREG(stx.stx_mode)) type = DT_REG;
+                else continue;
+            }
+
+            if (type == DT_DIR) {
+                pushDir(ctx, self, joinPath(path, d->d_name));
+            } else if (type == DT_REG) {
+                if (!haveStat &&
+                    statx(dirFd, d->d_name, AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC,
+                          STATX_SIZE | STATX_MTIME, &stx) != 0) continue;
+                if (stx.stx_size >= ctx.minSize) {
+                    self.results.push_back(ScanEntry{joinPath(path, d->d_name), stx.stx_size, toNs(stx.stx_mtime)});
+                }
+            }
+        }
+    }
+    close(dirFd);
+}
+
+void workerLoop(ScanContext& ctx, size_t selfIdx) {
+    Worker& self = *ctx.workers[selfIdx];
+    std::vector<char> buf(64 * 1024);
+    std::string path;
+
+    int misses = 0;
+    while (true) {
+        if (ctx.cancel && ctx.cancel->load(std::memory_order_relaxed)) break;
+        bool got = takeDir(ctx, selfIdx, path);
+        if (!got) {
+            if (ctx.pending.load(std::memory_order_acquire) == 0) break;  // 没有排队的，也没有正在扫的
+            if (++misses < kSpinRounds) {
+                std::this_thread::yield();
+                continue;
+            }
+            // 先登记再检查一遍：入队方看到 idle > 0 才会通知，两边都在锁内，不会漏掉唤醒
+            std::unique_lock<std::mutex> g(ctx.idleLock);
+            ctx.idle++;
+            got = takeDir(ctx, selfIdx, path);
+            if (!got && ctx.pending.load(std::memory_order_acquire) != 0) {
+                ctx.idleCv.wait_for(g, std::chrono::milliseconds(kIdleWaitMs));
+            }
+            ctx.idle--;
+            if (!got) continue;
+        }
+        misses = 0;
+        scanOneDir(ctx, self, path, buf.data(), buf.size());
+        if (ctx.pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> g(ctx.idleLock);
+            ctx.idleCv.notify_all();   // 最后一个目录扫完，叫醒睡着的线程退出
+        }
+    }
+}
+
+} // namespace
+
+DirScanner::DirScanner(int threads) : threadCount(1) {
+    setThreadCount(threads);
+}
+
+DirScanner::~DirScanner() {}
+
+void DirScanner::setThreadCount(int threads) {
+    if (threads <= 0) threads = static_cast<int>(std::thread::hardware_concurrency());
+    threadCount = threads > 0 ? threads : 1;
+}
+
+ScanResult DirScanner::scan(const std::string& rootPath, uint64_t minSize,
+                            const DirCache* cache, int64_t racyAfterNs,
+                            const std::atomic<bool>* cancel) {
+    return scan(std::vector<std::string>{rootPath}, minSize, cache, racyAfterNs, cancel);
+}
+
+ScanResult DirScanner::scan(const std::vector<std::string>& roots, uint64_t minSize,
+                            const DirCache* cache, int64_t racyAfterNs,
+                            const std::atomic<bool>* cancel) {
+    ScanContext ctx;
+    ctx.cancel = cancel;
+    ctx.minSize = minSize;
+    ctx.cache = cache;
+    ctx.racyAfterNs = racyAfterNs;
+    for (int i = 0; i < threadCount; ++i) ctx.workers.push_back(std::make_unique<Worker>());
+
+    // 起点轮流分给各线程，不必等偷取
+    for (size_t i = 0; i < roots.size(); ++i) pushDir(ctx, *ctx.workers[i % ctx.workers.size()], std::string(roots[i]));
+
+    // 当前线程也当一个 worker 用
+    std::vector<std::thread> threads;
+    for (int i = 1; i < threadCount; ++i) threads.emplace_back(workerLoop, std::ref(ctx), static_cast<size_t>(i));
+    workerLoop(ctx, 0);
+    for (auto& t : threads) t.join();
+
+    ScanResult result;
+    result.reusedDirs = 0;
+    size_t totalFiles = 0, totalDirs = 0;
+    for (auto& w : ctx.workers) {
+        totalFiles += w->results.size();
+        totalDirs += w->dirsSeen.size();
+    }
+    result.files.reserve(totalFiles);
+    result.dirs.reserve(totalDirs);
+    for (auto& w : ctx.workers) {
+        for (auto& e : w->results) result.files.push_back(std::move(e));
+        for (auto& d : w->dirsSeen) result.dirs.push_back(std::move(d));
+        result.reusedDirs += w->reused;
+    }
+    return result;
+}
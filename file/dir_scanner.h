@@ -0,0 +1,87 @@
+/**
+ * @file dir_scanner.h
+ * @brief 并行目录扫描器 (work-stealing 线程池)
+ * @details 用 openat + getdents64 直接读目录项，d_type 能判断类型时不再 stat，
+ *          普通文件只用 statx(STATX_SIZE | STATX_MTIME, AT_STATX_DONT_SYNC) 取大小和修改时间。
+ *          每个线程有自己的目录队列：自己从尾部取 (深度优先，目录 fd 局部性好)，
+ *          空闲时从别的线程队列头部偷 (偷到的是靠近根的大子树)，偷不到就睡下等新目录入队。
+ *          结果先写进每个线程自己的数组，最后一次性合并。
+ *          传入上一次的目录缓存时做增量扫描：mtime/ctime 都没变的目录不再读目录项，
+ *          直接沿用缓存里的子目录和大文件 (大文件仍会 statx 刷新大小)。
+ */
+
+#ifndef DIR_SCANNER_H
+#define DIR_SCANNER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include <atomic>
+
+// 一个扫描命中的文件
+struct ScanEntry {
+    std::string path;
+    uint64_t sizeBytes;
+    int64_t mtimeNs;   // 修改时间 (纳秒)
+};
+
+// 扫描过的目录及其时间戳 (纳秒)
+struct ScanDir {
+    std::string path;
+    int64_t mtimeNs;
+    int64_t ctimeNs;
+};
+
+// 上一次扫描时某个目录的内容，用于增量扫描
+struct CachedDir {
+    int64_t mtimeNs;
+    int64_t ctimeNs;
+    std::vector<std::string> subdirs;  // 子目录名 (不含路径)
+    std::vector<ScanEntry> files;      // 该目录下命中的大文件 (完整路径)
+};
+
+using DirCache = std::unordered_map<std::string, CachedDir>;
+
+struct ScanResult {
+    std::vector<ScanEntry> files;  // 命中的文件 (无序)
+    std::vector<ScanDir> dirs;     // 遍历到的全部目录
+    size_t reusedDirs;             // 增量扫描中直接沿用缓存的目录数
+};
+
+class DirScanner {
+public:
+    /**
+     * @param threads 工作线程数，<= 0 表示使用 CPU 逻辑核心数
+     */
+    explicit DirScanner(int threads = 0);
+    ~DirScanner();
+
+    void setThreadCount(int threads);
+    int getThreadCount() const { return threadCount; }
+
+    /**
+     * @brief 递归扫描 rootPath，收集不小于 minSize 字节的普通文件 (传 0 收集全部)
+     * @details 不跟随符号链接，无权限的目录直接跳过
+     * @param cache 上一次的目录缓存，为空则全量扫描
+     * @param racyAfterNs mtime 不早于该时刻的目录即使时间戳没变也重新读
+     *                    (上次扫描期间被修改的目录，时间戳精度不足以区分)
+     * @param cancel 非空且变为 true 时尽快结束，返回已扫到的部分
+     */
+    ScanResult scan(const std::string& rootPath, uint64_t minSize,
+                    const DirCache* cache = nullptr, int64_t racyAfterNs = 0,
+                    const std::atomic<bool>* cancel = nullptr);
+
+    /**
+     * @brief 一次扫描多棵子树 (互不包含)，线程只启动一轮
+     * @details 增量维护时一批变化里常有多个新目录，合并成一次扫描
+     */
+    ScanResult scan(const std::vector<std::string>& roots, uint64_t minSize,
+                    const DirCache* cache = nullptr, int64_t racyAfterNs = 0,
+                    const std::atomic<bool>* cancel = nullptr);
+
+private:
+    int threadCount;
+};
+
+#endif // DIR_SCANNER_H
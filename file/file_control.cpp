@@ -4,6 +4,7 @@
  */
 
 #include "file/file_control.h"
+#include "core/text_match.h"
 #include <iostream>
 #include <filesystem>
 #include <algorithm>
@@ -20,15 +21,20 @@ FileControl::FileControl() {
         homeDir = getpwuid(getuid())->pw_dir;
     }
     currentRootPath = std::string(homeDir);
+    nameIndex.buildAsync(currentRootPath);
 }
 
 FileControl::~FileControl() {}
 
-// 实时搜索文件
 std::vector<std::string> FileControl::searchFile(const std::string& keyword) {
+    if (nameIndex.isReady()) return nameIndex.search(keyword, 10);
+    return walkSearch(keyword);
+}
+
+// 实时搜索文件
+std::vector<std::string> FileControl::walkSearch(const std::string& keyword) {
     std::vector<std::string> results;
-    std::string keyLower = keyword;
-    std::transform(keyLower.begin(), keyLower.end(), keyLower.begin(), ::tolower);
+    TextMatcher matcher(keyword);
 
     // 跳过权限不足的目录
     auto options = fs::directory_options::skip_permission_denied;
@@ -36,12 +42,11 @@ std::vector<std::string> FileControl::searchFile(const std::string& keyword) {
     try {
         for (const auto& entry : fs::recursive_directory_iterator(currentRootPath, options)) {
             try {
-                std::string fname = entry.path().filename().string();
-                std::string fnameLower = fname;
-                std::transform(fnameLower.begin(), fnameLower.end(), fnameLower.begin(), ::tolower);
-
-                // 包含匹配
-                if (fnameLower.find(keyLower) != std::string::npos) {
+                // 包含匹配 (忽略大小写，不复制文件名)
+                const std::string& full = entry.path().native();
+                size_t nameOff = full.find_last_of('/');
+                nameOff = (nameOff == std::string::npos) ? 0 : nameOff + 1;
+                if (matcher.matches(full.data() + nameOff, full.size() - nameOff)) {
                     results.push_back(entry.path().string());
                     if (results.size() >= 10) break; // 限制返回10个，防止太多
                 }
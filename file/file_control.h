@@ -8,6 +8,7 @@
 
 #include <string>
 #include <vector>
+#include "file/name_index.h"
 
 class FileControl {
 public:
@@ -16,6 +17,8 @@ public:
 
     /**
      * @brief 精确/模糊搜索特定文件
+     * @details 文件名索引建好后直接查索引 (按匹配程度和修改时间排序)，
+     *          建好之前退回到实时遍历目录
      * @param keyword 文件名
      * @return 匹配的文件路径列表
      */
@@ -33,6 +36,10 @@ public:
 
 private:
     std::string currentRootPath;
+    NameIndex nameIndex;  // 后台构建的文件名索引
+
+    // 索引没建好时的实时遍历
+    std::vector<std::string> walkSearch(const std::string& keyword);
 };
 
 #endif // FILE_CONTROL_H
\ No newline at end of file
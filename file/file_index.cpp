@@ -0,0 +1,298 @@
+/**
+ * @file file_index.cpp
+ * @brief 大文件索引磁盘格式实现
+ */
+
+#include "file/file_index.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const char kMagic[8] = {'A', 'I', 'O', 'S', 'F', 'I', 'D', 'X'};
+static const uint32_t kVersion = 1;
+static const uint32_t kNoParent = 0xFFFFFFFFu;
+
+struct FileIndex::Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t dirCount;
+    uint32_t fileCount;
+    uint32_t rootOff;       // 根路径在字符串池中的位置
+    uint32_t rootLen;
+    uint32_t reserved;
+    uint64_t poolSize;
+    uint64_t minSize;       // 建索引时的大小阈值
+    int64_t scanStartNs;
+    uint64_t totalSize;     // 整个文件的长度，用于校验截断
+};
+
+struct FileIndex::DirRec {
+    uint32_t pathOff;
+    uint32_t pathLen;
+    uint32_t parent;        // 父目录下标，根目录为 kNoParent
+    uint32_t nameOff;       // 目录名在 path 中的偏移
+    int64_t mtimeNs;
+    int64_t ctimeNs;
+};
+
+struct FileIndex::FileRec {
+    uint64_t sizeBytes;
+    uint32_t pathOff;
+    uint32_t pathLen;
+    uint32_t nameOff;       // 文件名在 path 中的偏移
+    uint32_t dir;           // 所在目录下标
+};
+
+FileIndex::FileIndex() : base(nullptr), length(0) {}
+
+FileIndex::~FileIndex() {
+    unload();
+}
+
+void FileIndex::unload() {
+    if (base && heapCopy.empty()) munmap(const_cast<char*>(base), length);
+    heapCopy.clear();
+    heapCopy.shrink_to_fit();
+    base = nullptr;
+    length = 0;
+}
+
+const FileIndex::Header* FileIndex::header() const { return reinterpret_cast<const Header*>(base); }
+const FileIndex::DirRec* FileIndex::dirs() const {
+    return reinterpret_cast<const DirRec*>(base + sizeof(Header));
+}
+const FileIndex::FileRec* FileIndex::files() const {
+    return reinterpret_cast<const FileRec*>(base + sizeof(Header) + header()->dirCount * sizeof(DirRec));
+}
+const uint32_t* FileIndex::bySize() const {
+    return reinterpret_cast<const uint32_t*>(reinterpret_cast<const char*>(files()) +
+                                             header()->fileCount * sizeof(FileRec));
+}
+const char* FileIndex::pool() const {
+    return reinterpret_cast<const char*>(bySize() + header()->fileCount);
+}
+
+bool FileIndex::validate() const {
+    if (length < sizeof(Header)) return false;
+    const Header* h = header();
+    if (memcmp(h->magic, kMagic, sizeof(kMagic)) != 0 || h->version != kVersion) return false;
+    uint64_t expect = sizeof(Header) + uint64_t(h->dirCount) * sizeof(DirRec) +
+                      uint64_t(h->fileCount) * (sizeof(FileRec) + sizeof(uint32_t)) + h->poolSize;
+    if (expect != length || h->totalSize != length) return false;
+    if (uint64_t(h->rootOff) + h->rootLen > h->poolSize) return false;
+
+    // 只校验越界，保证后续访问安全；内容本身以写入方为准
+    for (uint32_t i = 0; i < h->dirCount; ++i) {
+        const DirRec& d = dirs()[i];
+        if (uint64_t(d.pathOff) + d.pathLen > h->poolSize || d.nameOff > d.pathLen) return false;
+        if (d.parent != kNoParent && d.parent >= h->dirCount) return false;
+    }
+    for (uint32_t i = 0; i < h->fileCount; ++i) {
+        const FileRec& f = files()[i];
+        if (uint64_t(f.pathOff) + f.pathLen > h->poolSize || f.nameOff > f.pathLen) return false;
+        if (f.dir >= h->dirCount) return false;
+        if (bySize()[i] >= h->fileCount) return false;
+    }
+    return true;
+}
+
+bool FileIndex::load(const std::string& indexPath) {
+    unload();
+    int fd = open(indexPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(Header))) {
+        close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // mmap 建立后 fd 可以关掉
+    if (p == MAP_FAILED) return false;
+
+    base = static_cast<const char*>(p);
+    length = static_cast<size_t>(st.st_size);
+    if (!validate()) {
+        unload();
+        return false;
+    }
+    return true;
+}
+
+// 取路径最后一个 '/' 之前的部分
+static std::string parentOf(const std::string& path) {
+    size_t pos = path.find_last_of('/');
+    if (pos == std::string::npos) return "";
+    if (pos == 0) return "/";
+    return path.substr(0, pos);
+}
+
+static uint32_t nameOffsetOf(const std::string& path) {
+    size_t pos = path.find_last_of('/');
+    return pos == std::string::npos ? 0 : static_cast<uint32_t>(pos + 1);
+}
+
+bool FileIndex::save(const std::string& indexPath, const std::string& rootPath, uint64_t minSize,
+                     const ScanResult& result, int64_t scanStartNs) {
+    // 1. 字符串池 + 目录下标
+    std::string strPool;
+    auto addString = [&strPool](const std::string& s) {
+        uint32_t off = static_cast<uint32_t>(strPool.size());
+        strPool += s;
+        return off;
+    };
+
+    std::unordered_map<std::string, uint32_t> dirIdx;
+    dirIdx.reserve(result.dirs.size());
+    for (size_t i = 0; i < result.dirs.size(); ++i) dirIdx[result.dirs[i].path] = static_cast<uint32_t>(i);
+
+    std::vector<DirRec> dirRecs(result.dirs.size());
+    for (size_t i = 0; i < result.dirs.size(); ++i) {
+        const ScanDir& d = result.dirs[i];
+        DirRec& r = dirRecs[i];
+        r.pathOff = addString(d.path);
+        r.pathLen = static_cast<uint32_t>(d.path.size());
+        r.nameOff = nameOffsetOf(d.path);
+        r.mtimeNs = d.mtimeNs;
+        r.ctimeNs = d.ctimeNs;
+        auto it = (d.path == rootPath) ? dirIdx.end() : dirIdx.find(parentOf(d.path));
+        r.parent = (it == dirIdx.end()) ? kNoParent : it->second;
+    }
+
+    std::vector<FileRec> fileRecs;
+    fileRecs.reserve(result.files.size());
+    for (const auto& f : result.files) {
+        auto it = dirIdx.find(parentOf(f.path));
+        if (it == dirIdx.end()) continue;  // 扫描途中目录消失
+        FileRec r;
+        r.sizeBytes = f.sizeBytes;
+        r.pathOff = addString(f.path);
+        r.pathLen = static_cast<uint32_t>(f.path.size());
+        r.nameOff = nameOffsetOf(f.path);
+        r.dir = it->second;
+        fileRecs.push_back(r);
+    }
+
+    Header h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version = kVersion;
+    h.dirCount = static_cast<uint32_t>(dirRecs.size());
+    h.fileCount = static_cast<uint32_t>(fileRecs.size());
+    h.rootOff = addString(rootPath);
+    h.rootLen = static_cast<uint32_t>(rootPath.size());
+    h.poolSize = strPool.size();
+    h.minSize = minSize;
+    h.scanStartNs = scanStartNs;
+
+    // 2. 大小降序排列
+    std::vector<uint32_t> order(fileRecs.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = static_cast<uint32_t>(i);
+    std::sort(order.begin(), order.end(), [&fileRecs](uint32_t a, uint32_t b) {
+        return fileRecs[a].sizeBytes > fileRecs[b].sizeBytes;
+    });
+
+    // 3. 拼成一块连续内存
+    std::vector<char> buf;
+    size_t total = sizeof(Header) + dirRecs.size() * sizeof(DirRec) +
+                   fileRecs.size() * (sizeof(FileRec) + sizeof(uint32_t)) + strPool.size();
+    h.totalSize = total;
+    buf.resize(total);
+    char* p = buf.data();
+    memcpy(p, &h, sizeof(h));                                         p += sizeof(h);
+    memcpy(p, dirRecs.data(), dirRecs.size() * sizeof(DirRec));       p += dirRecs.size() * sizeof(DirRec);
+    memcpy(p, fileRecs.data(), fileRecs.size() * sizeof(FileRec));    p += fileRecs.size() * sizeof(FileRec);
+    memcpy(p, order.data(), order.size() * sizeof(uint32_t));         p += order.size() * sizeof(uint32_t);
+    memcpy(p, strPool.data(), strPool.size());
+
+    // 4. 写临时文件再 rename，然后 mmap 回来
+    std::string tmpPath = indexPath + ".tmp";
+    bool written = false;
+    int fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd >= 0) {
+        size_t off = 0;
+        while (off < buf.size()) {
+            ssize_t n = write(fd, buf.data() + off, buf.size() - off);
+            if (n <= 0) break;
+            off += static_cast<size_t>(n);
+        }
+        written = (off == buf.size());
+        close(fd);
+        if (written) written = (rename(tmpPath.c_str(), indexPath.c_str()) == 0);
+        if (!written) unlink(tmpPath.c_str());
+    }
+
+    if (written && load(indexPath)) return true;
+
+    // 写不了盘：保留内存副本，本次运行照常可查
+    unload();
+    heapCopy.swap(buf);
+    base = heapCopy.data();
+    length = heapCopy.size();
+    return false;
+}
+
+std::string FileIndex::rootPath() const {
+    if (!base) return "";
+    return std::string(pool() + header()->rootOff, header()->rootLen);
+}
+
+uint64_t FileIndex::minSize() const { return base ? header()->minSize : 0; }
+int64_t FileIndex::scanStartNs() const { return base ? header()->scanStartNs : 0; }
+size_t FileIndex::fileCount() const { return base ? header()->fileCount : 0; }
+size_t FileIndex::dirCount() const { return base ? header()->dirCount : 0; }
+
+uint64_t FileIndex::sizeByRank(size_t rank) const {
+    return files()[bySize()[rank]].sizeBytes;
+}
+
+std::string FileIndex::pathByRank(size_t rank) const {
+    const FileRec& f = files()[bySize()[rank]];
+    return std::string(pool() + f.pathOff, f.pathLen);
+}
+
+std::string FileIndex::nameByRank(size_t rank) const {
+    const FileRec& f = files()[bySize()[rank]];
+    return std::string(pool() + f.pathOff + f.nameOff, f.pathLen - f.nameOff);
+}
+
+std::vector<std::string> FileIndex::dirPaths() const {
+    std::vector<std::string> paths;
+    if (!base) return paths;
+    paths.reserve(header()->dirCount);
+    for (uint32_t i = 0; i < header()->dirCount; ++i) {
+        const DirRec& d = dirs()[i];
+        paths.emplace_back(pool() + d.pathOff, d.pathLen);
+    }
+    return paths;
+}
+
+DirCache FileIndex::buildDirCache() const {
+    DirCache cache;
+    if (!base) return cache;
+    const Header* h = header();
+    cache.reserve(h->dirCount);
+
+    std::vector<CachedDir*> byIdx(h->dirCount, nullptr);
+    for (uint32_t i = 0; i < h->dirCount; ++i) {
+        const DirRec& d = dirs()[i];
+        CachedDir& cd = cache[std::string(pool() + d.pathOff, d.pathLen)];
+        cd.mtimeNs = d.mtimeNs;
+        cd.ctimeNs = d.ctimeNs;
+        byIdx[i] = &cd;
+    }
+    for (uint32_t i = 0; i < h->dirCount; ++i) {
+        const DirRec& d = dirs()[i];
+        if (d.parent == kNoParent) continue;
+        byIdx[d.parent]->subdirs.emplace_back(pool() + d.pathOff + d.nameOff, d.pathLen - d.nameOff);
+    }
+    for (uint32_t i = 0; i < h->fileCount; ++i) {
+        const FileRec& f = files()[i];
+        byIdx[f.dir]->files.push_back(ScanEntry{std::string(pool() + f.pathOff, f.pathLen), f.sizeBytes, 0});
+    }
+    return cache;
+}
@@ -0,0 +1,86 @@
+/**
+ * @file file_index.h
+ * @brief 大文件索引的磁盘格式 (mmap 直接使用)
+ * @details 文件布局 (全部小端、定长，字符串统一放在末尾的字符串池):
+ *          [Header][DirRec x dirCount][FileRec x fileCount][uint32 bySize x fileCount][字符串池]
+ *          bySize 是按文件大小降序的下标排列，查询大文件时顺着它走到阈值即可停止。
+ *          DirRec 保存每个目录的 mtime/ctime，下次扫描据此跳过没变的目录。
+ *          启动时只 mmap，不解析；写入时先写临时文件再 rename，保证不会读到半个索引。
+ */
+
+#ifndef FILE_INDEX_H
+#define FILE_INDEX_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "file/dir_scanner.h"
+
+class FileIndex {
+public:
+    FileIndex();
+    ~FileIndex();
+
+    FileIndex(const FileIndex&) = delete;
+    FileIndex& operator=(const FileIndex&) = delete;
+
+    /**
+     * @brief mmap 一个已有的索引文件
+     * @return 文件不存在、版本不符或内容损坏时返回 false
+     */
+    bool load(const std::string& indexPath);
+
+    /**
+     * @brief 把扫描结果写成索引并立即 mmap 回来
+     * @details 写盘失败 (如缓存目录不可写) 时退化为只在内存中保存同样的格式
+     * @param scanStartNs 本次扫描开始的时间，下次增量扫描据此判断"时间戳不可信"的目录
+     * @return 是否成功写入磁盘
+     */
+    bool save(const std::string& indexPath, const std::string& rootPath, uint64_t minSize,
+              const ScanResult& result, int64_t scanStartNs);
+
+    bool isLoaded() const { return base != nullptr; }
+
+    std::string rootPath() const;
+    uint64_t minSize() const;
+    int64_t scanStartNs() const;
+    size_t fileCount() const;
+    size_t dirCount() const;
+
+    /**
+     * @brief 按大小降序的第 rank 个文件
+     */
+    uint64_t sizeByRank(size_t rank) const;
+    std::string pathByRank(size_t rank) const;
+    std::string nameByRank(size_t rank) const;
+
+    /**
+     * @brief 索引中全部目录的路径
+     */
+    std::vector<std::string> dirPaths() const;
+
+    /**
+     * @brief 还原成 DirScanner 的增量扫描缓存
+     */
+    DirCache buildDirCache() const;
+
+private:
+    struct Header;
+    struct DirRec;
+    struct FileRec;
+
+    const char* base;            // 指向 mmap 区域或 heapCopy
+    size_t length;
+    std::vector<char> heapCopy;  // 写盘失败时的内存副本
+
+    void unload();
+    bool validate() const;
+
+    const Header* header() const;
+    const DirRec* dirs() const;
+    const FileRec* files() const;
+    const uint32_t* bySize() const;
+    const char* pool() const;
+};
+
+#endif // FILE_INDEX_H
@@ -9,18 +9,44 @@
 #include <cmath>
 #include <unistd.h>
 #include <pwd.h>
+#include <chrono>
+#include <sys/stat.h>
 
 namespace fs = std::filesystem;
 
-FileMonitor::FileMonitor() {
+FileMonitor::FileMonitor() : liveUpdates(false), foldPending(false), dirRemovals(0), stopping(false) {
     const char* homeDir;
     if ((homeDir = getenv("HOME")) == NULL) {
         homeDir = getpwuid(getuid())->pw_dir;
     }
     currentRootPath = std::string(homeDir);
+
+    // 索引放在用户缓存目录，启动时只 mmap，不扫盘
+    const char* cacheHome = getenv("XDG_CACHE_HOME");
+    std::string cacheDir = (cacheHome && *cacheHome) ? std::string(cacheHome) : currentRootPath + "/.cache";
+    mkdir(cacheDir.c_str(), 0755);
+    cacheDir += "/aios";
+    mkdir(cacheDir.c_str(), 0755);
+    indexPath = cacheDir + "/file_index.bin";
+
+    if (fileIndex.load(indexPath)) {
+        currentRootPath = fileIndex.rootPath();
+        std::cout << "[DataRadar] 已加载磁盘索引: " << fileIndex.fileCount() << " 个大文件 ("
+                  << currentRootPath << ")" << std::endl;
+        reloadIndexedPathsLocked();
+    }
+    rescanThread = std::thread(&FileMonitor::rescanLoop, this);
 }
 
-FileMonitor::~FileMonitor() {}
+FileMonitor::~FileMonitor() {
+    {
+        std::lock_guard<std::mutex> lock(overlayMutex);
+        stopping = true;
+    }
+    rescanCv.notify_all();
+    if (rescanThread.joinable()) rescanThread.join();
+    watcher.stop();   // 后台合并可能刚重启过监听，等它结束后再停
+}
 
 std::string FileMonitor::getCurrentRoot() {
     return currentRootPath;
@@ -39,51 +65,242 @@ std::string FileMonitor::formatSize(uintmax_t bytes) {
     return std::string(buffer);
 }
 
-int FileMonitor::scanDirectory(const std::string& rootPath) {
-    fileIndex.clear();
-    currentRootPath = rootPath;
-    int count = 0;
-    auto options = fs::directory_options::skip_permission_denied;
-
-    try {
-        // 递归遍历，只索引 > 10MB 的文件
-        for (const auto& entry : fs::recursive_directory_iterator(rootPath, options)) {
-            try {
-                if (fs::is_regular_file(entry)) {
-                    uintmax_t size = entry.file_size();
-                    if (size > 10 * 1024 * 1024) { 
-                        FileInfo info;
-                        info.path = entry.path().string();
-                        info.name = entry.path().filename().string();
-                        info.sizeBytes = size;
-                        info.sizeStr = formatSize(size);
-                        fileIndex.push_back(info);
-                        count++;
-                    }
-                }
-            } catch (...) { continue; }
+void FileMonitor::setScanThreads(int threads) {
+    scanner.setThreadCount(threads);
+}
+
+int FileMonitor::scanDirectory(const std::string& rootPath, bool fullRescan) {
+    return rebuildIndex(rootPath, fullRescan, true);
+}
+
+int FileMonitor::rebuildIndex(const std::string& rootPath, bool fullRescan, bool verbose) {
+    std::lock_guard<std::mutex> scanLock(scanMutex);
+    const uint64_t minSize = kMinIndexSize + 1;
+    if (currentRootPath != rootPath) currentRootPath = rootPath;
+
+    // 扫描期间不接收变化，扫完后新索引已包含它们
+    watcher.stop();
+
+    int64_t startNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    // 同一根目录、同一阈值的旧索引可以做增量扫描
+    DirCache cache;
+    int64_t racyAfterNs = 0;
+    bool incremental = !fullRescan && fileIndex.isLoaded() &&
+                       fileIndex.rootPath() == rootPath && fileIndex.minSize() == minSize;
+    if (incremental) {
+        cache = fileIndex.buildDirCache();
+        // 上次扫描期间被改过的目录，时间戳可能没变，留 1 秒余量重新读
+        racyAfterNs = fileIndex.scanStartNs() - 1000000000LL;
+    }
+
+    // 目录没变而文件原地长大越过阈值时增量扫描看不到，监听期间记下的这类文件扫完后补回
+    std::vector<std::string> carried;
+    if (incremental) {
+        std::lock_guard<std::mutex> lock(overlayMutex);
+        for (const auto& kv : overlay) {
+            if (kv.second > 0) carried.push_back(kv.first);
+        }
+    }
+
+    // 析构时 stopping 置位，扫描尽快结束；扫到一半的结果不能当作完整索引保存
+    ScanResult result = scanner.scan(rootPath, minSize, incremental ? &cache : nullptr, racyAfterNs, &stopping);
+    if (stopping) return static_cast<int>(fileIndex.fileCount());
+    if (incremental && verbose) {
+        std::cout << "[DataRadar] 增量扫描: " << result.dirs.size() << " 个目录中 "
+                  << result.reusedDirs << " 个未变化" << std::endl;
+    }
+    if (!carried.empty()) {
+        std::unordered_set<std::string> found;
+        for (const auto& f : result.files) found.insert(f.path);
+        for (const auto& path : carried) {
+            struct stat st;
+            if (found.count(path) || lstat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode) ||
+                static_cast<uint64_t>(st.st_size) < minSize) continue;
+            result.files.push_back(ScanEntry{path, static_cast<uint64_t>(st.st_size),
+                                             static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec});
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(overlayMutex);
+        if (!fileIndex.save(indexPath, rootPath, minSize, result, startNs)) {
+            std::cerr << "[DataRadar] 无法写入索引 " << indexPath << "，本次结果仅保存在内存中。" << std::endl;
+        }
+        overlay.clear();
+        removedDirs.clear();
+        rescanQueue.clear();
+        foldPending = false;
+        reloadIndexedPathsLocked();
+    }
+    restartWatcher();
+    return static_cast<int>(fileIndex.fileCount());
+}
+
+void FileMonitor::setLiveUpdates(bool enable) {
+    liveUpdates = enable;
+    if (enable) restartWatcher();
+    else watcher.stop();
+}
+
+void FileMonitor::restartWatcher() {
+    if (!liveUpdates || !fileIndex.isLoaded()) return;
+    bool ok = watcher.start(fileIndex.rootPath(), fileIndex.dirPaths(),
+                            [this](const std::vector<FileChange>& changes) { applyChanges(changes); });
+    if (!ok) {
+        std::cerr << "[DataRadar] 无法启动文件监听，索引只在扫描时更新。" << std::endl;
+    } else if (watcher.skippedDirs() > 0) {
+        std::cerr << "[DataRadar] inotify 配额不足，" << watcher.skippedDirs() << " 个目录未被监听。" << std::endl;
+    }
+}
+
+void FileMonitor::reloadIndexedPathsLocked() {
+    indexedPaths.clear();
+    size_t n = fileIndex.fileCount();
+    indexedPaths.reserve(n);
+    for (size_t i = 0; i < n; ++i) indexedPaths.insert(fileIndex.pathByRank(i));
+}
+
+// 逐级查祖先目录，不随作废目录的个数变慢
+bool FileMonitor::isUnderRemovedDir(const std::string& path) const {
+    if (removedDirs.empty()) return false;
+    for (size_t pos = path.find_last_of('/'); pos != std::string::npos;
+         pos = (pos == 0) ? std::string::npos : path.find_last_of('/', pos - 1)) {
+        if (removedDirs.count(pos == 0 ? std::string("/") : path.substr(0, pos))) return true;
+    }
+    return false;
+}
+
+// 作废一个目录：去掉它下面的 overlay 项，已被上层覆盖时不再记，记下时并掉它下面已记的目录
+void FileMonitor::removeDirLocked(const std::string& dir) {
+    std::string prefix = (dir.back() == '/') ? dir : dir + "/";
+    std::string upper = prefix;
+    upper.back() = '/' + 1;   // [prefix, upper) 正好是 dir 之下的全部路径
+    overlay.erase(overlay.lower_bound(prefix), overlay.lower_bound(upper));
+    dirRemovals++;
+
+    if (removedDirs.count(dir) || isUnderRemovedDir(dir)) return;
+    removedDirs.erase(removedDirs.lower_bound(prefix), removedDirs.lower_bound(upper));
+    removedDirs.insert(dir);
+}
+
+// 在监听线程中执行：把一批变化应用到 overlay，新目录的子树交给后台线程扫描
+void FileMonitor::applyChanges(const std::vector<FileChange>& changes) {
+    std::vector<std::pair<const std::string*, uint64_t>> sizes;
+    for (const auto& c : changes) {
+        if (c.kind != FileChange::UPDATED && c.kind != FileChange::REMOVED) continue;
+        uint64_t size = 0;
+        struct stat st;
+        if (c.kind == FileChange::UPDATED && lstat(c.path.c_str(), &st) == 0 && S_ISREG(st.st_mode) &&
+            static_cast<uint64_t>(st.st_size) > kMinIndexSize) {
+            size = static_cast<uint64_t>(st.st_size);
+        }
+        sizes.emplace_back(&c.path, size);
+    }
+
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(overlayMutex);
+        for (const auto& c : changes) {
+            if (c.kind != FileChange::DIR_REMOVED && c.kind != FileChange::DIR_ADDED) continue;
+            // 目录整体作废；新出现的目录由后台线程再扫一遍子树
+            removeDirLocked(c.path);
+            if (c.kind == FileChange::DIR_ADDED) {
+                rescanQueue.push_back(c.path);
+                wake = true;
+            }
+        }
+        for (const auto& kv : sizes) {
+            const std::string& path = *kv.first;
+            if (kv.second > 0) overlay[path] = kv.second;
+            else if (indexedPaths.count(path) && !isUnderRemovedDir(path)) overlay[path] = 0;
+            else overlay.erase(path);   // 本来就不在索引里的小文件不用记
+        }
+        if (!foldPending && overlay.size() + removedDirs.size() > kOverlayFoldLimit) {
+            foldPending = true;
+            wake = true;
+        }
+    }
+    if (wake) rescanCv.notify_one();
+}
+
+void FileMonitor::rescanLoop() {
+    std::unique_lock<std::mutex> lock(overlayMutex);
+    while (true) {
+        rescanCv.wait(lock, [this] { return stopping || foldPending || !rescanQueue.empty(); });
+        if (stopping) return;
+
+        if (foldPending) {
+            // 变化积累太多：做一次增量扫描写回磁盘索引，overlay 随之清空
+            std::string root = currentRootPath;
+            lock.unlock();
+            rebuildIndex(root, false, false);
+            lock.lock();
+            continue;
         }
-    } catch (...) {}
 
-    // 按大小降序
-    std::sort(fileIndex.begin(), fileIndex.end(), [](const FileInfo& a, const FileInfo& b) {
-        return a.sizeBytes > b.sizeBytes;
-    });
+        // 祖先目录也在队列里的不必单独扫
+        std::unordered_set<std::string> queued(rescanQueue.begin(), rescanQueue.end());
+        rescanQueue.clear();
+        std::vector<std::string> roots;
+        for (const auto& dir : queued) {
+            bool covered = false;
+            for (size_t pos = dir.find_last_of('/'); pos != std::string::npos && pos > 0 && !covered;
+                 pos = dir.find_last_of('/', pos - 1)) {
+                covered = queued.count(dir.substr(0, pos)) > 0;
+            }
+            if (!covered) roots.push_back(dir);
+        }
+        uint64_t removalsBefore = dirRemovals;
+        lock.unlock();
+        std::vector<ScanEntry> found = scanner.scan(roots, kMinIndexSize + 1, nullptr, 0, &stopping).files;
+        lock.lock();
+        if (stopping) return;
 
-    return count;
+        // 扫描期间又有目录作废，结果里可能有已经删掉的文件
+        bool recheck = (dirRemovals != removalsBefore);
+        for (const auto& e : found) {
+            struct stat st;
+            if (recheck && lstat(e.path.c_str(), &st) != 0) continue;
+            overlay[e.path] = e.sizeBytes;
+        }
+    }
 }
 
 std::vector<FileInfo> FileMonitor::getLargeFiles(double sizeMB, int limit) {
     std::vector<FileInfo> result;
     uintmax_t thresholdBytes = static_cast<uintmax_t>(sizeMB * 1024 * 1024);
-    
-    int count = 0;
-    for (const auto& file : fileIndex) {
-        if (file.sizeBytes >= thresholdBytes) {
-            result.push_back(file);
-            count++;
-            if (limit != -1 && count >= limit) break;
+    std::lock_guard<std::mutex> lock(overlayMutex);
+
+    auto makeInfo = [this](std::string path, uint64_t size) {
+        FileInfo info;
+        info.name = fs::path(path).filename().string();
+        info.path = std::move(path);
+        info.sizeBytes = size;
+        info.sizeStr = formatSize(size);
+        return info;
+    };
+
+    // 索引已按大小降序，遇到第一个不够大的就可以停；被 overlay 覆盖的项跳过
+    size_t n = fileIndex.fileCount();
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t size = fileIndex.sizeByRank(i);
+        if (size < thresholdBytes) break;
+        std::string path = fileIndex.pathByRank(i);
+        if (overlay.count(path) || isUnderRemovedDir(path)) continue;
+        result.push_back(makeInfo(std::move(path), size));
+        if (limit != -1 && static_cast<int>(result.size()) >= limit) break;
+    }
+
+    if (!overlay.empty()) {
+        for (const auto& kv : overlay) {
+            if (kv.second > 0 && kv.second >= thresholdBytes) result.push_back(makeInfo(kv.first, kv.second));
         }
+        std::sort(result.begin(), result.end(), [](const FileInfo& a, const FileInfo& b) {
+            return a.sizeBytes > b.sizeBytes;
+        });
+        if (limit != -1 && static_cast<int>(result.size()) > limit) result.resize(limit);
     }
     return result;
-}
\ No newline at end of file
+}
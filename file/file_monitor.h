@@ -9,6 +9,17 @@
 #include <string>
 #include <vector>
 #include <filesystem>
+#include "file/dir_scanner.h"
+#include "file/file_index.h"
+#include "file/file_watcher.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_set>
 
 struct FileInfo {
     std::string path;
@@ -26,19 +37,67 @@ public:
 
     /**
      * @brief 扫描并建立大文件索引
+     * @details 由 DirScanner 多线程并行遍历；同一根目录已有索引时做增量扫描，
+     *          只重新读 mtime/ctime 变化过的目录。结果写入磁盘索引，下次启动直接 mmap。
+     * @param fullRescan true 时忽略旧索引全量扫描 (目录没变但文件长大越过阈值的情况只有全量扫描能发现)
      * @return 扫描到的文件数量
      */
-    int scanDirectory(const std::string& rootPath);
+    int scanDirectory(const std::string& rootPath, bool fullRescan = false);
+
+    /**
+     * @brief 设置扫描线程数 (<= 0 表示使用全部逻辑核心)
+     */
+    void setScanThreads(int threads);
 
     /**
      * @brief 获取大于指定阈值的文件
+     * @details 直接顺着 mmap 索引的大小降序排列读取，再合并实时监听到的变化
      */
     std::vector<FileInfo> getLargeFiles(double sizeMB, int limit = 50);
 
+    /**
+     * @brief 开关实时更新
+     * @details 开启后后台线程监听文件变化 (root 用 fanotify，否则 inotify)，
+     *          增量修正大文件索引，getLargeFiles 不用重新扫描也是新的。
+     *          变化先记在内存里，积累到 kOverlayFoldLimit 条后由后台线程做一次增量扫描并回磁盘索引
+     */
+    void setLiveUpdates(bool enable);
+
 private:
     std::string currentRootPath;
-    std::vector<FileInfo> fileIndex; 
+    std::string indexPath;   // 磁盘索引位置 ($XDG_CACHE_HOME/aios/file_index.bin)
+    FileIndex fileIndex;
+    DirScanner scanner;
     std::string formatSize(uintmax_t bytes);
+
+    static constexpr uint64_t kMinIndexSize = 10 * 1024 * 1024;  // 只索引 > 10MB 的文件
+    static constexpr size_t kOverlayFoldLimit = 4096;            // overlay 与作废目录合计超过这么多就并回索引
+
+    std::mutex scanMutex;    // 指令线程的扫描和后台合并互斥
+
+    // === 实时更新 ===
+    bool liveUpdates;
+    FileWatcher watcher;
+    std::mutex overlayMutex;                       // 保护以下成员和 fileIndex 的替换
+    std::map<std::string, uint64_t> overlay;       // 路径 -> 最新大小；只记大文件，0 表示索引里的这一项已失效
+    std::set<std::string> removedDirs;             // 这些目录下的旧索引项全部作废 (互不包含)
+    std::unordered_set<std::string> indexedPaths;  // 索引里的文件，删除或变小时据此决定要不要留 0
+
+    // 后台扫描线程：新目录的子树扫描和 overlay 合并都不占用监听线程
+    std::thread rescanThread;
+    std::condition_variable rescanCv;
+    std::deque<std::string> rescanQueue;           // 待扫描的新目录
+    bool foldPending;
+    uint64_t dirRemovals;                          // 作废目录的次数，后台扫描据此判断结果是否已过时
+    std::atomic<bool> stopping;
+
+    int rebuildIndex(const std::string& rootPath, bool fullRescan, bool verbose);
+    void restartWatcher();
+    void applyChanges(const std::vector<FileChange>& changes);
+    void rescanLoop();
+    void removeDirLocked(const std::string& dir);
+    void reloadIndexedPathsLocked();
+    bool isUnderRemovedDir(const std::string& path) const;
 };
 
 #endif // FILE_MONITOR_H
\ No newline at end of file
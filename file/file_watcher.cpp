@@ -0,0 +1,352 @@
+/**
+ * @file file_watcher.cpp
+ * @brief 文件变化监听实现
+ */
+
+#include "file/file_watcher.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/fanotify.h>
+#include <sys/inotify.h>
+
+// 合并窗口：安静这么久就回调；一直有事件时最多攒这么久
+static const int kQuietMs = 100;
+static const int kMaxDelayMs = 1000;
+
+// 本进程全部 FileWatcher 合计最多占系统 inotify 上限的 1/4，给其他程序留余量
+static size_t processWatchBudget() {
+    static const size_t budget = [] {
+        size_t b = 0;
+        FILE* f = fopen("/proc/sys/fs/inotify/max_user_watches", "r");
+        if (f) {
+            unsigned long maxWatches = 0;
+            if (fscanf(f, "%lu", &maxWatches) == 1) b = maxWatches / 4;
+            fclose(f);
+        }
+        return b > 0 ? b : 4096;
+    }();
+    return budget;
+}
+static std::atomic<size_t> watchesInUse{0};
+
+FileWatcher::FileWatcher()
+    : fanFd(-1), mountFd(-1), inoFd(-1), wakeFd(-1), running(false), watchBudget(processWatchBudget()),
+      skipped(0), budgetWarned(false) {}
+
+FileWatcher::~FileWatcher() {
+    stop();
+}
+
+bool FileWatcher::underRoot(const std::string& path) const {
+    if (path.compare(0, root.size(), root) != 0) return false;
+    return path.size() == root.size() || path[root.size()] == '/' || root.back() == '/';
+}
+
+bool FileWatcher::start(const std::string& rootPath, const std::vector<std::string>& dirs,
+                        Callback onChange, bool allowFanotify) {
+    stop();
+    root = rootPath;
+    callback = std::move(onChange);
+    pending.clear();
+
+    wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wakeFd < 0) return false;
+
+    bool ok = (allowFanotify && startFanotify()) || startInotify(dirs);
+    if (!ok) {
+        close(wakeFd);
+        wakeFd = -1;
+        return false;
+    }
+
+    running = true;
+    worker = std::thread(&FileWatcher::watchLoop, this);
+    return true;
+}
+
+void FileWatcher::stop() {
+    if (running) {
+        running = false;
+        uint64_t one = 1;
+        if (write(wakeFd, &one, sizeof(one)) < 0) {}
+    }
+    if (worker.joinable()) worker.join();
+
+    if (fanFd >= 0) { close(fanFd); fanFd = -1; }
+    if (mountFd >= 0) { close(mountFd); mountFd = -1; }
+    if (inoFd >= 0) { close(inoFd); inoFd = -1; }
+    if (wakeFd >= 0) { close(wakeFd); wakeFd = -1; }
+    watchesInUse -= wdPaths.size();
+    wdPaths.clear();
+    handlePaths.clear();
+    skipped = 0;
+    budgetWarned = false;
+}
+
+// ---------- fanotify (root) ----------
+
+bool FileWatcher::startFanotify() {
+    fanFd = fanotify_init(FAN_CLASS_NOTIF | FAN_CLOEXEC | FAN_NONBLOCK | FAN_REPORT_DFID_NAME, O_RDONLY);
+    if (fanFd < 0) return false;  // 非 root 或内核 < 5.9
+
+    uint64_t mask = FAN_CREATE | FAN_DELETE | FAN_MOVED_FROM | FAN_MOVED_TO | FAN_MODIFY | FAN_ONDIR;
+    if (fanotify_mark(fanFd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM, mask, AT_FDCWD, root.c_str()) != 0) {
+        close(fanFd);
+        fanFd = -1;
+        return false;
+    }
+    mountFd = open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (mountFd < 0) {
+        close(fanFd);
+        fanFd = -1;
+        return false;
+    }
+    return true;
+}
+
+void FileWatcher::readFanotify() {
+    alignas(struct fanotify_event_metadata) char buf[16384];
+    for (;;) {
+        ssize_t len = read(fanFd, buf, sizeof(buf));
+        if (len <= 0) return;
+
+        struct fanotify_event_metadata* meta = reinterpret_cast<struct fanotify_event_metadata*>(buf);
+        for (; FAN_EVENT_OK(meta, len); meta = FAN_EVENT_NEXT(meta, len)) {
+            if (meta->mask & FAN_Q_OVERFLOW) {
+                note(root, FileChange::DIR_ADDED);  // 丢了事件，只能整棵重扫
+                continue;
+            }
+
+            // 附加信息里是父目录句柄 + 文件名
+            char* info = reinterpret_cast<char*>(meta) + meta->metadata_len;
+            char* end = reinterpret_cast<char*>(meta) + meta->event_len;
+            while (info + sizeof(struct fanotify_event_info_header) <= end) {
+                auto* hdr = reinterpret_cast<struct fanotify_event_info_header*>(info);
+                if (hdr->len == 0) break;
+                if (hdr->info_type == FAN_EVENT_INFO_TYPE_DFID_NAME) {
+                    auto* fid = reinterpret_cast<struct fanotify_event_info_fid*>(info);
+                    auto* handle = reinterpret_cast<struct file_handle*>(fid->handle);
+                    const char* name = reinterpret_cast<const char*>(handle->f_handle) + handle->handle_bytes;
+
+                    std::string key(reinterpret_cast<const char*>(handle), sizeof(*handle) + handle->handle_bytes);
+                    auto it = handlePaths.find(key);
+                    if (it == handlePaths.end()) {
+                        int fd = open_by_handle_at(mountFd, handle, O_PATH | O_CLOEXEC);
+                        if (fd < 0) break;  // 目录已经没了
+                        char linkPath[64], dirPath[PATH_MAX];
+                        snprintf(linkPath, sizeof(linkPath), "/proc/self/fd/%d", fd);
+                        ssize_t n = readlink(linkPath, dirPath, sizeof(dirPath) - 1);
+                        close(fd);
+                        if (n <= 0) break;
+                        it = handlePaths.emplace(key, std::string(dirPath, n)).first;
+                    }
+
+                    std::string path = it->second;
+                    if (path.back() != '/') path += '/';
+                    path += name;
+
+                    // 目录改名、移动后缓存的路径都可能失效；从 root 外移进来的目录也一样
+                    // (它的子目录之前按 root 外的路径缓存过)
+                    bool isDir = meta->mask & FAN_ONDIR;
+                    if (isDir && (meta->mask & (FAN_DELETE | FAN_MOVED_FROM | FAN_MOVED_TO))) handlePaths.clear();
+                    if (!underRoot(path)) break;
+
+                    if (meta->mask & (FAN_DELETE | FAN_MOVED_FROM)) {
+                        note(path, isDir ? FileChange::DIR_REMOVED : FileChange::REMOVED);
+                    } else if (isDir) {
+                        if (meta->mask & (FAN_CREATE | FAN_MOVED_TO)) note(path, FileChange::DIR_ADDED);
+                    } else {
+                        note(path, FileChange::UPDATED);
+                    }
+                    break;
+                }
+                info += hdr->len;
+            }
+        }
+    }
+}
+
+// ---------- inotify (非 root 回退) ----------
+
+bool FileWatcher::startInotify(const std::vector<std::string>& dirs) {
+    inoFd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (inoFd < 0) return false;
+    if (dirs.empty()) addWatchTree(root);
+    else for (const auto& d : dirs) addWatch(d);
+    return true;
+}
+
+void FileWatcher::addWatch(const std::string& dir) {
+    if (wdPaths.size() >= watchBudget || watchesInUse >= processWatchBudget()) {
+        skipped++;
+        if (!budgetWarned) {
+            budgetWarned = true;
+            std::cerr << "[Warning] inotify watch 配额已用完 (本进程上限 " << processWatchBudget()
+                      << ")，" << root << " 下的其余目录不再实时监听。" << std::endl;
+        }
+        return;
+    }
+    uint32_t mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE | IN_MODIFY |
+                    IN_ONLYDIR | IN_DONT_FOLLOW | IN_EXCL_UNLINK;
+    int wd = inotify_add_watch(inoFd, dir.c_str(), mask);
+    if (wd >= 0) {
+        // 同一目录再加一次会拿到同一个 wd，不重复计数
+        if (wdPaths.emplace(wd, dir).second) watchesInUse++;
+        else wdPaths[wd] = dir;
+    } else if (errno == ENOSPC) {
+        skipped++;
+    }
+}
+
+void FileWatcher::addWatchTree(const std::string& dir) {
+    addWatch(dir);
+    DIR* d = opendir(dir.c_str());
+    if (!d) return;
+    struct dirent* e;
+    while ((e = readdir(d)) != nullptr) {
+        if (e->d_type != DT_DIR) continue;
+        if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0) continue;
+        std::string child = dir;
+        if (child.back() != '/') child += '/';
+        addWatchTree(child + e->d_name);
+    }
+    closedir(d);
+}
+
+void FileWatcher::readInotify() {
+    alignas(struct inotify_event) char buf[16384];
+    for (;;) {
+        ssize_t len = read(inoFd, buf, sizeof(buf));
+        if (len <= 0) return;
+
+        for (char* p = buf; p < buf + len;) {
+            auto* ev = reinterpret_cast<struct inotify_event*>(p);
+            p += sizeof(struct inotify_event) + ev->len;
+
+            if (ev->mask & IN_Q_OVERFLOW) {
+                note(root, FileChange::DIR_ADDED);
+                continue;
+            }
+            if (ev->mask & IN_IGNORED) {
+                if (wdPaths.erase(ev->wd)) watchesInUse--;
+                continue;
+            }
+            auto it = wdPaths.find(ev->wd);
+            if (it == wdPaths.end() || ev->len == 0) continue;
+
+            std::string path = it->second;
+            if (path.back() != '/') path += '/';
+            path += ev->name;
+            bool isDir = ev->mask & IN_ISDIR;
+
+            if (ev->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                note(path, isDir ? FileChange::DIR_REMOVED : FileChange::REMOVED);
+                if (isDir) {
+                    // 移走的子树上的 watch 路径已经不对了，全部撤掉
+                    std::string prefix = path + "/";
+                    for (auto w = wdPaths.begin(); w != wdPaths.end();) {
+                        if (w->second == path || w->second.compare(0, prefix.size(), prefix) == 0) {
+                            inotify_rm_watch(inoFd, w->first);
+                            w = wdPaths.erase(w);
+                            watchesInUse--;
+                        } else {
+                            ++w;
+                        }
+                    }
+                }
+            } else if (isDir) {
+                if (ev->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    addWatchTree(path);
+                    note(path, FileChange::DIR_ADDED);
+                }
+            } else {
+                note(path, FileChange::UPDATED);
+            }
+        }
+    }
+}
+
+// ---------- 合并与回调 ----------
+
+void FileWatcher::note(const std::string& path, FileChange::Kind kind) {
+    auto it = pending.find(path);
+    // 同一目录的删除后又新建，按新建处理 (回调会先清掉旧内容)
+    if (it != pending.end() && it->second == FileChange::DIR_ADDED && kind == FileChange::DIR_REMOVED) return;
+    pending[path] = kind;
+}
+
+void FileWatcher::flush() {
+    if (pending.empty()) return;
+    std::vector<FileChange> batch;
+    batch.reserve(pending.size());
+    // 目录级变化排在前面，文件变化在其后应用
+    for (const auto& kv : pending) {
+        if (kv.second == FileChange::DIR_REMOVED || kv.second == FileChange::DIR_ADDED) {
+            batch.push_back(FileChange{kv.second, kv.first});
+        }
+    }
+    for (const auto& kv : pending) {
+        if (kv.second == FileChange::UPDATED || kv.second == FileChange::REMOVED) {
+            batch.push_back(FileChange{kv.second, kv.first});
+        }
+    }
+    pending.clear();
+    if (callback) callback(batch);
+}
+
+void FileWatcher::watchLoop() {
+    struct pollfd fds[2];
+    fds[0].fd = (fanFd >= 0) ? fanFd : inoFd;
+    fds[0].events = POLLIN;
+    fds[1].fd = wakeFd;
+    fds[1].events = POLLIN;
+
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point firstPending, lastEvent;
+
+    while (running) {
+        int timeout = -1;
+        if (!pending.empty()) {
+            auto now = Clock::now();
+            auto quiet = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastEvent).count();
+            auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(now - firstPending).count();
+            timeout = static_cast<int>(std::max<long long>(0, std::min<long long>(kQuietMs - quiet, kMaxDelayMs - waited)));
+        }
+
+        int r = poll(fds, 2, timeout);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "[Error] FileWatcher poll: " << strerror(errno) << std::endl;
+            running = false;
+            return;
+        }
+        if (fds[1].revents & POLLIN) break;
+
+        if (r > 0 && (fds[0].revents & POLLIN)) {
+            bool wasEmpty = pending.empty();
+            if (fanFd >= 0) readFanotify();
+            else readInotify();
+            if (!pending.empty()) {
+                lastEvent = Clock::now();
+                if (wasEmpty) firstPending = lastEvent;
+                // 事件持续不断时也不能一直攒着
+                if (lastEvent - firstPending >= std::chrono::milliseconds(kMaxDelayMs)) flush();
+            }
+            continue;
+        }
+
+        if (r == 0) flush();  // 超时：安静够久或攒够久
+    }
+}
@@ -0,0 +1,96 @@
+/**
+ * @file file_watcher.h
+ * @brief 文件变化监听 (fanotify / inotify)
+ * @details root 下用 fanotify 给整个文件系统打标记 (FAN_MARK_FILESYSTEM + FAN_REPORT_DFID_NAME)，
+ *          一个标记覆盖所有目录；非 root 时回退为逐目录 inotify，受 watch 数量预算限制。
+ *          事件在后台线程里按路径合并：同一路径的一串写入只在安静下来后回调一次。
+ */
+
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <thread>
+#include <atomic>
+
+// 合并后的一条变化
+struct FileChange {
+    enum Kind {
+        UPDATED,      // 文件新建/写入/移入，需要重新 stat
+        REMOVED,      // 文件删除/移出
+        DIR_ADDED,    // 目录新建/移入，需要扫描整棵子树
+        DIR_REMOVED   // 目录删除/移出，其下所有文件作废
+    };
+    Kind kind;
+    std::string path;
+};
+
+class FileWatcher {
+public:
+    using Callback = std::function<void(const std::vector<FileChange>&)>;
+
+    FileWatcher();
+    ~FileWatcher();
+
+    /**
+     * @brief 开始监听 rootPath 下的变化
+     * @param dirs 已知的全部目录 (inotify 模式下逐个加 watch)
+     * @param onChange 在监听线程中被调用，每次传入一批合并后的变化
+     * @param allowFanotify false 时强制使用 inotify
+     * @return 两种方式都不可用时返回 false
+     */
+    bool start(const std::string& rootPath, const std::vector<std::string>& dirs,
+               Callback onChange, bool allowFanotify = true);
+
+    void stop();
+
+    bool isRunning() const { return running; }
+    bool usingFanotify() const { return fanFd >= 0; }
+
+    /**
+     * @brief inotify 模式下因预算不足没有加上 watch 的目录数
+     */
+    size_t skippedDirs() const { return skipped; }
+
+    /**
+     * @brief 单个监听器的 inotify watch 预算
+     * @details 默认等于进程预算 (系统上限的 1/4)；无论怎么设，本进程全部监听器合计都不超过进程预算
+     */
+    void setWatchBudget(size_t budget) { watchBudget = budget; }
+    size_t getWatchBudget() const { return watchBudget; }
+
+private:
+    int fanFd;
+    int mountFd;                // fanotify 解析 file handle 用
+    int inoFd;
+    int wakeFd;
+    std::string root;
+    Callback callback;
+    std::atomic<bool> running;
+    std::thread worker;
+
+    size_t watchBudget;
+    size_t skipped;
+    bool budgetWarned;          // 配额用完只提示一次
+    std::unordered_map<int, std::string> wdPaths;          // inotify wd -> 目录
+    std::unordered_map<std::string, std::string> handlePaths;  // fanotify 目录句柄 -> 路径缓存
+
+    // 等待合并的变化: 路径 -> 最近一次的类型
+    std::unordered_map<std::string, FileChange::Kind> pending;
+
+    bool startFanotify();
+    bool startInotify(const std::vector<std::string>& dirs);
+    void addWatch(const std::string& dir);
+    void addWatchTree(const std::string& dir);
+    void watchLoop();
+    void readFanotify();
+    void readInotify();
+    void note(const std::string& path, FileChange::Kind kind);
+    void flush();
+    bool underRoot(const std::string& path) const;
+};
+
+#endif // FILE_WATCHER_H
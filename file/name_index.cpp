@@ -0,0 +1,407 @@
+/**
+ * @file name_index.cpp
+ * @brief 文件名三元组索引实现
+ */
+
+#include "file/name_index.h"
+#include "core/text_match.h"
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <string_view>
+#include <unordered_set>
+#include <sys/stat.h>
+
+namespace {
+
+inline char lowerAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// 三元组按小写计算，原始路径不必另存一份小写副本
+inline uint32_t trigramAt(const char* p) {
+    return (static_cast<uint32_t>(static_cast<unsigned char>(lowerAscii(p[0]))) << 16) |
+           (static_cast<uint32_t>(static_cast<unsigned char>(lowerAscii(p[1]))) << 8) |
+           static_cast<uint32_t>(static_cast<unsigned char>(lowerAscii(p[2])));
+}
+
+inline uint64_t hashPath(std::string_view path) {
+    return std::hash<std::string_view>()(path);
+}
+
+size_t nameOffsetOf(const std::string& path) {
+    size_t pos = path.find_last_of('/');
+    return pos == std::string::npos ? 0 : pos + 1;
+}
+
+// 父目录在路径中的长度 ("/a" 的父目录是 "/")
+inline size_t parentLenOf(size_t nameOff) {
+    return nameOff > 1 ? nameOff - 1 : nameOff;
+}
+
+// 匹配位置是否在"词首" (前一个字符是分隔符)
+inline bool atWordStart(std::string_view name, size_t pos) {
+    if (pos == 0) return true;
+    char c = name[pos - 1];
+    return c == '.' || c == '_' || c == '-' || c == ' ';
+}
+
+// 作废条目不到这么多时不压实，避免小索引反复重建
+const size_t kCompactMinDead = 4096;
+
+} // namespace
+
+NameIndex::NameIndex() : aliveCount(0), ready(false), stopping(false), removals(0) {
+    // 与 FileMonitor 的监听共用本进程的 inotify 预算，这里最多用一半，另一半留给大文件索引
+    watcher.setWatchBudget(watcher.getWatchBudget() / 2);
+}
+
+NameIndex::~NameIndex() {
+    stopWorkers();
+}
+
+void NameIndex::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> q(rescanMutex);
+        stopping = true;
+    }
+    rescanCv.notify_all();
+    if (builder.joinable()) builder.join();
+    if (rescanThread.joinable()) rescanThread.join();
+    watcher.stop();
+    rescanQueue.clear();
+}
+
+size_t NameIndex::size() const {
+    std::shared_lock<std::shared_mutex> g(lock);
+    return aliveCount;
+}
+
+void NameIndex::buildAsync(const std::string& rootPath) {
+    stopWorkers();
+
+    root = rootPath;
+    ready = false;
+    stopping = false;
+    builder = std::thread(&NameIndex::buildTask, this);
+    rescanThread = std::thread(&NameIndex::rescanLoop, this);
+}
+
+void NameIndex::clearLocked() {
+    pool.clear();
+    entries.clear();
+    postings.clear();
+    byPathHash.clear();
+    children.clear();
+    aliveCount = 0;
+}
+
+void NameIndex::buildTask() {
+    ScanResult result = scanner.scan(root, 0, nullptr, 0, &stopping);
+    if (stopping) return;
+
+    std::vector<std::string> dirPaths;
+    dirPaths.reserve(result.dirs.size());
+    {
+        std::unique_lock<std::shared_mutex> g(lock);
+        clearLocked();
+        entries.reserve(result.files.size() + result.dirs.size());
+        byPathHash.reserve(result.files.size() + result.dirs.size());
+        for (const auto& d : result.dirs) {
+            if (d.path != root) addLocked(d.path, d.mtimeNs, true);
+            dirPaths.push_back(d.path);
+        }
+        for (const auto& f : result.files) addLocked(f.path, f.mtimeNs, false);
+    }
+    ready = true;
+
+    watcher.start(root, dirPaths, [this](const std::vector<FileChange>& changes) { applyChanges(changes); });
+}
+
+void NameIndex::addLocked(const std::string& path, int64_t mtimeNs, bool isDir) {
+    uint64_t h = hashPath(path);
+    auto range = byPathHash.equal_range(h);
+    for (auto it = range.first; it != range.second; ++it) {
+        Entry& e = entries[it->second];
+        if (e.alive && std::string_view(pool.data() + e.pathOff, e.pathLen) == path) {
+            e.mtimeNs = mtimeNs;  // 已存在：只刷新修改时间
+            return;
+        }
+    }
+
+    uint32_t id = static_cast<uint32_t>(entries.size());
+    Entry e;
+    e.pathOff = static_cast<uint32_t>(pool.size());
+    e.pathLen = static_cast<uint32_t>(path.size());
+    e.nameOff = static_cast<uint32_t>(nameOffsetOf(path));
+    e.alive = true;
+    e.isDir = isDir;
+    e.mtimeNs = mtimeNs;
+    entries.push_back(e);
+
+    pool += path;
+    byPathHash.emplace(h, id);
+    children[hashPath(std::string_view(path.data(), parentLenOf(e.nameOff)))].push_back(id);
+    aliveCount++;
+
+    // 新编号总是最大的，直接追加就能保持倒排列表有序
+    const char* name = pool.data() + e.pathOff + e.nameOff;
+    size_t nameLen = e.pathLen - e.nameOff;
+    for (size_t i = 0; i + 3 <= nameLen; ++i) {
+        auto& list = postings[trigramAt(name + i)];
+        if (list.empty() || list.back() != id) list.push_back(id);
+    }
+}
+
+// 倒排列表和子项表里的编号留着，查询时跳过，压实时清掉
+void NameIndex::killLocked(uint32_t id) {
+    Entry& e = entries[id];
+    e.alive = false;
+    aliveCount--;
+    auto range = byPathHash.equal_range(hashPath(std::string_view(pool.data() + e.pathOff, e.pathLen)));
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == id) {
+            byPathHash.erase(it);
+            return;
+        }
+    }
+}
+
+void NameIndex::removeLocked(const std::string& path) {
+    auto range = byPathHash.equal_range(hashPath(path));
+    for (auto it = range.first; it != range.second; ++it) {
+        const Entry& e = entries[it->second];
+        if (e.alive && std::string_view(pool.data() + e.pathOff, e.pathLen) == path) {
+            killLocked(it->second);
+            return;
+        }
+    }
+}
+
+// 顺着子项表往下走，只碰这棵子树里的条目
+void NameIndex::removeTreeLocked(const std::string& dir) {
+    std::vector<std::string> stack;
+    stack.push_back(dir.size() > 1 && dir.back() == '/' ? dir.substr(0, dir.size() - 1) : dir);
+    while (!stack.empty()) {
+        std::string parent = std::move(stack.back());
+        stack.pop_back();
+        auto it = children.find(hashPath(parent));
+        if (it == children.end()) continue;
+
+        std::vector<uint32_t>& ids = it->second;
+        size_t kept = 0;
+        for (uint32_t id : ids) {
+            const Entry& e = entries[id];
+            std::string_view path(pool.data() + e.pathOff, e.pathLen);
+            if (path.substr(0, parentLenOf(e.nameOff)) != parent) {
+                ids[kept++] = id;  // 哈希碰撞：别的目录的子项
+                continue;
+            }
+            if (!e.alive) continue;
+            if (e.isDir) stack.emplace_back(path);
+            killLocked(id);
+        }
+        ids.resize(kept);
+        if (kept == 0) children.erase(it);
+    }
+}
+
+// 只保留有效条目，从头重建池、倒排列表和两张表 (编号随之改变)
+void NameIndex::compactLocked() {
+    std::string oldPool;
+    std::vector<Entry> oldEntries;
+    oldPool.swap(pool);
+    oldEntries.swap(entries);
+    size_t alive = aliveCount;
+    clearLocked();
+
+    entries.reserve(alive);
+    byPathHash.reserve(alive);
+    std::string path;
+    for (const Entry& e : oldEntries) {
+        if (!e.alive) continue;
+        path.assign(oldPool.data() + e.pathOff, e.pathLen);
+        addLocked(path, e.mtimeNs, e.isDir);
+    }
+}
+
+// 在监听线程中执行：文件系统操作都在锁外做完，再一次性改索引；新目录的子树交给后台线程扫描
+void NameIndex::applyChanges(const std::vector<FileChange>& changes) {
+    struct FileState {
+        const std::string* path;
+        bool exists;
+        bool isDir;
+        int64_t mtimeNs;
+    };
+    std::vector<FileState> files;
+    for (const auto& c : changes) {
+        if (c.kind != FileChange::UPDATED && c.kind != FileChange::REMOVED) continue;
+        struct stat st;
+        bool exists = (c.kind == FileChange::UPDATED && lstat(c.path.c_str(), &st) == 0);
+        files.push_back(FileState{&c.path, exists, exists && S_ISDIR(st.st_mode),
+                                  exists ? static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec : 0});
+    }
+
+    bool wake = false;
+    {
+        std::unique_lock<std::shared_mutex> g(lock);
+        for (const auto& c : changes) {
+            if (c.kind == FileChange::DIR_REMOVED) {
+                removeTreeLocked(c.path);
+                removeLocked(c.path);
+                removals++;
+            } else if (c.kind == FileChange::DIR_ADDED) {
+                // 同一路径上旧目录留下的条目先清掉，子树扫完再加回来
+                removeTreeLocked(c.path);
+                wake = true;
+            }
+        }
+        for (const auto& f : files) {
+            if (f.exists) {
+                addLocked(*f.path, f.mtimeNs, f.isDir);
+            } else {
+                removeLocked(*f.path);
+                removals++;
+            }
+        }
+
+        size_t dead = entries.size() - aliveCount;
+        if (dead >= kCompactMinDead && dead > aliveCount) compactLocked();
+    }
+
+    if (!wake) return;
+    {
+        std::lock_guard<std::mutex> q(rescanMutex);
+        for (const auto& c : changes) {
+            if (c.kind == FileChange::DIR_ADDED) rescanQueue.push_back(c.path);
+        }
+    }
+    rescanCv.notify_one();
+}
+
+void NameIndex::rescanLoop() {
+    std::unique_lock<std::mutex> q(rescanMutex);
+    while (true) {
+        rescanCv.wait(q, [this] { return stopping || !rescanQueue.empty(); });
+        if (stopping) return;
+
+        // 排队期间攒下的新目录合并成一次扫描；祖先目录也在队列里的不必单独扫
+        std::unordered_set<std::string> queued(rescanQueue.begin(), rescanQueue.end());
+        rescanQueue.clear();
+        q.unlock();
+
+        std::vector<std::string> roots;
+        for (const auto& dir : queued) {
+            bool covered = false;
+            for (size_t pos = dir.find_last_of('/'); pos != std::string::npos && pos > 0 && !covered;
+                 pos = dir.find_last_of('/', pos - 1)) {
+                covered = queued.count(dir.substr(0, pos)) > 0;
+            }
+            if (!covered) roots.push_back(dir);
+        }
+        uint64_t removalsBefore;
+        {
+            std::shared_lock<std::shared_mutex> g(lock);
+            removalsBefore = removals;
+        }
+        ScanResult sub = scanner.scan(roots, 0, nullptr, 0, &stopping);
+        if (stopping) return;
+
+        {
+            std::unique_lock<std::shared_mutex> g(lock);
+            // 扫描期间又有东西被删掉，结果里可能有已经不存在的路径
+            bool recheck = (removals != removalsBefore);
+            struct stat st;
+            for (const auto& d : sub.dirs) {
+                if (d.path == root || (recheck && lstat(d.path.c_str(), &st) != 0)) continue;
+                addLocked(d.path, d.mtimeNs, true);
+            }
+            for (const auto& f : sub.files) {
+                if (recheck && lstat(f.path.c_str(), &st) != 0) continue;
+                addLocked(f.path, f.mtimeNs, false);
+            }
+        }
+        q.lock();
+    }
+}
+
+std::vector<std::string> NameIndex::search(const std::string& keyword, size_t limit) const {
+    std::vector<std::string> results;
+    if (keyword.empty() || limit == 0) return results;
+
+    TextMatcher matcher(keyword);
+
+    std::shared_lock<std::shared_mutex> g(lock);
+
+    struct Hit {
+        uint32_t id;
+        int quality;   // 越小越好
+    };
+    std::vector<Hit> hits;
+
+    auto verify = [&](uint32_t id) {
+        const Entry& e = entries[id];
+        if (!e.alive) return;
+        std::string_view name(pool.data() + e.pathOff + e.nameOff, e.pathLen - e.nameOff);
+        size_t pos = matcher.find(name.data(), name.size());
+        if (pos == TextMatcher::npos) return;
+        int q = 3;
+        if (pos == 0 && name.size() == keyword.size()) q = 0;
+        else if (pos == 0) q = 1;
+        else if (atWordStart(name, pos)) q = 2;
+        hits.push_back(Hit{id, q});
+    };
+
+    if (keyword.size() < 3) {
+        // 太短，没有三元组可用
+        for (uint32_t id = 0; id < entries.size(); ++id) verify(id);
+    } else {
+        // 1. 取出全部三元组的倒排列表，短的在前
+        std::vector<const std::vector<uint32_t>*> lists;
+        for (size_t i = 0; i + 3 <= keyword.size(); ++i) {
+            auto it = postings.find(trigramAt(keyword.data() + i));
+            if (it == postings.end()) return results;  // 有一个三元组不存在就不可能匹配
+            lists.push_back(&it->second);
+        }
+        std::sort(lists.begin(), lists.end());
+        lists.erase(std::unique(lists.begin(), lists.end()), lists.end());
+        std::sort(lists.begin(), lists.end(), [](const std::vector<uint32_t>* a, const std::vector<uint32_t>* b) {
+            return a->size() < b->size();
+        });
+
+        // 2. 以最短列表为候选，在其余列表里二分推进求交集
+        std::vector<uint32_t> candidates = *lists[0];
+        for (size_t li = 1; li < lists.size() && !candidates.empty(); ++li) {
+            const std::vector<uint32_t>& other = *lists[li];
+            auto cursor = other.begin();
+            size_t out = 0;
+            for (uint32_t id : candidates) {
+                cursor = std::lower_bound(cursor, other.end(), id);
+                if (cursor == other.end()) break;
+                if (*cursor == id) candidates[out++] = id;
+            }
+            candidates.resize(out);
+        }
+
+        // 3. 三元组都命中不代表连续出现，逐个校验
+        for (uint32_t id : candidates) verify(id);
+    }
+
+    // 匹配质量优先，其次最近修改，再次路径短的
+    auto better = [this](const Hit& a, const Hit& b) {
+        if (a.quality != b.quality) return a.quality < b.quality;
+        const Entry& ea = entries[a.id];
+        const Entry& eb = entries[b.id];
+        if (ea.mtimeNs != eb.mtimeNs) return ea.mtimeNs > eb.mtimeNs;
+        return ea.pathLen < eb.pathLen;
+    };
+    size_t n = std::min(limit, hits.size());
+    std::partial_sort(hits.begin(), hits.begin() + n, hits.end(), better);
+
+    results.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        const Entry& e = entries[hits[i].id];
+        results.emplace_back(pool.data() + e.pathOff, e.pathLen);
+    }
+    return results;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file name_index.h
+ * @brief 文件名三元组 (trigram) 索引
+ * @details 所有路径顺序存放在一个字符串池里，每个文件名 (转小写后) 的每个 3 字节片段
+ *          对应一条倒排列表 (按条目编号升序)。查询时取查询串的全部三元组，
+ *          从最短的倒排列表开始求交集，再对候选做一次真正的子串校验。
+ *          少于 3 字节的查询无法用三元组，退化为线性扫描文件名。
+ *          后台线程建索引，建好后用 FileWatcher 增量维护；删除只打标记，
+ *          作废条目超过一半时整体压实一次 (重建字符串池、条目和倒排列表)。
+ *          每个目录的直接子项另有一张表，删除整棵子树时只走这棵树，不扫全部条目。
+ *          新出现的目录要扫一遍子树，交给后台线程做，监听线程不会因为一棵大目录树卡住。
+ */
+
+#ifndef NAME_INDEX_H
+#define NAME_INDEX_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include "file/dir_scanner.h"
+#include "file/file_watcher.h"
+
+class NameIndex {
+public:
+    NameIndex();
+    ~NameIndex();
+
+    /**
+     * @brief 在后台线程中为 rootPath 建索引，建好后开始监听变化
+     */
+    void buildAsync(const std::string& rootPath);
+
+    /**
+     * @brief 索引是否已经可用
+     */
+    bool isReady() const { return ready; }
+
+    /**
+     * @brief 文件名子串搜索 (忽略 ASCII 大小写)
+     * @details 排序：完全相同 > 前缀 > 词首 > 其他位置，同级按修改时间从新到旧
+     * @return 最多 limit 条完整路径
+     */
+    std::vector<std::string> search(const std::string& keyword, size_t limit) const;
+
+    size_t size() const;
+
+private:
+    struct Entry {
+        uint32_t pathOff;
+        uint32_t pathLen;
+        uint32_t nameOff;   // 文件名在 path 中的偏移
+        bool alive;
+        bool isDir;
+        int64_t mtimeNs;
+    };
+
+    mutable std::shared_mutex lock;  // 查询共享，更新独占
+    std::string pool;                // 原始路径 (匹配时由 TextMatcher 忽略大小写)
+    std::vector<Entry> entries;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> postings;  // 三元组 -> 条目编号
+    std::unordered_multimap<uint64_t, uint32_t> byPathHash;        // 路径哈希 -> 条目编号
+    std::unordered_map<uint64_t, std::vector<uint32_t>> children;  // 父目录路径哈希 -> 直接子项编号
+    size_t aliveCount;
+
+    std::string root;
+    std::atomic<bool> ready;
+    std::atomic<bool> stopping;
+    std::thread builder;
+    DirScanner scanner;
+    FileWatcher watcher;
+
+    // 新目录的子树扫描 (后台线程)
+    std::thread rescanThread;
+    std::mutex rescanMutex;
+    std::condition_variable rescanCv;
+    std::deque<std::string> rescanQueue;   // 待扫描的新目录
+    uint64_t removals;                     // 删除的次数 (在 lock 内修改)，后台扫描据此判断结果是否已过时
+
+    void stopWorkers();
+    void buildTask();
+    void rescanLoop();
+    void addLocked(const std::string& path, int64_t mtimeNs, bool isDir);
+    void killLocked(uint32_t id);
+    void removeLocked(const std::string& path);
+    void removeTreeLocked(const std::string& dir);
+    void applyChanges(const std::vector<FileChange>& changes);
+    void compactLocked();
+    void clearLocked();
+};
+
+#endif // NAME_INDEX_H
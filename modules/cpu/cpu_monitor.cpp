@@ -5,19 +5,96 @@
  */
 
 #include "modules/cpu/cpu_monitor.h"
+#include <algorithm>
 #include <iostream>
-#include <sstream>
-#include <fstream>
-#include <thread>
-#include <chrono>
-#include <numeric>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <unistd.h>
+
+namespace {
+
+const char* const kCpuSysDir = "/sys/devices/system/cpu";
+
+// 每个 cpuN 行最长约 10 个 20 位数字，按 256 字节预留；后面的 intr 行被截断无妨
+const size_t kStatBytesPerCore = 256;
+
+// 一个采样区间内各状态的占比 (%)
+struct Shares {
+    double busy;
+    double iowait;
+    double irq;
+    double softirq;
+    double steal;
+};
+
+// 读取一个小的 sysfs 文本 (去掉结尾换行)，只在构造时使用
+std::string readSysText(const std::string& path) {
+    ProcFile f(path.c_str());
+    char buf[128];
+    long len = f.readAll(buf, sizeof(buf));
+    if (len <= 0) return "";
+    while (len > 0 && (buf[len - 1] == '\n' || buf[len - 1] == ' ')) len--;
+    return std::string(buf, static_cast<size_t>(len));
+}
+
+int readSysInt(const std::string& path, int fallback) {
+    std::string text = readSysText(path);
+    unsigned long long v = 0;
+    if (!ProcFile::scanU64(text.data(), text.data() + text.size(), v)) return fallback;   // 例如 -1
+    return static_cast<int>(v);
+}
+
+// 列出目录下以 prefix 开头、其后紧跟数字的条目，按数字升序
+std::vector<std::pair<int, std::string>> listNumbered(const std::string& dir, const char* prefix) {
+    std::vector<std::pair<int, std::string>> out;
+    DIR* d = opendir(dir.c_str());
+    if (!d) return out;
+    size_t plen = strlen(prefix);
+    while (struct dirent* e = readdir(d)) {
+        if (strncmp(e->d_name, prefix, plen) != 0) continue;
+        const char* num = e->d_name + plen;
+        if (*num < '0' || *num > '9') continue;
+        out.emplace_back(atoi(num), e->d_name);
+    }
+    closedir(d);
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+std::unique_ptr<ProcFile> openIfExists(const std::string& path) {
+    std::unique_ptr<ProcFile> f(new ProcFile(path.c_str()));
+    if (!f->isOpen()) f.reset();
+    return f;
+}
+
+// 读取 kHz (cpufreq) 或毫摄氏度 (hwmon/thermal) 一类的整数，读不到返回 fallback
+double readScaled(const ProcFile* f, double scale, double fallback) {
+    if (!f) return fallback;
+    char buf[32];
+    long len = f->readAll(buf, sizeof(buf));
+    unsigned long long v = 0;
+    if (len <= 0 || !ProcFile::scanU64(buf, buf + len, v)) return fallback;
+    return v / scale;
+}
+
+} // namespace
 
 /**
  * @brief 构造函数实现
  * @details 初始化时立即读取一次 CPU 状态，作为计算占用率的基准
  */
-CpuMonitor::CpuMonitor() {
-    this->prevStats = readCpuStats();
+CpuMonitor::CpuMonitor() : statFile("/proc/stat") {
+    if (!statFile.isOpen()) std::cerr << "[Error] Cannot open /proc/stat" << std::endl;
+    prevStats = CpuStats{};
+    discoverTopology();
+    openThermalSources();
+
+    readCpuStats([this](int id, const CpuStats& cur) {
+        if (id < 0) prevStats = cur;
+        else if (static_cast<size_t>(id) < slotOf.size() && slotOf[id] >= 0) prevCore[slotOf[id]] = cur;
+    });
+    sample();   // 先发布一份 (占用率此时还没有区间，接近 0)
 }
 
 /**
@@ -26,125 +103,305 @@ CpuMonitor::CpuMonitor() {
 CpuMonitor::~CpuMonitor() {}
 
 /**
- * @brief 内部辅助函数：读取 /proc/stat
- * @details 解析 /proc/stat 文件第一行（即 "cpu" 开头的总行），获取各项时间片
- * @return CpuStats 结构体
+ * @brief 识别在线核心及其 NUMA 节点与封装
+ * @details 以 /proc/stat 里出现的 cpuN 为准 (即在线核心)；之后才上线的核心不在统计范围内
  */
-CpuMonitor::CpuStats CpuMonitor::readCpuStats() {
-    CpuStats stats = {0};
-    std::ifstream file("/proc/stat");
-    
-    if (file.is_open()) {
-        std::string line;
-        std::getline(file, line); // 读取第一行
-        std::istringstream iss(line);
-        std::string cpuLabel;
-
-        // 格式: cpu  user nice system idle iowait irq softirq steal guest guest_nice
-        iss >> cpuLabel 
-            >> stats.user 
-            >> stats.nice 
-            >> stats.system 
-            >> stats.idle 
-            >> stats.iowait 
-            >> stats.irq 
-            >> stats.softirq 
-            >> stats.steal;
-        
-        file.close();
-    } else {
-        std::cerr << "[Error] Cannot open /proc/stat" << std::endl;
+void CpuMonitor::discoverTopology() {
+    long conf = sysconf(_SC_NPROCESSORS_CONF);
+    if (conf < 1) conf = 1;
+    statBuf.resize((static_cast<size_t>(conf) + 1) * kStatBytesPerCore + 1024);
+
+    readCpuStats([this](int id, const CpuStats&) {
+        if (id >= 0) cpuIds.push_back(id);
+    });
+
+    for (int id : cpuIds) {
+        std::string dir = std::string(kCpuSysDir) + "/cpu" + std::to_string(id);
+        // NUMA 节点以 cpuN/nodeX 链接的形式出现；没有 NUMA 支持时视为节点 0
+        auto nodes = listNumbered(dir, "node");
+        nodeIds.push_back(nodes.empty() ? 0 : nodes.front().first);
+        packageIds.push_back(readSysInt(dir + "/topology/physical_package_id", 0));
+
+        CoreFiles files;
+        files.cur = openIfExists(dir + "/cpufreq/scaling_cur_freq");
+        if (!files.cur) files.cur = openIfExists(dir + "/cpufreq/cpuinfo_cur_freq");
+        files.min = openIfExists(dir + "/cpufreq/scaling_min_freq");
+        files.max = openIfExists(dir + "/cpufreq/scaling_max_freq");
+        coreFiles.push_back(std::move(files));
+
+        if (static_cast<size_t>(id) >= slotOf.size()) slotOf.resize(id + 1, -1);
+        slotOf[id] = static_cast<int>(nodeIds.size() - 1);
     }
-    
-    return stats;
+    prevCore.assign(cpuIds.size(), CpuStats{});
+
+    packages = packageIds;
+    std::sort(packages.begin(), packages.end());
+    packages.erase(std::unique(packages.begin(), packages.end()), packages.end());
 }
 
 /**
- * @brief 获取系统整体 CPU 占用率
- * @details 
- * 计算公式: 
- * Total = User + Nice + System + Idle + IOWait + IRQ + SoftIRQ + Steal
- * Idle = Idle + IOWait
- * Usage = (Total_diff - Idle_diff) / Total_diff
- * * @return double CPU 使用率 (0.0 - 100.0)
+ * @brief 为每个封装找一个温度来源
+ * @details 按可信度依次尝试：
+ * 1. hwmon coretemp (Intel)：标签 "Package id P" 直接给出封装编号
+ * 2. hwmon k10temp/zenpower (AMD)：每个实例一个封装，按编号顺序对应
+ * 3. thermal_zone 中类型为 x86_pkg_temp 的热区，按编号顺序对应
+ * 4. 以上都没有时，把 thermal_zone0 当作第一个封装的温度 (原来的做法)
  */
-double CpuMonitor::getSystemCpuUsage() {
-    // 读取当前的统计数据
-    CpuStats currentStats = readCpuStats();
-
-    // 计算上一时刻的总时间
-    unsigned long long prevIdle = prevStats.idle + prevStats.iowait;
-    unsigned long long prevTotal = prevStats.user + prevStats.nice + prevStats.system + 
-                                   prevIdle + prevStats.irq + prevStats.softirq + prevStats.steal;
-
-    // 计算当前时刻的总时间
-    unsigned long long currentIdle = currentStats.idle + currentStats.iowait;
-    unsigned long long currentTotal = currentStats.user + currentStats.nice + currentStats.system + 
-                                      currentIdle + currentStats.irq + currentStats.softirq + currentStats.steal;
-
-    // 计算差值
-    unsigned long long totalDiff = currentTotal - prevTotal;
-    unsigned long long idleDiff = currentIdle - prevIdle;
-
-    double usage = 0.0;
-    
-    // 防止除以0
-    if (totalDiff > 0) {
-        usage = (double)(totalDiff - idleDiff) / totalDiff * 100.0;
+void CpuMonitor::openThermalSources() {
+    packageTempFiles.clear();
+    packageTempFiles.resize(packages.size());
+    auto slotOfPackage = [this](int pkg) -> int {
+        auto it = std::lower_bound(packages.begin(), packages.end(), pkg);
+        return (it != packages.end() && *it == pkg) ? static_cast<int>(it - packages.begin()) : -1;
+    };
+    // 按顺序对应的来源放到还没有温度的封装上
+    std::vector<std::string> ordered;
+    auto assignOrdered = [this](std::vector<std::string>& paths) {
+        size_t next = 0;
+        for (auto& f : packageTempFiles) {
+            while (!f && next < paths.size()) f = openIfExists(paths[next++]);
+        }
+        paths.clear();
+    };
+
+    const std::string hwmonDir = "/sys/class/hwmon";
+    for (const auto& hw : listNumbered(hwmonDir, "hwmon")) {
+        std::string dir = hwmonDir + "/" + hw.second;
+        std::string name = readSysText(dir + "/name");
+        if (name == "coretemp") {
+            for (const auto& t : listNumbered(dir, "temp")) {
+                std::string prefix = dir + "/temp" + std::to_string(t.first);
+                std::string label = readSysText(prefix + "_label");
+                if (label.compare(0, 11, "Package id ") != 0) continue;
+                int slot = slotOfPackage(atoi(label.c_str() + 11));
+                if (slot >= 0 && !packageTempFiles[slot]) packageTempFiles[slot] = openIfExists(prefix + "_input");
+            }
+        } else if (name == "k10temp" || name == "zenpower") {
+            ordered.push_back(dir + "/temp1_input");
+        }
     }
+    assignOrdered(ordered);
 
-    // 更新“上一次”的状态，以便下一次调用时对比
-    prevStats = currentStats;
+    const std::string thermalDir = "/sys/class/thermal";
+    for (const auto& z : listNumbered(thermalDir, "thermal_zone")) {
+        std::string dir = thermalDir + "/" + z.second;
+        if (readSysText(dir + "/type") == "x86_pkg_temp") ordered.push_back(dir + "/temp");
+    }
+    assignOrdered(ordered);
 
-    return usage;
+    bool any = false;
+    for (const auto& f : packageTempFiles) any = any || f;
+    if (!any && !packageTempFiles.empty()) {
+        packageTempFiles[0] = openIfExists(thermalDir + "/thermal_zone0/temp");
+    }
 }
 
 /**
- * @brief 获取 CPU 0 的当前频率
- * @details 读取 /sys/devices/system/cpu/cpu0/cpufreq/scaling_cur_freq
- * 注意：有些极简系统可能没有 cpufreq 驱动，通常 Ubuntu 桌面/服务器版都有。
- * * @return double 频率 (单位: MHz)
+ * @brief 内部辅助函数：读取 /proc/stat
+ * @details 读进预先分配的缓冲区后逐行手工解析 "cpu" 开头的行
  */
-double CpuMonitor::getCpuFrequency() {
-    double frequency = 0.0;
-    // 读取 CPU0 的频率作为参考。如果需要所有核心平均值，需要遍历 cpu0, cpu1...
-    std::ifstream file("/sys/devices/system/cpu/cpu0/cpufreq/scaling_cur_freq");
-    
-    if (file.is_open()) {
-        double freqKHz;
-        file >> freqKHz;
-        frequency = freqKHz / 1000.0; // 转换为 MHz
-        file.close();
-    } else {
-        // 备选方案：尝试从 /proc/cpuinfo 获取 (解析较为复杂，这里作为简单的错误处理)
-        // std::cerr << "[Warning] Cannot read cpu frequency from sysfs." << std::endl;
+template <typename Fn>
+bool CpuMonitor::readCpuStats(Fn&& fn) {
+    if (statBuf.empty()) statBuf.resize(kStatBytesPerCore * 2);
+    long len = statFile.readAll(statBuf.data(), statBuf.size());
+    if (len <= 0) return false;
+
+    const char* p = statBuf.data();
+    const char* end = p + len;
+    bool total = false;
+    // 格式: cpu[N]  user nice system idle iowait irq softirq steal guest guest_nice
+    while (end - p > 3 && memcmp(p, "cpu", 3) == 0) {
+        const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (!eol) break;   // 缓冲区截断在行中间
+        int id = -1;
+        const char* q = p + 3;
+        if (*q >= '0' && *q <= '9') {
+            unsigned long long n = 0;
+            q = ProcFile::scanU64(q, eol, n);
+            id = static_cast<int>(n);
+        }
+
+        CpuStats stats = {0};
+        unsigned long long* fields[] = {&stats.user, &stats.nice, &stats.system, &stats.idle,
+                                        &stats.iowait, &stats.irq, &stats.softirq, &stats.steal};
+        for (unsigned long long* f : fields) {
+            q = ProcFile::scanU64(q, eol, *f);
+            if (!q) break;   // 老内核没有 steal 等字段，其余保持 0
+        }
+        if (id < 0) total = true;
+        fn(id, stats);
+        p = eol + 1;
     }
+    return total;
+}
 
-    return frequency;
+/**
+ * @brief 采样并发布
+ * @details 读数写在快照总线的后台缓冲里，发布之间由总线串行，prevStats 因此不会被并发修改
+ */
+void CpuMonitor::sample() {
+    bus.publish([this](CpuStatus& next) { collect(next); });
 }
 
 /**
- * @brief 获取 CPU 温度
- * @details 读取 /sys/class/thermal/thermal_zone0/temp
- * 系统通常将 thermal_zone0 作为 ACPI CPU 热区。
- * 文件中的数值通常是千分之一摄氏度。
- * * @return double 温度 (单位: 摄氏度)
+ * @brief 一次读完整机与每核的数据，写进 next
+ * @details 核心数不变时各数组的大小不变，assign/resize 不会重新分配
  */
-double CpuMonitor::getCpuTemperature() {
-    double temperature = 0.0;
-    // thermal_zone0 通常是 CPU 或 x86_pkg_temp
-    std::ifstream file("/sys/class/thermal/thermal_zone0/temp");
-    
-    if (file.is_open()) {
-        double tempRaw;
-        file >> tempRaw;
-        temperature = tempRaw / 1000.0; // 转换为摄氏度
-        file.close();
-    } else {
-        // 如果读取失败（例如虚拟机环境可能没有温度传感器）
-        // std::cerr << "[Warning] Cannot read thermal zone." << std::endl;
-        temperature = -1.0; // 返回 -1 表示无法获取
+void CpuMonitor::collect(CpuStatus& next) {
+    size_t n = cpuIds.size();
+    next.cpuId = cpuIds;
+    next.nodeId = nodeIds;
+    next.packageId = packageIds;
+    next.packages = packages;
+    next.online.assign(n, 0);
+    for (auto* v : {&next.usage, &next.iowait, &next.irq, &next.softirq, &next.steal}) v->assign(n, 0.0f);
+
+    // 计数器回退 (CPU 下线又上线) 时按 0 处理
+    auto shares = [](const CpuStats& a, const CpuStats& b) {
+        auto d = [](unsigned long long x, unsigned long long y) { return y > x ? y - x : 0ull; };
+        unsigned long long user = d(a.user, b.user) + d(a.nice, b.nice);
+        unsigned long long idle = d(a.idle, b.idle);
+        unsigned long long io = d(a.iowait, b.iowait);
+        unsigned long long irq = d(a.irq, b.irq);
+        unsigned long long soft = d(a.softirq, b.softirq);
+        unsigned long long steal = d(a.steal, b.steal);
+        unsigned long long total = user + d(a.system, b.system) + idle + io + irq + soft + steal;
+        Shares s = {0, 0, 0, 0, 0};
+        if (total == 0) return s;   // 防止除以0
+        double k = 100.0 / total;
+        s.busy = (total - idle - io) * k;
+        s.iowait = io * k;
+        s.irq = irq * k;
+        s.softirq = soft * k;
+        s.steal = steal * k;
+        return s;
+    };
+
+    next.usagePercent = next.iowaitPercent = next.irqPercent = next.softirqPercent = next.stealPercent = 0;
+    readCpuStats([&](int id, const CpuStats& cur) {
+        if (id < 0) {
+            Shares s = shares(prevStats, cur);
+            prevStats = cur;
+            next.usagePercent = s.busy;
+            next.iowaitPercent = s.iowait;
+            next.irqPercent = s.irq;
+            next.softirqPercent = s.softirq;
+            next.stealPercent = s.steal;
+            return;
+        }
+        if (static_cast<size_t>(id) >= slotOf.size() || slotOf[id] < 0) return;
+        size_t i = static_cast<size_t>(slotOf[id]);
+        Shares s = shares(prevCore[i], cur);
+        prevCore[i] = cur;
+        next.online[i] = 1;
+        next.usage[i] = static_cast<float>(s.busy);
+        next.iowait[i] = static_cast<float>(s.iowait);
+        next.irq[i] = static_cast<float>(s.irq);
+        next.softirq[i] = static_cast<float>(s.softirq);
+        next.steal[i] = static_cast<float>(s.steal);
+    });
+
+    // 频率：cpufreq 的单位是 kHz
+    next.curMHz.resize(n);
+    next.minMHz.resize(n);
+    next.maxMHz.resize(n);
+    double freqSum = 0;
+    int freqCount = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const CoreFiles& f = coreFiles[i];
+        next.curMHz[i] = static_cast<float>(readScaled(f.cur.get(), 1000.0, 0.0));
+        next.minMHz[i] = static_cast<float>(readScaled(f.min.get(), 1000.0, 0.0));
+        next.maxMHz[i] = static_cast<float>(readScaled(f.max.get(), 1000.0, 0.0));
+        if (next.online[i] && next.curMHz[i] > 0) {
+            freqSum += next.curMHz[i];
+            freqCount++;
+        }
+    }
+    next.freqMHz = freqCount > 0 ? freqSum / freqCount : 0.0;
+
+    // 温度：hwmon 与 thermal 的单位都是千分之一摄氏度
+    next.packageTempC.resize(packages.size());
+    next.tempC = -1;
+    for (size_t j = 0; j < packages.size(); ++j) {
+        next.packageTempC[j] = static_cast<float>(readScaled(packageTempFiles[j].get(), 1000.0, -1.0));
+        next.tempC = std::max(next.tempC, static_cast<double>(next.packageTempC[j]));
+    }
+}
+
+// ==========================================
+
+double CpuStatus::packageTemp(int package) const {
+    auto it = std::lower_bound(packages.begin(), packages.end(), package);
+    if (it == packages.end() || *it != package) return -1;
+    return packageTempC[it - packages.begin()];
+}
+
+CpuStatus::CoreView CpuStatus::core(size_t i) const {
+    CoreView v;
+    v.cpu = cpuId[i];
+    v.node = nodeId[i];
+    v.package = packageId[i];
+    v.online = online[i] != 0;
+    v.usage = usage[i];
+    v.iowait = iowait[i];
+    v.irq = irq[i];
+    v.softirq = softirq[i];
+    v.steal = steal[i];
+    v.curMHz = curMHz[i];
+    v.minMHz = minMHz[i];
+    v.maxMHz = maxMHz[i];
+    v.tempC = packageTemp(packageId[i]);
+    return v;
+}
+
+std::vector<CpuStatus::NodeView> CpuStatus::nodes() const {
+    std::vector<NodeView> out;
+    for (size_t i = 0; i < coreCount(); ++i) {
+        if (!online[i]) continue;
+        auto it = std::find_if(out.begin(), out.end(), [&](const NodeView& v) { return v.node == nodeId[i]; });
+        if (it == out.end()) {
+            out.push_back(NodeView{nodeId[i], 0, 0, 0, 0, 0});
+            it = out.end() - 1;
+        }
+        it->cores++;
+        it->usagePercent += usage[i];
+        it->maxUsagePercent = std::max(it->maxUsagePercent, static_cast<double>(usage[i]));
+        it->stealPercent += steal[i];
+        it->freqMHz += curMHz[i];
+    }
+    for (auto& v : out) {
+        v.usagePercent /= v.cores;
+        v.stealPercent /= v.cores;
+        v.freqMHz /= v.cores;
     }
+    std::sort(out.begin(), out.end(), [](const NodeView& a, const NodeView& b) { return a.node < b.node; });
+    return out;
+}
+
+std::vector<size_t> CpuStatus::mostLoaded(size_t k) const {
+    std::vector<size_t> order;
+    for (size_t i = 0; i < coreCount(); ++i) {
+        if (online[i]) order.push_back(i);
+    }
+    k = std::min(k, order.size());
+    std::partial_sort(order.begin(), order.begin() + k, order.end(), [this](size_t a, size_t b) {
+        return usage[a] != usage[b] ? usage[a] > usage[b] : cpuId[a] < cpuId[b];
+    });
+    order.resize(k);
+    return order;
+}
 
-    return temperature;
-}
\ No newline at end of file
+int CpuStatus::hottest() const {
+    int best = -1;
+    double bestTemp = -1;
+    for (size_t i = 0; i < coreCount(); ++i) {
+        if (!online[i]) continue;
+        double t = packageTemp(packageId[i]);
+        if (t < 0) continue;
+        if (best < 0 || t > bestTemp || (t == bestTemp && usage[i] > usage[best])) {
+            best = static_cast<int>(i);
+            bestTemp = t;
+        }
+    }
+    return best;
+}
@@ -1,7 +1,10 @@
 /**
  * @file cpu_monitor.h
  * @brief CPU 监控模块头文件
- * @details 负责定义获取 CPU 负载、频率和温度的接口
+ * @details 负责定义获取 CPU 负载、频率和温度的接口。
+ *          一次采样读完 /proc/stat 的全部 cpuN 行、每个核心的 cpufreq 和每个封装的温度，
+ *          写成结构数组 (SoA) 形式的快照：同一个下标在各个每核数组里指同一个逻辑 CPU。
+ *          64 核机器上单核跑满在整机平均里只有 1.5%，所以提速和绑核的判断都应该看每核视图。
  */
 
 #ifndef CPU_MONITOR_H
@@ -9,13 +12,91 @@
 
 #include <string>
 #include <vector>
-#include <fstream>
+#include <memory>
+#include "core/proc_file.h"
+#include "core/snapshot_bus.h"
+
+// 一次 CPU 采样的读数 (占用率都是上一个采样区间的值，单位 %)
+struct CpuStatus {
+    // === 整机 ===
+    double usagePercent = 0;   // 非空闲 (不含 iowait) 占比
+    double iowaitPercent = 0;
+    double irqPercent = 0;
+    double softirqPercent = 0;
+    double stealPercent = 0;   // 虚拟机被宿主机拿走的时间
+    double freqMHz = 0;        // 各核当前频率的平均值，没有 cpufreq 时为 0
+    double tempC = -1;         // 最热封装的温度，读不到时为 -1
+
+    // === 每核 (结构数组，长度都等于 coreCount()) ===
+    std::vector<int> cpuId;             // 逻辑 CPU 编号 (cpuN 的 N)
+    std::vector<int> nodeId;            // NUMA 节点，没有 NUMA 信息时为 0
+    std::vector<int> packageId;         // 物理封装
+    std::vector<unsigned char> online;  // 本次采样 /proc/stat 里有这个核
+    std::vector<float> usage;
+    std::vector<float> iowait;
+    std::vector<float> irq;
+    std::vector<float> softirq;
+    std::vector<float> steal;
+    std::vector<float> curMHz;          // 0 表示没有 cpufreq
+    std::vector<float> minMHz;
+    std::vector<float> maxMHz;
+
+    // === 每封装 ===
+    std::vector<int> packages;          // 封装编号，升序
+    std::vector<float> packageTempC;    // 与 packages 对应，-1 表示读不到
+
+    // 单个核心的全部读数
+    struct CoreView {
+        int cpu;
+        int node;
+        int package;
+        bool online;
+        double usage, iowait, irq, softirq, steal;
+        double curMHz, minMHz, maxMHz;
+        double tempC;                   // 所在封装的温度
+    };
+
+    // 一个 NUMA 节点的汇总
+    struct NodeView {
+        int node;
+        int cores;                      // 在线核心数
+        double usagePercent;            // 平均
+        double maxUsagePercent;         // 最忙的核心
+        double stealPercent;
+        double freqMHz;                 // 平均当前频率
+    };
+
+    size_t coreCount() const { return cpuId.size(); }
+    CoreView core(size_t i) const;
+
+    /**
+     * @brief 按 NUMA 节点汇总，节点编号升序
+     */
+    std::vector<NodeView> nodes() const;
+
+    /**
+     * @brief 占用率最高的 k 个在线核心 (下标)，从高到低
+     */
+    std::vector<size_t> mostLoaded(size_t k) const;
+
+    /**
+     * @brief 最热的在线核心 (下标)
+     * @details 温度只精确到封装，同一封装内取占用率最高的核心；没有任何温度数据返回 -1
+     */
+    int hottest() const;
+
+    /**
+     * @brief 封装温度，读不到返回 -1
+     */
+    double packageTemp(int package) const;
+};
 
 class CpuMonitor {
 public:
     /**
      * @brief 构造函数
-     * @details 初始化 CPU 监控器，读取初始状态
+     * @details 识别在线核心的拓扑 (NUMA 节点、封装)，打开各核 cpufreq 与各封装温度文件，
+     *          读取初始状态作为计算占用率的基准
      */
     CpuMonitor();
 
@@ -25,25 +106,16 @@ public:
     ~CpuMonitor();
 
     /**
-     * @brief 获取系统整体 CPU 占用率 (百分比)
-     * @details 通过对比 /proc/stat 的两次快照计算瞬间使用率
-     * @return double CPU 使用率 (0.0 - 100.0)
+     * @brief 采一次整机和每核的占用率、频率与温度，发布为新快照
+     * @details 由后台采样线程周期性调用，占用率是相邻两次 sample() 之间的区间值。
+     *          核心数不变时快照里的数组原地复用，不做堆分配
      */
-    double getSystemCpuUsage();
+    void sample();
 
     /**
-     * @brief 获取当前 CPU 频率
-     * @details 读取 /sys/devices/system/cpu/cpu0/cpufreq/scaling_cur_freq
-     * @return double 频率 (单位: MHz)
+     * @brief 最新的 CPU 快照 (无锁，不触发新的读取)
      */
-    double getCpuFrequency();
-
-    /**
-     * @brief 获取 CPU 温度
-     * @details 读取 /sys/class/thermal/thermal_zone0/temp
-     * @return double 温度 (单位: 摄氏度)
-     */
-    double getCpuTemperature();
+    SnapshotBus<CpuStatus>::Reader snapshot() const { return bus.read(); }
 
 private:
     // 用于计算 CPU 使用率的结构体
@@ -58,13 +130,42 @@ private:
         unsigned long long steal;
     };
 
-    CpuStats prevStats; // 上一次读取的 CPU 统计数据
+    // 每个核心常开的 cpufreq 文件 (没有 cpufreq 时未打开)
+    struct CoreFiles {
+        std::unique_ptr<ProcFile> cur;
+        std::unique_ptr<ProcFile> min;
+        std::unique_ptr<ProcFile> max;
+    };
+
+    CpuStats prevStats;                  // 上一次读取的整机统计数据
+    std::vector<CpuStats> prevCore;      // 上一次读取的每核统计数据
+    std::vector<int> slotOf;             // 逻辑 CPU 编号 -> 下标，-1 表示启动时不在线
+
+    // 拓扑在构造时确定，每次采样原样写进快照
+    std::vector<int> cpuIds;
+    std::vector<int> nodeIds;
+    std::vector<int> packageIds;
+    std::vector<int> packages;
+
+    // 常开的文件，每次采样用 pread 重读，不再重复 open 和构造流对象
+    ProcFile statFile;
+    std::vector<CoreFiles> coreFiles;
+    std::vector<std::unique_ptr<ProcFile>> packageTempFiles;   // 与 packages 对应，可能为空
+    std::vector<char> statBuf;           // 按核心数分配一次，容纳全部 cpuN 行
+
+    SnapshotBus<CpuStatus> bus;
 
     /**
-     * @brief 从 /proc/stat 读取当前 CPU 原始数据
-     * @return CpuStats 包含各状态的时间片数值
+     * @brief 读取 /proc/stat 并逐行解析 cpu / cpuN 行
+     * @details 对每一行回调 fn(cpuId, stats)，整机行的 cpuId 为 -1；不做堆分配
+     * @return 是否读到了整机行
      */
-    CpuStats readCpuStats();
+    template <typename Fn>
+    bool readCpuStats(Fn&& fn);
+
+    void discoverTopology();
+    void openThermalSources();
+    void collect(CpuStatus& next);
 };
 
-#endif // CPU_MONITOR_H
\ No newline at end of file
+#endif // CPU_MONITOR_H
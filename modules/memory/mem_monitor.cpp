@@ -5,54 +5,98 @@
 
 #include "modules/memory/mem_monitor.h"
 #include <iostream>
-#include <fstream>
-#include <sstream>
-#include <map>
+#include <cstddef>
+#include <cstring>
 
-MemMonitor::MemMonitor() {}
+namespace {
+
+// /proc/meminfo 中用到的字段 (单位 kB)
+struct MemInfoRaw {
+    unsigned long long memTotal;
+    unsigned long long memFree;
+    unsigned long long memAvailable;
+    unsigned long long buffers;
+    unsigned long long cached;
+    unsigned long long swapTotal;
+    unsigned long long swapFree;
+};
+
+struct MemInfoKey {
+    const char* key;     // 含冒号，保证整键匹配而不是前缀匹配
+    size_t len;
+    size_t offset;       // 在 MemInfoRaw 中的偏移
+};
+
+#define MEMINFO_KEY(name, field) {name ":", sizeof(name ":") - 1, offsetof(MemInfoRaw, field)}
+
+constexpr MemInfoKey kMemInfoKeys[] = {
+    MEMINFO_KEY("MemTotal", memTotal),
+    MEMINFO_KEY("MemFree", memFree),
+    MEMINFO_KEY("MemAvailable", memAvailable),
+    MEMINFO_KEY("Buffers", buffers),
+    MEMINFO_KEY("Cached", cached),
+    MEMINFO_KEY("SwapTotal", swapTotal),
+    MEMINFO_KEY("SwapFree", swapFree),
+};
+
+#undef MEMINFO_KEY
+
+constexpr size_t kMemInfoKeyCount = sizeof(kMemInfoKeys) / sizeof(kMemInfoKeys[0]);
+
+// 目前的 meminfo 约 1.5KB
+const size_t kMemInfoBufSize = 4096;
+
+// 逐行匹配表中的键，全部找到就提前结束；返回找到的个数
+size_t parseMemInfo(const char* buf, size_t len, MemInfoRaw& raw) {
+    const char* p = buf;
+    const char* end = buf + len;
+    size_t found = 0;
+    while (p < end && found < kMemInfoKeyCount) {
+        const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (!eol) eol = end;
+        for (const MemInfoKey& k : kMemInfoKeys) {
+            if (static_cast<size_t>(eol - p) > k.len && memcmp(p, k.key, k.len) == 0) {
+                unsigned long long* field = reinterpret_cast<unsigned long long*>(
+                    reinterpret_cast<char*>(&raw) + k.offset);
+                if (ProcFile::scanU64(p + k.len, eol, *field)) found++;
+                break;
+            }
+        }
+        p = eol + 1;
+    }
+    return found;
+}
+
+} // namespace
+
+MemMonitor::MemMonitor() : meminfo("/proc/meminfo") {
+    if (!meminfo.isOpen()) std::cerr << "[Error] Cannot open /proc/meminfo" << std::endl;
+    sample();
+}
 MemMonitor::~MemMonitor() {}
 
+void MemMonitor::sample() {
+    bus.publish([this](MemoryStatus& next) { next = getMemoryStatus(); });
+}
+
 MemoryStatus MemMonitor::getMemoryStatus() {
     MemoryStatus status = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
-    std::ifstream file("/proc/meminfo");
-    
-    if (!file.is_open()) {
-        std::cerr << "[Error] Cannot open /proc/meminfo" << std::endl;
-        return status;
-    }
+    char buf[kMemInfoBufSize];
+    long len = meminfo.readAll(buf, sizeof(buf));
+    if (len <= 0) return status;
 
-    std::string line, key;
-    double value;
-    std::string unit;
-    
-    // 使用 map 暂存读取到的关键值 (单位 kB)
-    std::map<std::string, double> memInfo;
-
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        // 读取格式例如: "MemTotal:        16303284 kB"
-        iss >> key >> value >> unit;
-        
-        // 去掉冒号
-        if (!key.empty() && key.back() == ':') {
-            key.pop_back();
-        }
-        memInfo[key] = value;
-    }
-    file.close();
+    // 找不到的键保持 0，比较安全
+    MemInfoRaw raw = {};
+    parseMemInfo(buf, static_cast<size_t>(len), raw);
 
-    // 提取我们需要的数据 (注意 map 如果找不到key会返回0，比较安全)
-    double memTotal = memInfo["MemTotal"];
-    double memAvailable = memInfo["MemAvailable"]; // 新版Linux通常用这个
-    double memFree = memInfo["MemFree"];
-    double buffers = memInfo["Buffers"];
-    double cached = memInfo["Cached"];
-    double swapTotal = memInfo["SwapTotal"];
-    double swapFree = memInfo["SwapFree"];
+    double memTotal = static_cast<double>(raw.memTotal);
+    double memAvailable = static_cast<double>(raw.memAvailable); // 新版Linux通常用这个
+    double swapTotal = static_cast<double>(raw.swapTotal);
+    double swapFree = static_cast<double>(raw.swapFree);
 
     // 如果系统老旧没有 MemAvailable，手动计算: Free + Buffers + Cached
     if (memAvailable == 0) {
-        memAvailable = memFree + buffers + cached;
+        memAvailable = static_cast<double>(raw.memFree + raw.buffers + raw.cached);
     }
 
     // 计算结果 (转换为 MB)
@@ -68,4 +112,4 @@ MemoryStatus MemMonitor::getMemoryStatus() {
     status.swapUsedMB = (swapTotal - swapFree) / 1024.0;
 
     return status;
-}
\ No newline at end of file
+}
@@ -7,6 +7,8 @@
 #define MEM_MONITOR_H
 
 #include <string>
+#include "core/proc_file.h"
+#include "core/snapshot_bus.h"
 
 // 定义一个结构体，用来一次性返回所有内存状态
 struct MemoryStatus {
@@ -26,9 +28,26 @@ public:
 
     /**
      * @brief 获取当前系统内存详细状态
+     * @details pread 常开的 /proc/meminfo 到栈缓冲区，按编译期的 键 -> 字段偏移 表取出所需的行，
+     *          不做堆分配
      * @return MemoryStatus 结构体
      */
     MemoryStatus getMemoryStatus();
+
+    /**
+     * @brief 读一次 /proc/meminfo 并发布为新快照
+     * @details 由后台采样线程周期性调用；清理缓存之后也会立即调用一次
+     */
+    void sample();
+
+    /**
+     * @brief 最新的内存快照 (无锁，不触发新的读取)
+     */
+    SnapshotBus<MemoryStatus>::Reader snapshot() const { return bus.read(); }
+
+private:
+    ProcFile meminfo;
+    SnapshotBus<MemoryStatus> bus;
 };
 
 #endif // MEM_MONITOR_H
\ No newline at end of file
@@ -0,0 +1,275 @@
+/**
+ * @file psi_monitor.cpp
+ * @brief 压力停顿 (PSI) 监控模块实现
+ */
+
+#include "modules/pressure/psi_monitor.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+namespace {
+
+// 取 "key=数值" 的数值，找不到时不改 value
+void scanField(const char* line, const char* end, const char* key, double& value) {
+    size_t keyLen = strlen(key);
+    for (const char* p = line; p + keyLen < end; ++p) {
+        if (memcmp(p, key, keyLen) == 0) {
+            value = strtod(p + keyLen, nullptr);
+            return;
+        }
+    }
+}
+
+// 解析整个 pressure 文件：
+//   some avg10=0.00 avg60=0.00 avg300=0.00 total=0
+//   full avg10=0.00 avg60=0.00 avg300=0.00 total=0
+void parsePressure(const char* buf, long len, PsiResource& out) {
+    const char* p = buf;
+    const char* end = buf + len;
+    while (p < end) {
+        const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (!eol) eol = end;
+        PsiLine* line = nullptr;
+        if (eol - p > 4 && memcmp(p, "some", 4) == 0) line = &out.some;
+        else if (eol - p > 4 && memcmp(p, "full", 4) == 0) line = &out.full;
+        if (line) {
+            scanField(p, eol, "avg10=", line->avg10);
+            scanField(p, eol, "avg60=", line->avg60);
+            scanField(p, eol, "avg300=", line->avg300);
+            const char* total = strstr(p, "total=");
+            if (total && total < eol) ProcFile::scanU64(total + 6, eol, line->totalUs);
+        }
+        p = eol + 1;
+    }
+}
+
+// 微秒写成 "150ms" / "2s" 这样的短形式
+std::string shortDuration(int us) {
+    if (us % 1000000 == 0) return std::to_string(us / 1000000) + "s";
+    return std::to_string(us / 1000) + "ms";
+}
+
+const int kUnprivilegedWindowUs = 2000000;   // 非特权触发器的窗口必须是它的整数倍
+
+} // namespace
+
+std::string PsiTrigger::describe() const {
+    std::string text = (cgroup.empty() ? "" : cgroup + " ") + resource + (full ? " full " : " some ");
+    return text + shortDuration(stallUs) + "/" + shortDuration(windowUs);
+}
+
+PsiMonitor::PsiMonitor()
+    : cpuFile("/proc/pressure/cpu"), memoryFile("/proc/pressure/memory"), ioFile("/proc/pressure/io"),
+      epollFd(-1), wakeFd(-1), running(false) {
+    // cgroup v2 挂载点：mountinfo 里 " - " 之后文件系统类型为 cgroup2 的那一行，第 5 列是挂载点
+    std::ifstream mounts("/proc/self/mountinfo");
+    std::string line;
+    while (cgroupRoot.empty() && std::getline(mounts, line)) {
+        size_t sep = line.find(" - ");
+        if (sep == std::string::npos || line.compare(sep + 3, 8, "cgroup2 ") != 0) continue;
+        std::istringstream fields(line.substr(0, sep));
+        std::string field;
+        for (int i = 0; i < 5 && fields >> field; ++i) {}
+        cgroupRoot = field;
+    }
+    std::ifstream own("/proc/self/cgroup");
+    while (std::getline(own, line)) {
+        if (line.compare(0, 3, "0::") == 0) ownCgroup = line.substr(3);
+    }
+}
+
+PsiMonitor::~PsiMonitor() {
+    stop();
+}
+
+bool PsiMonitor::readResource(const ProcFile& file, PsiResource& out) {
+    char buf[256];
+    long len = file.readAll(buf, sizeof(buf));
+    if (len <= 0) return false;
+    parsePressure(buf, len, out);
+    return true;
+}
+
+bool PsiMonitor::readStatus(const std::string& dir, PsiStatus& out) {
+    bool cpu = readResource(ProcFile((dir + "/cpu.pressure").c_str()), out.cpu);
+    bool memory = readResource(ProcFile((dir + "/memory.pressure").c_str()), out.memory);
+    bool io = readResource(ProcFile((dir + "/io.pressure").c_str()), out.io);
+    out.available = cpu || memory || io;
+    return out.available;
+}
+
+PsiStatus PsiMonitor::read() const {
+    PsiStatus status;
+    bool cpu = readResource(cpuFile, status.cpu);
+    bool memory = readResource(memoryFile, status.memory);
+    bool io = readResource(ioFile, status.io);
+    status.available = cpu || memory || io;
+    return status;
+}
+
+std::vector<CgroupPressure> PsiMonitor::readCgroups() const {
+    std::vector<CgroupPressure> result;
+    if (cgroupRoot.empty()) return result;
+
+    std::vector<std::string> paths;
+    if (DIR* dir = opendir(cgroupRoot.c_str())) {
+        while (struct dirent* e = readdir(dir)) {
+            if (e->d_type != DT_DIR || e->d_name[0] == '.') continue;
+            paths.push_back(std::string("/") + e->d_name);
+        }
+        closedir(dir);
+    }
+    // 根组的压力就是系统级压力，不重复列出
+    if (!ownCgroup.empty() && ownCgroup != "/" &&
+        std::find(paths.begin(), paths.end(), ownCgroup) == paths.end()) {
+        paths.push_back(ownCgroup);
+    }
+
+    for (const auto& path : paths) {
+        CgroupPressure cg;
+        cg.path = path;
+        if (readStatus(cgroupRoot + path, cg.status)) result.push_back(std::move(cg));
+    }
+    auto worst = [](const PsiStatus& s) {
+        return std::max(s.cpu.some.avg10, std::max(s.memory.some.avg10, s.io.some.avg10));
+    };
+    std::sort(result.begin(), result.end(), [&](const CgroupPressure& a, const CgroupPressure& b) {
+        return worst(a.status) > worst(b.status);
+    });
+    return result;
+}
+
+std::string PsiMonitor::pressurePath(const PsiTrigger& t) const {
+    if (t.cgroup.empty()) return "/proc/pressure/" + t.resource;
+    if (cgroupRoot.empty()) return "";
+    return cgroupRoot + t.cgroup + "/" + t.resource + ".pressure";
+}
+
+int PsiMonitor::arm(PsiTrigger& t) {
+    std::string path = pressurePath(t);
+    if (path.empty() || t.windowUs <= 0 || t.stallUs <= 0) return -1;
+    int fd = open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) return -1;
+
+    for (;;) {
+        char spec[64];
+        int len = snprintf(spec, sizeof(spec), "%s %d %d", t.full ? "full" : "some", t.stallUs, t.windowUs);
+        // 内核要求连同结尾的 '\0' 一起写入
+        if (write(fd, spec, len + 1) >= 0) return fd;
+        // 没有 CAP_SYS_RESOURCE 时窗口必须是 2 秒的整数倍，按比例放大后再试一次
+        if ((errno == EINVAL || errno == EPERM) && t.windowUs % kUnprivilegedWindowUs != 0) {
+            int window = (t.windowUs / kUnprivilegedWindowUs + 1) * kUnprivilegedWindowUs;
+            t.stallUs = static_cast<int>(static_cast<long long>(t.stallUs) * window / t.windowUs);
+            t.windowUs = window;
+            continue;
+        }
+        std::cerr << "[Error] PSI 触发器 " << t.describe() << " 注册失败: " << strerror(errno) << std::endl;
+        close(fd);
+        return -1;
+    }
+}
+
+int PsiMonitor::start(const std::vector<PsiTrigger>& triggers, Handler onTrigger) {
+    std::lock_guard<std::mutex> g(armedLock);
+    if (running) return static_cast<int>(armed.size());
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (epollFd < 0 || wakeFd < 0) {
+        if (epollFd >= 0) close(epollFd);
+        if (wakeFd >= 0) close(wakeFd);
+        epollFd = wakeFd = -1;
+        return 0;
+    }
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr;   // 空指针表示 wakeFd
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+
+    for (const auto& t : triggers) {
+        std::unique_ptr<Armed> a(new Armed);
+        a->trigger = t;
+        a->fired = 0;
+        a->fd = arm(a->trigger);
+        if (a->fd < 0) continue;
+        ev.events = EPOLLPRI;
+        ev.data.ptr = a.get();
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, a->fd, &ev) != 0) {
+            close(a->fd);
+            continue;
+        }
+        armed.push_back(std::move(a));
+    }
+
+    if (armed.empty()) {
+        close(epollFd);
+        close(wakeFd);
+        epollFd = wakeFd = -1;
+        return 0;
+    }
+    handler = std::move(onTrigger);
+    running = true;
+    worker = std::thread(&PsiMonitor::listenLoop, this);
+    return static_cast<int>(armed.size());
+}
+
+void PsiMonitor::stop() {
+    if (running) {
+        running = false;
+        unsigned long long one = 1;
+        if (write(wakeFd, &one, sizeof(one)) < 0) {}
+    }
+    if (worker.joinable()) worker.join();
+
+    std::lock_guard<std::mutex> g(armedLock);
+    for (const auto& a : armed) close(a->fd);   // 关闭 fd 即注销触发器
+    armed.clear();
+    if (epollFd >= 0) close(epollFd);
+    if (wakeFd >= 0) close(wakeFd);
+    epollFd = wakeFd = -1;
+}
+
+std::vector<std::pair<PsiTrigger, unsigned long long>> PsiMonitor::triggerStatus() const {
+    std::vector<std::pair<PsiTrigger, unsigned long long>> result;
+    std::lock_guard<std::mutex> g(armedLock);
+    for (const auto& a : armed) result.emplace_back(a->trigger, a->fired.load());
+    return result;
+}
+
+void PsiMonitor::listenLoop() {
+    struct epoll_event events[8];
+    while (running) {
+        int n = epoll_wait(epollFd, events, 8, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "[Error] PSI epoll_wait: " << strerror(errno) << std::endl;
+            running = false;   // 触发器不会再送达，isActive() 如实反映
+            return;
+        }
+        for (int i = 0; i < n && running; ++i) {
+            Armed* a = static_cast<Armed*>(events[i].data.ptr);
+            if (!a) continue;  // stop() 的唤醒
+            if (events[i].events & EPOLLERR) {
+                // 被监视的 cgroup 已删除，这个触发器不会再有事件
+                epoll_ctl(epollFd, EPOLL_CTL_DEL, a->fd, nullptr);
+                continue;
+            }
+            if (events[i].events & EPOLLPRI) {
+                a->fired++;
+                handler(a->trigger, read());
+            }
+        }
+    }
+}
@@ -0,0 +1,147 @@
+/**
+ * @file psi_monitor.h
+ * @brief 压力停顿 (PSI) 监控模块头文件
+ * @details CPU 占用率和内存占用率只说明资源用了多少，不说明任务有没有在排队等它：
+ *          占用 100% 的批处理机器可能一切正常，占用 60% 的机器也可能在频繁回收内存而卡顿。
+ *          PSI 直接给出"有任务因缺某种资源而停顿"的时间占比：
+ *          - some：至少一个任务在等；full：全部非空闲任务都在等 (这段时间机器完全白耗)
+ *          - 系统级读 /proc/pressure/{cpu,memory,io}，cgroup v2 读各组的 *.pressure
+ *          触发器：往 pressure 文件写 "some 150000 1000000" (窗口 1 秒内停顿超过 150 毫秒)，
+ *          内核在越过阈值时让这个 fd 变成可读 (EPOLLPRI)。监听线程平时阻塞在 epoll 上，
+ *          系统健康时不读任何文件、不占 CPU；出问题时在一个窗口内被唤醒。
+ *          非特权进程只能注册 2 秒整数倍的窗口，注册被拒时按比例放大窗口和阈值重试。
+ */
+
+#ifndef PSI_MONITOR_H
+#define PSI_MONITOR_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/proc_file.h"
+
+// pressure 文件里的一行 (some 或 full)
+struct PsiLine {
+    double avg10 = 0;              // 最近 10 / 60 / 300 秒的停顿时间占比 (%)
+    double avg60 = 0;
+    double avg300 = 0;
+    unsigned long long totalUs = 0;   // 累计停顿时间 (微秒)
+};
+
+struct PsiResource {
+    PsiLine some;
+    PsiLine full;                  // 老内核的 cpu 没有 full 行，保持全 0
+};
+
+struct PsiStatus {
+    bool available = false;        // 内核是否提供 PSI (CONFIG_PSI 且未被 psi=0 关闭)
+    PsiResource cpu;
+    PsiResource memory;
+    PsiResource io;
+};
+
+// 一个 cgroup 的压力
+struct CgroupPressure {
+    std::string path;              // 相对 cgroup v2 根的路径，如 "/system.slice"
+    PsiStatus status;
+};
+
+// 内核 PSI 触发器
+struct PsiTrigger {
+    std::string resource;          // "cpu" / "memory" / "io"
+    bool full = false;             // false 看 some，true 看 full
+    int stallUs = 0;               // 一个窗口内的停顿超过这么多就触发
+    int windowUs = 0;              // 窗口长度 (500 毫秒 ~ 10 秒)
+    std::string cgroup;            // 为空是系统级，否则是相对 cgroup v2 根的路径
+
+    /**
+     * @brief 形如 "memory some 150ms/1s" 的说明
+     */
+    std::string describe() const;
+};
+
+class PsiMonitor {
+public:
+    // 在监听线程上回调：越过阈值的触发器和当时的系统级读数
+    using Handler = std::function<void(const PsiTrigger&, const PsiStatus&)>;
+
+    /**
+     * @brief 构造函数
+     * @details 常开三个系统级 pressure 文件并找到 cgroup v2 的挂载点
+     */
+    PsiMonitor();
+
+    /**
+     * @brief 析构函数，停止监听线程
+     */
+    ~PsiMonitor();
+
+    PsiMonitor(const PsiMonitor&) = delete;
+    PsiMonitor& operator=(const PsiMonitor&) = delete;
+
+    bool isAvailable() const { return cpuFile.isOpen() || memoryFile.isOpen() || ioFile.isOpen(); }
+
+    /**
+     * @brief 读一次系统级压力 (pread 常开的文件，可在任意线程调用)
+     */
+    PsiStatus read() const;
+
+    /**
+     * @brief 读 cgroup v2 根下一级子组和本进程所在组的压力，按内存 some avg10 从高到低
+     * @details 按需打开文件，只在查询时调用；没有 cgroup v2 时返回空
+     */
+    std::vector<CgroupPressure> readCgroups() const;
+
+    /**
+     * @brief 注册触发器并启动监听线程
+     * @details 单个触发器注册失败 (如 cgroup 不存在) 只跳过它
+     * @return 实际生效的触发器个数；为 0 时没有启动线程，调用方应回退到定时轮询
+     */
+    int start(const std::vector<PsiTrigger>& triggers, Handler handler);
+
+    /**
+     * @brief 停止监听线程并注销全部触发器 (关闭 fd 即注销)
+     */
+    void stop();
+
+    bool isActive() const { return running; }
+
+    /**
+     * @brief 实际生效的触发器 (窗口可能已被放大)，以及各自触发过的次数
+     */
+    std::vector<std::pair<PsiTrigger, unsigned long long>> triggerStatus() const;
+
+private:
+    struct Armed {
+        PsiTrigger trigger;
+        int fd;
+        std::atomic<unsigned long long> fired;
+    };
+
+    ProcFile cpuFile;
+    ProcFile memoryFile;
+    ProcFile ioFile;
+    std::string cgroupRoot;        // cgroup v2 挂载点，没有时为空
+    std::string ownCgroup;         // 本进程所在的组 (/proc/self/cgroup 的 "0::" 行)
+
+    mutable std::mutex armedLock;  // 保护 armed 列表本身 (start/stop 与状态查询)
+    std::vector<std::unique_ptr<Armed>> armed;
+    Handler handler;
+    int epollFd;
+    int wakeFd;
+    std::atomic<bool> running;
+    std::thread worker;
+
+    std::string pressurePath(const PsiTrigger& t) const;
+    int arm(PsiTrigger& t);
+    void listenLoop();
+
+    static bool readResource(const ProcFile& file, PsiResource& out);
+    static bool readStatus(const std::string& dir, PsiStatus& out);
+};
+
+#endif // PSI_MONITOR_H
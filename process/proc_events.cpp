@@ -0,0 +1,190 @@
+/**
+ * @file proc_events.cpp
+ * @brief 进程事件监听实现
+ */
+
+#include "process/proc_events.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/connector.h>
+#include <linux/cn_proc.h>
+
+ProcEventListener::ProcEventListener(size_t cap)
+    : sockFd(-1), wakeFd(-1), capacity(cap), running(false), dropped(0) {}
+
+ProcEventListener::~ProcEventListener() {
+    stop();
+}
+
+bool ProcEventListener::subscribe(bool enable) {
+    // nlmsghdr + cn_msg + 操作码，按 netlink 对齐打包在一个缓冲区里
+    alignas(struct nlmsghdr) char buf[NLMSG_SPACE(sizeof(struct cn_msg) + sizeof(int))];
+    memset(buf, 0, sizeof(buf));
+
+    struct nlmsghdr* nl = reinterpret_cast<struct nlmsghdr*>(buf);
+    nl->nlmsg_len = NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(int));
+    nl->nlmsg_type = NLMSG_DONE;
+    nl->nlmsg_pid = 0;
+
+    struct cn_msg* cn = reinterpret_cast<struct cn_msg*>(NLMSG_DATA(nl));
+    cn->id.idx = CN_IDX_PROC;
+    cn->id.val = CN_VAL_PROC;
+    cn->len = sizeof(int);
+    int op = enable ? PROC_CN_MCAST_LISTEN : PROC_CN_MCAST_IGNORE;
+    memcpy(cn->data, &op, sizeof(op));
+
+    return send(sockFd, nl, nl->nlmsg_len, 0) >= 0;
+}
+
+bool ProcEventListener::start() {
+    if (running) return true;
+
+    sockFd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+    if (sockFd < 0) return false;
+
+    struct sockaddr_nl addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = CN_IDX_PROC;
+    addr.nl_pid = 0;  // 由内核分配
+    if (bind(sockFd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0 || !subscribe(true)) {
+        // 非 root 通常在这里失败 (EPERM)
+        close(sockFd);
+        sockFd = -1;
+        return false;
+    }
+
+    wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wakeFd < 0) {
+        close(sockFd);
+        sockFd = -1;
+        return false;
+    }
+
+    ownDescendants.clear();
+    ownDescendants.insert(getpid());
+    running = true;
+    worker = std::thread(&ProcEventListener::listenLoop, this);
+    return true;
+}
+
+void ProcEventListener::stop() {
+    if (running) {
+        running = false;
+        unsigned long long one = 1;
+        if (write(wakeFd, &one, sizeof(one)) < 0) {}
+    }
+    if (worker.joinable()) worker.join();
+
+    if (sockFd >= 0) {
+        subscribe(false);
+        close(sockFd);
+        sockFd = -1;
+    }
+    if (wakeFd >= 0) {
+        close(wakeFd);
+        wakeFd = -1;
+    }
+}
+
+void ProcEventListener::push(ProcEvent&& ev) {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (queue.size() >= capacity) {
+        queue.pop_front();
+        dropped++;
+    }
+    queue.push_back(std::move(ev));
+}
+
+std::vector<ProcEvent> ProcEventListener::drain() {
+    std::vector<ProcEvent> out;
+    std::lock_guard<std::mutex> lock(queueMutex);
+    out.reserve(queue.size());
+    for (auto& ev : queue) out.push_back(std::move(ev));
+    queue.clear();
+    return out;
+}
+
+// 读取 comm；进程已退出时返回 "unknown"
+static std::string readComm(int pid) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/comm", pid);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return "unknown";
+    char buf[64];
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) return "unknown";
+    if (buf[n - 1] == '\n') n--;
+    return std::string(buf, n);
+}
+
+void ProcEventListener::listenLoop() {
+    alignas(struct nlmsghdr) char buf[8192];
+    struct pollfd fds[2];
+    fds[0].fd = sockFd;
+    fds[0].events = POLLIN;
+    fds[1].fd = wakeFd;
+    fds[1].events = POLLIN;
+
+    while (running) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            // 其他错误重试也还是错，不能空转；标记为不活动，查询退回扫描 /proc
+            std::cerr << "[Error] 进程事件 poll: " << strerror(errno) << std::endl;
+            running = false;
+            return;
+        }
+        if (fds[1].revents & POLLIN) break;
+        if (!(fds[0].revents & POLLIN)) continue;
+
+        ssize_t len = recv(sockFd, buf, sizeof(buf), 0);
+        if (len <= 0) continue;  // ENOBUFS: 内核缓冲溢出，丢掉这一批继续
+
+        for (struct nlmsghdr* nl = reinterpret_cast<struct nlmsghdr*>(buf);
+             NLMSG_OK(nl, static_cast<unsigned int>(len));
+             nl = NLMSG_NEXT(nl, len)) {
+            if (nl->nlmsg_type == NLMSG_ERROR || nl->nlmsg_type == NLMSG_NOOP) continue;
+
+            struct cn_msg* cn = reinterpret_cast<struct cn_msg*>(NLMSG_DATA(nl));
+            if (cn->id.idx != CN_IDX_PROC || cn->id.val != CN_VAL_PROC) continue;
+            struct proc_event* pe = reinterpret_cast<struct proc_event*>(cn->data);
+
+            switch (pe->what) {
+            case proc_event::PROC_EVENT_FORK: {
+                // 只跟踪进程 (不含线程)：派生者是本程序或其子孙时记下来
+                int child = pe->event_data.fork.child_pid;
+                if (child == pe->event_data.fork.child_tgid &&
+                    ownDescendants.count(pe->event_data.fork.parent_tgid)) {
+                    ownDescendants.insert(child);
+                }
+                break;
+            }
+            case proc_event::PROC_EVENT_EXEC: {
+                int pid = pe->event_data.exec.process_pid;
+                if (pid != pe->event_data.exec.process_tgid) break;
+                if (ownDescendants.count(pid)) break;
+                push(ProcEvent{ProcEvent::EXEC, pid, readComm(pid), std::chrono::system_clock::now()});
+                break;
+            }
+            case proc_event::PROC_EVENT_EXIT: {
+                int pid = pe->event_data.exit.process_pid;
+                if (pid != pe->event_data.exit.process_tgid) break;
+                if (ownDescendants.erase(pid)) break;
+                push(ProcEvent{ProcEvent::EXIT, pid, "", std::chrono::system_clock::now()});
+                break;
+            }
+            default:
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,84 @@
+/**
+ * @file proc_events.h
+ * @brief 进程事件监听 (netlink proc connector)
+ * @details 订阅内核 PROC_EVENT_FORK/EXEC/EXIT，在独立线程中把 exec/exit 事件
+ *          连同时间戳放进有界队列，由 ProcMonitor 取走。
+ *          需要 CAP_NET_ADMIN (一般即 root)，打不开时 start() 返回 false，
+ *          调用方应回退到轮询 /proc 的方式。
+ */
+
+#ifndef PROC_EVENTS_H
+#define PROC_EVENTS_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_set>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+// 单条进程事件
+struct ProcEvent {
+    enum Type { EXEC, EXIT };
+    Type type;
+    int pid;
+    std::string name;   // exec 时立即读取的 comm (进程可能马上就退出了)
+    std::chrono::system_clock::time_point time;
+};
+
+class ProcEventListener {
+public:
+    /**
+     * @param capacity 队列上限，满了丢弃最旧的事件
+     */
+    explicit ProcEventListener(size_t capacity = 4096);
+    ~ProcEventListener();
+
+    /**
+     * @brief 打开 netlink 套接字并启动监听线程
+     * @return 成功 true；没有权限或内核不支持时 false
+     */
+    bool start();
+
+    /**
+     * @brief 停止监听线程并关闭套接字
+     */
+    void stop();
+
+    /**
+     * @brief 监听线程是否在工作
+     */
+    bool isActive() const { return running; }
+
+    /**
+     * @brief 取走队列中的全部事件 (按发生顺序)
+     */
+    std::vector<ProcEvent> drain();
+
+    /**
+     * @brief 因队列满而丢弃的事件数量
+     */
+    unsigned long long droppedCount() const { return dropped; }
+
+private:
+    int sockFd;
+    int wakeFd;                    // eventfd，stop() 时唤醒 poll
+    size_t capacity;
+    std::atomic<bool> running;
+    std::atomic<unsigned long long> dropped;
+    std::thread worker;
+
+    std::mutex queueMutex;
+    std::deque<ProcEvent> queue;
+
+    // 本程序派生的子孙进程 (curl、sh 等)，不计入新进程
+    std::unordered_set<int> ownDescendants;
+
+    bool subscribe(bool enable);
+    void listenLoop();
+    void push(ProcEvent&& ev);
+};
+
+#endif // PROC_EVENTS_H
@@ -8,154 +8,136 @@
 #include <cstdio>
 #include <sstream>
 #include <algorithm>
-#include <dirent.h> // 用于遍历 /proc 目录
 #include <memory>
 #include <fstream>
 #include <cstring>
+#include <thread>
+#include <chrono>
+#include <ctime>
+#include <unordered_map>
+
+ProcMonitor::ProcMonitor() : lastPidVersion(0) {
+    // 初始化时先采一次，作为 CPU 区间与新进程检测的基准
+    sample();
+    {
+        auto snap = snapshot();
+        for (const auto& p : snap->procs) lastPidSet.insert(p.pid);
+        lastPidVersion = snap.version();
+    }
+    // 尝试订阅内核进程事件 (需要 root)
+    if (!events.start()) {
+        std::cerr << "[ProcMonitor] 无法订阅进程事件 (需要 root)，新进程检测回退为轮询模式。" << std::endl;
+    }
+}
 
-ProcMonitor::ProcMonitor() {
-    // 初始化时，先获取一次当前所有 PID，作为基准
-    std::vector<int> pids = getAllPids();
-    // 存入 set 中
-    lastPidSet.insert(pids.begin(), pids.end());
+ProcMonitor::~ProcMonitor() {
+    events.stop();
 }
 
-ProcMonitor::~ProcMonitor() {}
-
-// 辅助：读取 /proc/[pid]/comm 获取进程名
-std::string ProcMonitor::getProcessName(int pid) {
-    std::string path = "/proc/" + std::to_string(pid) + "/comm";
-    std::ifstream file(path);
-    std::string name;
-    if (file.is_open()) {
-        std::getline(file, name);
-        // 去除文件末尾可能存在的换行符
-        if (!name.empty() && name.back() == '\n') name.pop_back();
-        file.close();
-    }
-    return name.empty() ? "unknown" : name;
+void ProcMonitor::sample() {
+    // 采样器只在发布回调里使用，发布之间由快照总线串行
+    table.publish([this](ProcTable& next) { sampler.sample(next); });
 }
 
-// 辅助：遍历 /proc 目录获取所有数字文件夹 (即 PID)
-std::vector<int> ProcMonitor::getAllPids() {
-    std::vector<int> pids;
-    DIR* dir = opendir("/proc");
-    if (!dir) return pids;
-
-    struct dirent* entry;
-    while ((entry = readdir(dir)) != nullptr) {
-        // 如果目录名首字符是数字，说明是 PID 目录
-        if (isdigit(entry->d_name[0])) {
-            try {
-                pids.push_back(std::stoi(entry->d_name));
-            } catch (...) {}
-        }
-    }
-    closedir(dir);
-    return pids;
+ProcessInfo ProcMonitor::toInfo(const ProcSample& s, unsigned long long memTotalKB) {
+    ProcessInfo p;
+    p.pid = s.pid;
+    p.name = s.name;
+    p.cpuPercent = s.cpuPercent;
+    p.memPercent = memTotalKB > 0 ? s.rssKB * 100.0 / memTotalKB : 0.0;
+    return p;
 }
 
-// 获取 Top CPU 进程 (使用 ps 命令)
+// 获取 Top CPU 进程 (最新快照，区间 CPU%)
 std::vector<ProcessInfo> ProcMonitor::getTopCpuProcesses(int limit) {
     std::vector<ProcessInfo> processes;
-    
-    // ps 命令：-e (所有进程) -o (自定义输出) --sort (按CPU倒序)
-    std::string cmd = "ps -eo pid,comm,%cpu,%mem --sort=-%cpu | head -n " + std::to_string(limit + 1);
-    
-    std::shared_ptr<FILE> pipe(popen(cmd.c_str(), "r"), pclose);
-    if (!pipe) return processes;
-
-    char buffer[256];
-    // 读取并跳过第一行标题 (PID COMMAND %CPU %MEM)
-    fgets(buffer, 256, pipe.get());
-
-    while (fgets(buffer, 256, pipe.get()) != nullptr) {
-        ProcessInfo p;
-        std::stringstream ss(buffer);
-        ss >> p.pid >> p.name >> p.cpuPercent >> p.memPercent;
-        processes.push_back(p);
-    }
+    auto snap = snapshot();
+    for (const auto& s : snap->topByCpu(limit)) processes.push_back(toInfo(s, snap->memTotalKB));
     return processes;
 }
 
-// 根据名字查找 PID
-int ProcMonitor::findPidByName(const std::string& targetName) {
-    // 1. 优先尝试精确匹配 (-x)
-    std::string cmd = "pgrep -x " + targetName + " | head -n 1";
-    std::shared_ptr<FILE> pipe(popen(cmd.c_str(), "r"), pclose);
-    char buffer[64];
-    if (fgets(buffer, 64, pipe.get())) {
-        return std::stoi(buffer);
-    }
-    
-    // 2. 如果失败，尝试模糊匹配 (-f)
-    cmd = "pgrep -f " + targetName + " | head -n 1";
-    std::shared_ptr<FILE> pipe2(popen(cmd.c_str(), "r"), pclose);
-    if (fgets(buffer, 64, pipe2.get())) {
-        return std::stoi(buffer);
-    }
-
-    return -1;
-}
+// 根据名字查找全部匹配进程 (最新快照，不 fork)
+std::vector<ProcessInfo> ProcMonitor::findProcessesByName(const std::string& targetName, bool* exact) {
+    std::vector<ProcessInfo> result;
+    auto snap = snapshot();
 
-// === 核心逻辑 1: 持续检测新进程 ===
-
-std::string ProcMonitor::detectNewProcesses() {
+    // 1. 优先尝试精确匹配 (等同 pgrep -x)
+    std::vector<size_t> hits = snap->find(targetName, true);
+    if (exact) *exact = !hits.empty();
+    // 2. 如果失败，尝试模糊匹配 (等同 pgrep -f)
+    if (hits.empty()) hits = snap->find(targetName, false);
 
-    // 1. 获取当前的 PID 列表
+    for (size_t i : hits) result.push_back(toInfo(snap->procs[i], snap->memTotalKB));
+    return result;
+}
 
-    std::vector<int> currentPids = getAllPids();
+// 根据名字查找 PID (取 CPU 最高的一个)
+int ProcMonitor::findPidByName(const std::string& targetName) {
+    auto procs = findProcessesByName(targetName);
+    return procs.empty() ? -1 : procs.front().pid;
+}
 
-    std::set<int> currentPidSet(currentPids.begin(), currentPids.end());
+// === 核心逻辑 1: 持续检测新进程 ===
 
-    
+// 过滤掉极其短暂的系统命令进程 (如 ps, grep, sh)，避免刷屏
+static bool isNoisyCommand(const std::string& name) {
+    return name == "ps" || name == "grep" || name == "sh" || name == "pgrep";
+}
 
+std::string ProcMonitor::reportProcessEvents() {
+    std::vector<ProcEvent> evs = events.drain();
     std::string report = "";
 
+    // 同一批里已经退出的 PID，用于标注短命进程
+    std::set<int> exited;
+    for (const auto& ev : evs) {
+        if (ev.type == ProcEvent::EXIT) exited.insert(ev.pid);
+    }
 
+    for (const auto& ev : evs) {
+        if (ev.type != ProcEvent::EXEC || isNoisyCommand(ev.name)) continue;
 
-    // 2. 遍历现在的 PID，如果之前的 set 里没有，说明是新启动的
-
-    for (int pid : currentPidSet) {
-
-        // 如果在旧集合里找不到这个 pid
-
-        if (lastPidSet.find(pid) == lastPidSet.end()) {
-
-            std::string name = getProcessName(pid);
-
-            
-
-            // 过滤掉极其短暂的系统命令进程 (如 ps, grep, sh)，避免刷屏
+        std::time_t t = std::chrono::system_clock::to_time_t(ev.time);
+        char ts[16];
+        std::strftime(ts, sizeof(ts), "%H:%M:%S", std::localtime(&t));
 
-            if (name != "ps" && name != "grep" && name != "sh" && name != "pgrep") {
+        report += " [新进程] " + ev.name + " (PID:" + std::to_string(ev.pid) + ") @" + ts;
+        if (exited.count(ev.pid)) report += " [已退出]";
+        report += "\n";
+    }
+    return report;
+}
 
-                report += " [新进程] " + name + " (PID:" + std::to_string(pid) + ")\n";
+std::string ProcMonitor::detectNewProcesses() {
+    // 0. 事件模式：直接消费内核推送的 exec 事件
+    if (events.isActive()) return reportProcessEvents();
 
-            }
+    // 1. 轮询模式：和上一次检测时的快照对比，快照没更新就没有新东西可报
+    auto snap = snapshot();
+    std::lock_guard<std::mutex> g(newProcLock);
+    if (snap.version() == lastPidVersion) return "";
 
+    std::string report = "";
+    std::set<int> currentPidSet;
+    for (const auto& p : snap->procs) {
+        currentPidSet.insert(p.pid);
+        // 2. 之前的 set 里没有，说明是新启动的
+        if (lastPidSet.find(p.pid) == lastPidSet.end() && !isNoisyCommand(p.name)) {
+            report += " [新进程] " + p.name + " (PID:" + std::to_string(p.pid) + ")\n";
         }
-
     }
 
-
-
     // 3. 更新基准，把现在的变成“旧的”，供下一次对比
-
-    lastPidSet = currentPidSet;
-
+    lastPidSet.swap(currentPidSet);
+    lastPidVersion = snap.version();
     return report;
-
 }
 
-
-
 // === 核心逻辑 2: 检测异常高占用 ===
 
 std::string ProcMonitor::detectAbnormalProcesses(double threshold) {
 
-    // 获取前 3 名高占用
-
+    // 获取前 3 名高占用 (最新快照)
     auto procs = getTopCpuProcesses(3);
 
     std::string report = "";
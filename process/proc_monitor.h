@@ -9,6 +9,10 @@
 #include <string>
 #include <vector>
 #include <set> // 引入 set 用于快速查找 PID
+#include <mutex>
+#include "core/snapshot_bus.h"
+#include "process/proc_sampler.h"
+#include "process/proc_events.h"
 
 // 定义进程信息的结构体
 struct ProcessInfo {
@@ -23,8 +27,20 @@ public:
     ProcMonitor();
     ~ProcMonitor();
 
+    /**
+     * @brief 读一遍 /proc 并发布新的进程表快照
+     * @details 由后台采样线程周期性调用；下面的查询都只读最新快照，不会触发新的采样
+     */
+    void sample();
+
+    /**
+     * @brief 最新的进程表快照 (无锁)，句柄存活期间内容不变
+     */
+    SnapshotBus<ProcTable>::Reader snapshot() const { return table.read(); }
+
     /**
      * @brief 获取当前 CPU 占用最高的 N 个进程
+     * @details 取自最新快照，CPU% 是最近一个采样区间的占用率
      * @param limit 返回的数量 (默认前5)
      * @return 进程列表
      */
@@ -32,14 +48,24 @@ public:
 
     /**
      * @brief 根据进程名查找 PID
+     * @details 先精确匹配，再模糊匹配；多个命中时取 CPU 最高的
      * @param processName 进程名 (如 "chrome")
      * @return PID，如果没找到返回 -1
      */
     int findPidByName(const std::string& processName);
 
+    /**
+     * @brief 根据进程名查找全部匹配的进程
+     * @details 在最新快照里查找，不再 fork pgrep；名字不会进入 shell
+     * @param exact 非空时写入结果是否来自精确匹配 (false 表示退回了忽略大小写的子串匹配)
+     * @return 匹配的进程，按 CPU 占用从高到低排列
+     */
+    std::vector<ProcessInfo> findProcessesByName(const std::string& processName, bool* exact = nullptr);
+
    /**
      * @brief 检测是否有新启动的进程
-     * @details 对比上一刻的 PID 列表，找出新增的 PID
+     * @details 有 netlink 权限时取走 ProcEventListener 收到的 exec 事件，
+     *          连只活了几毫秒的进程也不会漏；否则对比上一次检测时的快照，找出新增的 PID
      * @return 包含新进程信息的字符串报告
      */
     std::string detectNewProcesses();
@@ -52,13 +78,19 @@ public:
     std::string detectAbnormalProcesses(double threshold = 80.0);
 
 private:
+    ProcSampler sampler;      // /proc 采样器 (保存上一次的 jiffies)，只在 table.publish 内使用
+    SnapshotBus<ProcTable> table;
+    ProcEventListener events; // 内核进程事件 (不可用时回退到轮询)
+
+    // 轮询模式的新进程检测基准，只有监控检测会用到
+    std::mutex newProcLock;
     std::set<int> lastPidSet; // 使用 set 存储上一次的 PID，查询速度比 vector 快
-    
-    // 获取当前所有 PID 的辅助函数
-    std::vector<int> getAllPids();
-    
-    // 获取进程名称的辅助函数 (读取 /proc/[pid]/comm)
-    std::string getProcessName(int pid);
+    uint64_t lastPidVersion;  // lastPidSet 来自第几份快照
+
+    static ProcessInfo toInfo(const ProcSample& s, unsigned long long memTotalKB);
+
+    // 事件模式：把队列里的 exec/exit 事件整理成报告
+    std::string reportProcessEvents();
 };
 
 #endif // PROC_MONITOR_H
\ No newline at end of file
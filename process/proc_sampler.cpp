@@ -0,0 +1,268 @@
+/**
+ * @file proc_sampler.cpp
+ * @brief 进程采样器实现
+ */
+
+#include "process/proc_sampler.h"
+#include "core/text_match.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <fcntl.h>
+#include <unistd.h>
+
+ProcSampler::ProcSampler()
+    : procFd(-1), procDir(nullptr), totalMemKB(0), generation(0), hasSampled(false) {
+    clockTicks = sysconf(_SC_CLK_TCK);
+    if (clockTicks <= 0) clockTicks = 100;
+    pageKB = sysconf(_SC_PAGESIZE) / 1024;
+    if (pageKB <= 0) pageKB = 4;
+
+    procFd = open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (procFd >= 0) {
+        // fdopendir 接管的是 dup 出来的 fd，procFd 本身留给 openat 使用
+        int dirFd = dup(procFd);
+        if (dirFd >= 0) {
+            procDir = fdopendir(dirFd);
+            if (!procDir) close(dirFd);
+        }
+    }
+    totalMemKB = readMemTotalKB();
+}
+
+ProcSampler::~ProcSampler() {
+    if (procDir) closedir(procDir);
+    if (procFd >= 0) close(procFd);
+}
+
+unsigned long long ProcSampler::readMemTotalKB() {
+    FILE* f = fopen("/proc/meminfo", "r");
+    if (!f) return 0;
+    unsigned long long kb = 0;
+    char line[128];
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, "MemTotal:", 9) == 0) {
+            kb = strtoull(line + 9, nullptr, 10);
+            break;
+        }
+    }
+    fclose(f);
+    return kb;
+}
+
+long ProcSampler::readProcFile(const char* pidStr, const char* file) {
+    snprintf(pathBuf, sizeof(pathBuf), "%s/%s", pidStr, file);
+    int fd = openat(procFd, pathBuf, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    ssize_t n = read(fd, statBuf, sizeof(statBuf) - 1);
+    close(fd);
+    if (n <= 0) return -1;
+    statBuf[n] = '\0';
+    return static_cast<long>(n);
+}
+
+bool ProcSampler::parseStat(long len, std::string& name, unsigned long long& cpuTicks, unsigned long long& startTime) {
+    // 格式: pid (comm) state ppid ... ，comm 里可能含空格或括号，所以取最后一个 ')'
+    char* lp = static_cast<char*>(memchr(statBuf, '(', len));
+    char* rp = static_cast<char*>(memrchr(statBuf, ')', len));
+    if (!lp || !rp || rp < lp) return false;
+    name.assign(lp + 1, rp - lp - 1);
+
+    // ')' 之后第 1 个字段是 state (总第 3 个字段)
+    // utime = 14, stime = 15, starttime = 22
+    char* p = rp + 2;
+    char* end = statBuf + len;
+    int field = 3;
+    unsigned long long utime = 0, stime = 0;
+    while (p < end && field <= 22) {
+        if (field == 14) utime = strtoull(p, nullptr, 10);
+        else if (field == 15) stime = strtoull(p, nullptr, 10);
+        else if (field == 22) { startTime = strtoull(p, nullptr, 10); break; }
+        char* sp = static_cast<char*>(memchr(p, ' ', end - p));
+        if (!sp) return false;
+        p = sp + 1;
+        field++;
+    }
+    if (field != 22) return false;
+    cpuTicks = utime + stime;
+    return true;
+}
+
+int ProcSampler::sample(ProcTable& table) {
+    std::vector<ProcSample>& out = table.procs;
+    out.clear();
+    table.buildIndex();   // 清掉指向旧内容的索引
+    table.memTotalKB = totalMemKB;
+    if (!procDir) return 0;
+
+    auto now = std::chrono::steady_clock::now();
+    double elapsedSec = 0.0;
+    if (hasSampled) {
+        elapsedSec = std::chrono::duration<double>(now - lastSampleTime).count();
+    }
+    double tickSec = elapsedSec * clockTicks;  // 区间内单核可用的 jiffies
+
+    generation++;
+    rewinddir(procDir);
+
+    struct dirent* entry;
+    while ((entry = readdir(procDir)) != nullptr) {
+        const char* d = entry->d_name;
+        if (d[0] < '0' || d[0] > '9') continue;
+        int pid = atoi(d);
+
+        long len = readProcFile(d, "stat");
+        if (len <= 0) continue;  // 进程已退出
+
+        ProcSample s;
+        s.pid = pid;
+        s.cpuPercent = 0.0;
+        s.rssKB = 0;
+        unsigned long long ticks = 0, startTime = 0;
+        if (!parseStat(len, s.name, ticks, startTime)) continue;
+
+        auto it = tracked.find(pid);
+        if (it != tracked.end() && it->second.startTime == startTime) {
+            Tracked& t = it->second;
+            if (tickSec > 0.0 && ticks >= t.cpuTicks) {
+                s.cpuPercent = (ticks - t.cpuTicks) * 100.0 / tickSec;
+            }
+            // exec 会保留 PID 和 starttime，但 comm 会变，命令行也要重读
+            if (t.name != s.name) {
+                t.name = s.name;
+                t.cmdline = readCmdline(d);
+            }
+        } else {
+            // 新进程，或 starttime 不同说明 PID 被复用
+            Tracked& t = tracked[pid];
+            t.startTime = startTime;
+            t.name = s.name;
+            t.cmdline = readCmdline(d);
+        }
+
+        Tracked& t = tracked[pid];
+        t.cpuTicks = ticks;
+        t.seenGen = generation;
+        s.cmdline = t.cmdline;
+
+        // statm: size resident shared ...
+        len = readProcFile(d, "statm");
+        if (len > 0) {
+            char* p = static_cast<char*>(memchr(statBuf, ' ', len));
+            if (p) s.rssKB = strtoull(p + 1, nullptr, 10) * pageKB;
+        }
+
+        out.push_back(std::move(s));
+    }
+
+    // 本轮没出现的 PID 已经退出
+    for (auto it = tracked.begin(); it != tracked.end();) {
+        if (it->second.seenGen != generation) it = tracked.erase(it);
+        else ++it;
+    }
+
+    table.buildIndex();
+    table.hasCpu = hasSampled;
+    table.sampledAt = now;
+    lastSampleTime = now;
+    hasSampled = true;
+    return static_cast<int>(out.size());
+}
+
+std::shared_ptr<const ProcCmdline> ProcSampler::readCmdline(const char* pidStr) {
+    long len = readProcFile(pidStr, "cmdline");
+    if (len <= 0) return nullptr;  // 内核线程没有 cmdline
+
+    auto cmd = std::make_shared<ProcCmdline>();
+    // cmdline 以 '\0' 分隔参数
+    const char* p = statBuf;
+    const char* end = statBuf + len;
+    while (p < end) {
+        size_t n = strnlen(p, end - p);
+        if (n > 0) {
+            cmd->tokens.emplace_back(p, n);
+            // argv[0] 额外记下它的文件名部分 (/usr/lib/firefox/firefox -> firefox)
+            if (p == statBuf) {
+                const char* slash = static_cast<const char*>(memrchr(p, '/', n));
+                if (slash) {
+                    cmd->argv0Base.assign(slash + 1, p + n - slash - 1);
+                    if (!cmd->argv0Base.empty()) cmd->tokens.push_back(cmd->argv0Base);
+                } else {
+                    cmd->argv0Base.assign(p, n);
+                }
+            }
+        }
+        p += n + 1;
+    }
+    return cmd;
+}
+
+// ==========================================
+
+void ProcTable::buildIndex() {
+    byName.clear();
+    byToken.clear();
+    for (size_t i = 0; i < procs.size(); ++i) {
+        const ProcSample& s = procs[i];
+        byName[s.name].push_back(i);
+        if (!s.cmdline) continue;
+        for (const auto& tok : s.cmdline->tokens) {
+            std::vector<size_t>& ids = byToken[tok];
+            // 同一个进程的参数可能重复 (比如 argv0Base 与某个参数相同)
+            if (ids.empty() || ids.back() != i) ids.push_back(i);
+        }
+    }
+}
+
+std::vector<size_t> ProcTable::find(const std::string& name, bool exact) const {
+    std::vector<size_t> hits;
+    if (name.empty()) return hits;
+
+    if (exact) {
+        auto it = byName.find(name);
+        if (it != byName.end()) hits = it->second;
+        // comm 最长 15 字节，长名字要靠 argv[0] 的文件名
+        auto tt = byToken.find(name);
+        if (tt != byToken.end()) {
+            for (size_t i : tt->second) {
+                if (procs[i].cmdline->argv0Base == name) hits.push_back(i);
+            }
+        }
+    } else {
+        // 去重后的名字/参数数量远小于进程数，直接线性扫描 key
+        TextMatcher matcher(name);
+        for (const auto& kv : byName) {
+            if (matcher.matches(kv.first.data(), kv.first.size())) hits.insert(hits.end(), kv.second.begin(), kv.second.end());
+        }
+        for (const auto& kv : byToken) {
+            if (matcher.matches(kv.first.data(), kv.first.size())) hits.insert(hits.end(), kv.second.begin(), kv.second.end());
+        }
+    }
+
+    std::sort(hits.begin(), hits.end(), [this](size_t a, size_t b) {
+        double ca = procs[a].cpuPercent, cb = procs[b].cpuPercent;
+        return ca != cb ? ca > cb : procs[a].pid < procs[b].pid;
+    });
+    hits.erase(std::unique(hits.begin(), hits.end()), hits.end());
+    return hits;
+}
+
+std::vector<ProcSample> ProcTable::topByCpu(int limit) const {
+    // 只对指针做部分选择，避免拷贝全部进程的 name
+    std::vector<const ProcSample*> order;
+    order.reserve(procs.size());
+    for (const auto& s : procs) order.push_back(&s);
+
+    size_t n = std::min(order.size(), static_cast<size_t>(std::max(limit, 0)));
+    std::partial_sort(order.begin(), order.begin() + n, order.end(),
+                      [](const ProcSample* a, const ProcSample* b) {
+                          return a->cpuPercent > b->cpuPercent;
+                      });
+
+    std::vector<ProcSample> result;
+    result.reserve(n);
+    for (size_t i = 0; i < n; ++i) result.push_back(*order[i]);
+    return result;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file proc_sampler.h
+ * @brief 进程采样器 (直接读取 /proc，不再 fork ps)
+ * @details 持有 /proc 目录 fd，每次采样读取 /proc/[pid]/stat 与 statm，
+ *          与上一次采样的 jiffies 做差，得到真实的区间 CPU 占用率与 RSS。
+ *          结果写进调用方提供的 ProcTable (通常是快照总线的后台缓冲)，
+ *          按名字查找也在 ProcTable 上完成，读者不需要碰采样器的内部状态。
+ *          只有新出现 (或 exec 后改名) 的进程才会去读 cmdline，之后各次采样共享同一份。
+ */
+
+#ifndef PROC_SAMPLER_H
+#define PROC_SAMPLER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <chrono>
+#include <dirent.h>
+
+// 进程的命令行参数，进程存活期间不变，各次采样共享
+struct ProcCmdline {
+    std::string argv0Base;            // argv[0] 的文件名部分
+    std::vector<std::string> tokens;  // 全部参数 (含 argv0Base)
+};
+
+// 单个进程在一次采样中的结果
+struct ProcSample {
+    int pid;
+    std::string name;          // comm (最长 15 字节)
+    double cpuPercent;         // 区间 CPU 占用率 (单核 = 100%)
+    unsigned long long rssKB;  // 常驻内存 (KB)
+    std::shared_ptr<const ProcCmdline> cmdline;  // 内核线程为空
+};
+
+// 一次完整采样得到的进程表
+// 名字索引和表一起发布，查找时只读这份快照，读者之间不需要加锁
+struct ProcTable {
+    std::vector<ProcSample> procs;
+    unsigned long long memTotalKB = 0;
+    bool hasCpu = false;       // 第一次采样没有基准，CPU% 全部为 0
+    std::chrono::steady_clock::time_point sampledAt;
+
+    ProcTable() = default;
+    // 索引的键直接指向本表里的字符串，拷贝出去的索引会指向原表
+    ProcTable(const ProcTable&) = delete;
+    ProcTable& operator=(const ProcTable&) = delete;
+
+    /**
+     * @brief 按 procs 重建名字索引
+     * @details 由 ProcSampler::sample() 在填好 procs 之后调用；之后 procs 不能再增删
+     */
+    void buildIndex();
+
+    /**
+     * @brief 选出 CPU 最高的 N 个进程
+     * @details 使用 partial_sort 做部分选择，不对全部进程排序
+     */
+    std::vector<ProcSample> topByCpu(int limit) const;
+
+    /**
+     * @brief 按名字查找进程 (只查这份快照，不 fork pgrep)
+     * @param name 进程名
+     * @param exact true: comm 或 argv[0] 文件名完全相等 (相当于 pgrep -x)
+     *              false: comm 或任一命令行参数包含 name，忽略大小写 (相当于 pgrep -f)
+     * @return 匹配的进程在 procs 中的下标，按 CPU% 从高到低排列
+     */
+    std::vector<size_t> find(const std::string& name, bool exact) const;
+
+private:
+    // comm / 命令行参数 (含 argv0Base) -> procs 下标；键指向 procs 中的 name 和共享的 cmdline
+    std::unordered_map<std::string_view, std::vector<size_t>> byName;
+    std::unordered_map<std::string_view, std::vector<size_t>> byToken;
+};
+
+class ProcSampler {
+public:
+    ProcSampler();
+    ~ProcSampler();
+
+    /**
+     * @brief 遍历 /proc 做一次采样，结果写进 table
+     * @details CPU% 相对于上一次 sample() 计算；table 原有内容被覆盖。
+     *          采样器自身有状态，同一时刻只能有一个线程调用。
+     * @return 本次采样到的进程数量
+     */
+    int sample(ProcTable& table);
+
+private:
+    // 每个存活 PID 的跟踪状态，跨采样保留
+    struct Tracked {
+        unsigned long long startTime;  // 进程启动时间，用于识别 PID 复用
+        unsigned long long cpuTicks;   // utime + stime
+        unsigned long long seenGen;    // 最近一次出现在第几轮采样
+        std::string name;              // 读 cmdline 时的 comm
+        std::shared_ptr<const ProcCmdline> cmdline;
+    };
+
+    int procFd;                 // /proc 目录 fd
+    DIR* procDir;               // 基于 procFd 的目录流，每次 rewinddir 复用
+    long clockTicks;            // sysconf(_SC_CLK_TCK)
+    long pageKB;                // 页大小 (KB)
+    unsigned long long totalMemKB;
+
+    std::unordered_map<int, Tracked> tracked;
+    unsigned long long generation;
+    std::chrono::steady_clock::time_point lastSampleTime;
+    bool hasSampled;
+
+    char statBuf[4096];         // 复用的读缓冲区 (cmdline 超长时截断)
+    char pathBuf[64];
+
+    // 读取 <pid>/<file> 到 statBuf，返回读取的字节数 (失败返回 -1)
+    long readProcFile(const char* pidStr, const char* file);
+
+    // 解析 stat：comm、utime+stime、starttime
+    bool parseStat(long len, std::string& name, unsigned long long& cpuTicks, unsigned long long& startTime);
+
+    // 读取并切分 cmdline
+    std::shared_ptr<const ProcCmdline> readCmdline(const char* pidStr);
+
+    unsigned long long readMemTotalKB();
+};
+
+#endif // PROC_SAMPLER_H
@@ -0,0 +1,111 @@
+/**
+ * @file bench_dir_scanner.cpp
+ * @brief DirScanner 全量扫描随线程数的伸缩，对照 std::filesystem::recursive_directory_iterator
+ * @details 对照组单线程递归遍历，普通文件取 file_size 和 last_write_time，和 DirScanner 收集的信息一致。
+ *          不给路径时在临时目录生成一棵树 (宽 x 深的目录，每个目录若干文件)，结束后删除。
+ *          反复扫同一棵树，测的是页缓存热的情况。
+ *          用法: bench_dir_scanner [路径] [最大线程数] [轮数]
+ */
+
+#include "file/dir_scanner.h"
+#include "tests/test_util.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <sys/stat.h>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const int kFanout = 8;          // 每个目录的子目录数
+const int kDepth = 4;           // 目录层数 (8^4 = 4096 个叶子目录)
+const int kFilesPerDir = 12;
+
+void makeTree(const std::string& dir, int depth) {
+    for (int i = 0; i < kFilesPerDir; ++i) {
+        std::ofstream(dir + "/f" + std::to_string(i) + ".dat") << std::string(static_cast<size_t>(i) * 64, 'x');
+    }
+    if (depth == 0) return;
+    for (int i = 0; i < kFanout; ++i) {
+        std::string sub = dir + "/d" + std::to_string(i);
+        mkdir(sub.c_str(), 0755);
+        makeTree(sub, depth - 1);
+    }
+}
+
+// 对照组：标准库递归迭代，跳过无权限目录，不跟随符号链接
+size_t iteratorScan(const std::string& root, uint64_t& totalBytes) {
+    size_t files = 0;
+    std::error_code ec;
+    fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec);
+    for (fs::recursive_directory_iterator end; !ec && it != end; it.increment(ec)) {
+        if (!fs::is_regular_file(it->symlink_status(ec))) continue;   // 和 DirScanner 一样不算符号链接
+        totalBytes += it->file_size(ec);
+        it->last_write_time(ec);
+        files++;
+    }
+    return files;
+}
+
+template <typename Fn>
+void report(const std::string& name, int rounds, Fn&& fn) {
+    size_t files = fn();   // 预热
+    double seconds = timeIt([&] {
+        for (int i = 0; i < rounds; ++i) fn();
+    });
+    printf("%-30s %10.2f ms/次  (%zu 个文件)\n", name.c_str(), seconds * 1e3 / rounds, files);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string root = (argc > 1) ? argv[1] : "";
+    int maxThreads = (argc > 2) ? atoi(argv[2]) : static_cast<int>(std::thread::hardware_concurrency());
+    if (maxThreads <= 0) maxThreads = 1;
+    int rounds = (argc > 3) ? atoi(argv[3]) : 5;
+    if (rounds <= 0) rounds = 5;
+
+    bool generated = root.empty();
+    if (generated) {
+        char tmpl[] = "/tmp/aios_bench_scan_XXXXXX";
+        if (!mkdtemp(tmpl)) {
+            perror("mkdtemp");
+            return 1;
+        }
+        root = tmpl;
+        makeTree(root, kDepth);
+    }
+    printf("扫描 %s，%d 轮\n", root.c_str(), rounds);
+
+    volatile uint64_t sink = 0;
+    report("recursive_directory_iterator", rounds, [&] {
+        uint64_t bytes = 0;
+        size_t files = iteratorScan(root, bytes);
+        sink = sink + bytes;
+        return files;
+    });
+
+    DirScanner scanner;
+    // 1, 2, 4, ... 翻倍，最后一档是 maxThreads
+    for (int threads = 1;; threads = std::min(threads * 2, maxThreads)) {
+        scanner.setThreadCount(threads);
+        report("DirScanner " + std::to_string(threads) + " 线程", rounds, [&] {
+            ScanResult result = scanner.scan(root, 0);
+            sink = sink + result.dirs.size();
+            return result.files.size();
+        });
+        if (threads == maxThreads) break;
+    }
+
+    if (generated) {
+        std::error_code ec;
+        fs::remove_all(root, ec);
+    }
+    return 0;
+}
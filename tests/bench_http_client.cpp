@@ -0,0 +1,77 @@
+/**
+ * @file bench_http_client.cpp
+ * @brief HttpClient 的单次请求延迟，对照每次 popen 一个 curl 的旧做法
+ * @details 回环服务端立即回一个 Ollama 风格的小 JSON，测的是纯客户端开销：
+ *          复用连接 / 每次新建连接 / sh + curl 进程。
+ *          用法: bench_http_client [请求次数]
+ */
+
+#include "core/http_client.h"
+#include "tests/http_test_server.h"
+#include "tests/test_util.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+const char* kBody = "{\"model\":\"qwen2.5:7b\",\"prompt\":\"查看CPU\",\"stream\":false}";
+const char* kReply = "{\"model\":\"qwen2.5:7b\",\"response\":\"CPU\",\"done\":true}";
+
+template <typename Fn>
+void report(const char* name, int n, Fn&& fn) {
+    int failures = 0;
+    fn(failures);   // 预热
+    failures = 0;
+    double seconds = timeIt([&] {
+        for (int i = 0; i < n; ++i) fn(failures);
+    });
+    printf("%-22s %10.1f us/次%s\n", name, seconds * 1e6 / n, failures ? "  (有失败)" : "");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int n = (argc > 1) ? atoi(argv[1]) : 2000;
+    if (n <= 0) n = 2000;
+
+    HttpTestServer server;
+    server.setHandler([](int fd, const std::string&) {
+        return HttpTestServer::sendAll(fd, HttpTestServer::response(kReply));
+    });
+    std::string url = "http://127.0.0.1:" + std::to_string(server.port()) + "/api/generate";
+    printf("%d 次请求 -> %s\n", n, url.c_str());
+
+    // 服务端一次只服务一个连接，这个客户端要先析构，后面的新连接才会被接受
+    {
+        HttpClient client("127.0.0.1", server.port());
+        report("HttpClient keep-alive", n, [&](int& failures) {
+            std::string response;
+            int status = 0;
+            if (!client.post("/api/generate", kBody, response, status) || status != 200) failures++;
+        });
+    }
+
+    report("HttpClient 每次新连接", n, [&](int& failures) {
+        HttpClient once("127.0.0.1", server.port());
+        std::string response;
+        int status = 0;
+        if (!once.post("/api/generate", kBody, response, status) || status != 200) failures++;
+    });
+
+    // curl 要 fork + exec，次数少一些
+    int curlRuns = n / 20 > 0 ? n / 20 : 1;
+    std::string cmd = "curl -s -X POST " + url + " -d '" + kBody + "' 2>/dev/null";
+    report("popen curl", curlRuns, [&](int& failures) {
+        FILE* pipe = popen(cmd.c_str(), "r");
+        if (!pipe) {
+            failures++;
+            return;
+        }
+        char buf[256];
+        std::string response;
+        while (fgets(buf, sizeof(buf), pipe)) response += buf;
+        if (pclose(pipe) != 0 || response != kReply) failures++;
+    });
+    return 0;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file bench_monitors.cpp
+ * @brief CpuMonitor / MemMonitor 单次采样的耗时
+ * @details 对照组是改用常开 fd 之前的读法：每次 ifstream 打开 /proc/stat、/proc/meminfo，
+ *          getline + istringstream 逐行解析，meminfo 全部行放进 std::map。
+ *          用法: bench_monitors [采样次数]
+ */
+
+#include "modules/cpu/cpu_monitor.h"
+#include "modules/memory/mem_monitor.h"
+#include "tests/test_util.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+
+namespace {
+
+// 旧的 /proc/stat 读法：每个 cpu 行一个 istringstream
+double streamCpuSample() {
+    std::ifstream file("/proc/stat");
+    std::string line, name;
+    double total = 0;
+    while (std::getline(file, line)) {
+        if (line.compare(0, 3, "cpu") != 0) break;
+        std::istringstream iss(line);
+        unsigned long long v[8] = {};
+        iss >> name >> v[0] >> v[1] >> v[2] >> v[3] >> v[4] >> v[5] >> v[6] >> v[7];
+        for (unsigned long long x : v) total += static_cast<double>(x);
+    }
+    std::ifstream freq("/sys/devices/system/cpu/cpu0/cpufreq/scaling_cur_freq");
+    double mhz = 0;
+    if (freq >> mhz) total += mhz;
+    return total;
+}
+
+// 旧的 /proc/meminfo 读法：全部行进 std::map
+double streamMemSample() {
+    std::ifstream file("/proc/meminfo");
+    std::map<std::string, double> memInfo;
+    std::string line, key, unit;
+    double value;
+    while (std::getline(file, line)) {
+        std::istringstream iss(line);
+        iss >> key >> value >> unit;
+        if (!key.empty() && key.back() == ':') key.pop_back();
+        memInfo[key] = value;
+    }
+    return memInfo["MemTotal"] - memInfo["MemAvailable"];
+}
+
+template <typename Fn>
+void report(const char* name, int n, Fn&& fn) {
+    fn();   // 预热
+    double seconds = timeIt([&] {
+        for (int i = 0; i < n; ++i) fn();
+    });
+    printf("%-28s %8.2f us/次\n", name, seconds * 1e6 / n);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int n = (argc > 1) ? atoi(argv[1]) : 20000;
+    if (n <= 0) n = 20000;
+
+    CpuMonitor cpu;
+    MemMonitor mem;
+    volatile double sink = 0;
+
+    printf("%d 次采样\n", n);
+    report("CpuMonitor::sample", n, [&] { cpu.sample(); });
+    report("ifstream /proc/stat", n, [&] { sink = sink + streamCpuSample(); });
+    report("MemMonitor::sample", n, [&] { mem.sample(); });
+    report("ifstream /proc/meminfo+map", n, [&] { sink = sink + streamMemSample(); });
+    return 0;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file bench_proc_sampler.cpp
+ * @brief ProcSampler 一次 Top-N 采样的耗时，对照 popen ps 的旧做法
+ * @details 新做法：sample() 遍历 /proc 填进 ProcTable，再 topByCpu(N)；
+ *          对照组是改用 /proc 之前 getTopCpuProcesses 的读法：
+ *          popen "ps -eo pid,comm,%cpu,%mem --sort=-%cpu | head"，跳过标题后 stringstream 逐行解析。
+ *          用法: bench_proc_sampler [采样次数] [N]
+ */
+
+#include "process/proc_sampler.h"
+#include "tests/test_util.h"
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct PsRow {
+    int pid = 0;
+    std::string name;
+    double cpuPercent = 0;
+    double memPercent = 0;
+};
+
+// 旧的 ps 读法：每次 fork sh + ps + head
+std::vector<PsRow> psTopByCpu(int limit) {
+    std::vector<PsRow> rows;
+    std::string cmd = "ps -eo pid,comm,%cpu,%mem --sort=-%cpu | head -n " + std::to_string(limit + 1);
+    FILE* pipe = popen(cmd.c_str(), "r");
+    if (!pipe) return rows;
+    char buffer[256];
+    if (fgets(buffer, sizeof(buffer), pipe)) {
+        while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
+            PsRow r;
+            std::stringstream ss(buffer);
+            ss >> r.pid >> r.name >> r.cpuPercent >> r.memPercent;
+            rows.push_back(r);
+        }
+    }
+    pclose(pipe);
+    return rows;
+}
+
+template <typename Fn>
+void report(const char* name, int n, Fn&& fn) {
+    fn();   // 预热
+    double seconds = timeIt([&] {
+        for (int i = 0; i < n; ++i) fn();
+    });
+    printf("%-30s %10.1f us/次\n", name, seconds * 1e6 / n);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int n = (argc > 1) ? atoi(argv[1]) : 200;
+    if (n <= 0) n = 200;
+    int limit = (argc > 2) ? atoi(argv[2]) : 10;
+    if (limit <= 0) limit = 10;
+
+    ProcSampler sampler;
+    ProcTable table;
+    volatile size_t sink = 0;
+
+    int procs = sampler.sample(table);
+    printf("%d 次采样, Top %d, 当前 %d 个进程\n", n, limit, procs);
+    report("ProcSampler::sample+topByCpu", n, [&] {
+        sampler.sample(table);
+        sink = sink + table.topByCpu(limit).size();
+    });
+    report("popen ps | head", n, [&] { sink = sink + psTopByCpu(limit).size(); });
+    return 0;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file bench_text_match.cpp
+ * @brief TextMatcher 与 transform(tolower) + find 的吞吐对比
+ * @details 两组文本：短的 (类似文件名 / 进程名，20~60 字节) 和长的 (类似命令行 / 日志行，约 1 KB)。
+ *          对照组一是改动前的写法：每次比较都复制并小写文本和关键词；
+ *          对照组二只复制小写文本，关键词提前小写好，是不用匹配器时能做到的最好情况。
+ *          用法: bench_text_match [文本条数]
+ */
+
+#include "core/text_match.h"
+#include "tests/test_util.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string lower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), ::tolower);
+    return s;
+}
+
+// 改动前的 containsIgnoreCase
+bool transformContains(const std::string& s, const std::string& k) {
+    return lower(s).find(lower(k)) != std::string::npos;
+}
+
+std::vector<std::string> makeTexts(size_t count, size_t minLen, size_t maxLen, unsigned seed) {
+    static const char kChars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_-./ ";
+    std::mt19937 rng(seed);
+    std::vector<std::string> texts(count);
+    for (auto& t : texts) {
+        size_t len = minLen + rng() % (maxLen - minLen + 1);
+        t.resize(len);
+        for (char& c : t) c = kChars[rng() % (sizeof(kChars) - 1)];
+        // 约 1/10 的文本含关键词
+        if (rng() % 10 == 0) t.insert(rng() % (len + 1), "Report");
+    }
+    return texts;
+}
+
+void run(const char* label, const std::vector<std::string>& texts, const std::string& needle) {
+    size_t bytes = 0;
+    for (const auto& t : texts) bytes += t.size();
+    size_t hitsA = 0, hitsB = 0, hitsC = 0;
+
+    double matcherSec = timeIt([&] {
+        TextMatcher matcher(needle);
+        for (const auto& t : texts) hitsA += matcher.matches(t);
+    });
+    double perCallSec = timeIt([&] {
+        for (const auto& t : texts) hitsB += transformContains(t, needle);
+    });
+    std::string key = lower(needle);
+    double preloweredSec = timeIt([&] {
+        for (const auto& t : texts) hitsC += lower(t).find(key) != std::string::npos;
+    });
+
+    printf("%s: %zu 条, 平均 %zu 字节, 命中 %zu%s\n", label, texts.size(), bytes / texts.size(), hitsA,
+           (hitsA == hitsB && hitsA == hitsC) ? "" : "  (结果不一致!)");
+    auto line = [&](const char* name, double sec) {
+        printf("  %-28s %8.1f ns/条 %8.2f GB/s\n", name, sec * 1e9 / texts.size(), bytes / sec / 1e9);
+    };
+    line(TextMatcher::kernelName(), matcherSec);
+    line("transform 文本+关键词", perCallSec);
+    line("transform 文本 (关键词预处理)", preloweredSec);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int n = (argc > 1) ? atoi(argv[1]) : 200000;
+    if (n <= 0) n = 200000;
+
+    auto shortTexts = makeTexts(static_cast<size_t>(n), 20, 60, 1);
+    auto longTexts = makeTexts(static_cast<size_t>(n) / 20 + 1, 900, 1100, 2);
+    run("短文本", shortTexts, "report");
+    run("长文本", longTexts, "report");
+    return 0;
+}
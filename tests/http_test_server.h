@@ -0,0 +1,170 @@
+/**
+ * @file http_test_server.h
+ * @brief 测试用的回环 HTTP 服务端
+ * @details 监听 127.0.0.1 的随机端口，后台线程一次处理一个连接：读出请求 (头 + Content-Length 的体)，
+ *          交给 handler 写原始响应字节；handler 返回 false 时服务端关闭这个连接。
+ *          记录建立过的连接数和收到的请求，用来检查复用、重连与重发。
+ */
+
+#ifndef HTTP_TEST_SERVER_H
+#define HTTP_TEST_SERVER_H
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+class HttpTestServer {
+public:
+    // fd 是当前连接，body 是请求体；返回 false 表示响应后关闭连接
+    using Handler = std::function<bool(int fd, const std::string& body)>;
+
+    HttpTestServer() {
+        listenFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        int one = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        socklen_t len = sizeof(addr);
+        getsockname(listenFd, reinterpret_cast<sockaddr*>(&addr), &len);
+        listenPort = ntohs(addr.sin_port);
+        listen(listenFd, 16);
+        worker = std::thread([this] { loop(); });
+    }
+
+    ~HttpTestServer() {
+        stopping = true;
+        worker.join();
+        close(listenFd);
+    }
+
+    int port() const { return listenPort; }
+
+    void setHandler(Handler h) {
+        std::lock_guard<std::mutex> g(lock);
+        handler = std::move(h);
+    }
+
+    // 清空计数和请求记录
+    void reset() {
+        std::lock_guard<std::mutex> g(lock);
+        connections = 0;
+        bodies.clear();
+    }
+
+    int connectionCount() {
+        std::lock_guard<std::mutex> g(lock);
+        return connections;
+    }
+
+    std::vector<std::string> requests() {
+        std::lock_guard<std::mutex> g(lock);
+        return bodies;
+    }
+
+    static bool sendAll(int fd, const std::string& data) {
+        size_t off = 0;
+        while (off < data.size()) {
+            ssize_t n = send(fd, data.data() + off, data.size() - off, MSG_NOSIGNAL);
+            if (n <= 0) return false;
+            off += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    // 带 Content-Length 的完整响应
+    static std::string response(const std::string& body, int status = 200, const std::string& extra = "") {
+        return "HTTP/1.1 " + std::to_string(status) + " X\r\nContent-Type: application/json\r\nContent-Length: " +
+               std::to_string(body.size()) + "\r\n" + extra + "\r\n" + body;
+    }
+
+    // 关闭时发 RST 而不是 FIN
+    static void resetConnection(int fd) {
+        linger lg{1, 0};
+        setsockopt(fd, SOL_SOCKET, SO_LINGER, &lg, sizeof(lg));
+    }
+
+private:
+    int listenFd = -1;
+    int listenPort = 0;
+    std::atomic<bool> stopping{false};
+    std::thread worker;
+    std::mutex lock;
+    Handler handler;
+    int connections = 0;
+    std::vector<std::string> bodies;
+
+    // 等 fd 可读，期间检查停止标志
+    bool waitReadable(int fd) {
+        while (!stopping) {
+            pollfd p{fd, POLLIN, 0};
+            int n = poll(&p, 1, 20);
+            if (n > 0) return true;
+            if (n < 0 && errno != EINTR) return false;
+        }
+        return false;
+    }
+
+    bool readRequest(int fd, std::string& buf, std::string& body) {
+        size_t headerEnd;
+        while ((headerEnd = buf.find("\r\n\r\n")) == std::string::npos) {
+            if (!readMore(fd, buf)) return false;
+        }
+        size_t length = 0;
+        const char* cl = strcasestr(buf.c_str(), "content-length:");
+        if (cl && cl < buf.c_str() + headerEnd) length = strtoul(cl + 15, nullptr, 10);
+        while (buf.size() < headerEnd + 4 + length) {
+            if (!readMore(fd, buf)) return false;
+        }
+        body = buf.substr(headerEnd + 4, length);
+        buf.erase(0, headerEnd + 4 + length);
+        return true;
+    }
+
+    bool readMore(int fd, std::string& buf) {
+        if (!waitReadable(fd)) return false;
+        char tmp[16384];
+        ssize_t n = recv(fd, tmp, sizeof(tmp), 0);
+        if (n <= 0) return false;
+        buf.append(tmp, static_cast<size_t>(n));
+        return true;
+    }
+
+    void loop() {
+        while (waitReadable(listenFd)) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd < 0) continue;
+            {
+                std::lock_guard<std::mutex> g(lock);
+                connections++;
+            }
+            std::string buf;
+            std::string body;
+            while (readRequest(fd, buf, body)) {
+                Handler h;
+                {
+                    std::lock_guard<std::mutex> g(lock);
+                    bodies.push_back(body);
+                    h = handler;
+                }
+                if (!h || !h(fd, body)) break;
+            }
+            close(fd);
+        }
+    }
+};
+
+#endif // HTTP_TEST_SERVER_H
@@ -0,0 +1,298 @@
+/**
+ * @file test_http_client.cpp
+ * @brief HttpClient 对着回环服务端的测试
+ * @details 覆盖 keep-alive 复用、chunked 响应与严格的块大小解析、对端关闭后重连、
+ *          只在一个响应字节都没收到时重发，以及"读到连接关闭"的响应体只在正常关闭时算完整。
+ */
+
+#include "core/http_client.h"
+#include "tests/http_test_server.h"
+#include "tests/test_util.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+void testKeepAlive(HttpTestServer& server) {
+    server.reset();
+    server.setHandler([](int fd, const std::string& body) {
+        return HttpTestServer::sendAll(fd, HttpTestServer::response("echo:" + body));
+    });
+    HttpClient client("127.0.0.1", server.port());
+    for (int i = 0; i < 5; ++i) {
+        std::string response;
+        int status = 0;
+        CHECK(client.post("/api/generate", "req" + std::to_string(i), response, status));
+        CHECK_EQ(status, 200);
+        CHECK_EQ(response, "echo:req" + std::to_string(i));
+    }
+    CHECK(client.isConnected());
+    CHECK_EQ(server.connectionCount(), 1);
+    CHECK_EQ(server.requests().size(), static_cast<size_t>(5));
+
+    // 1xx 临时响应之后才是真正的响应
+    server.setHandler([](int fd, const std::string&) {
+        return HttpTestServer::sendAll(fd, "HTTP/1.1 100 Continue\r\n\r\n" + HttpTestServer::response("ok"));
+    });
+    std::string response;
+    int status = 0;
+    CHECK(client.post("/", "x", response, status));
+    CHECK_EQ(status, 200);
+    CHECK_EQ(response, std::string("ok"));
+    CHECK_EQ(server.connectionCount(), 1);
+
+    // 4xx 也是一个完整的响应，连接照常复用
+    server.setHandler([](int fd, const std::string&) {
+        return HttpTestServer::sendAll(fd, HttpTestServer::response("{\"error\":\"bad\"}", 400));
+    });
+    CHECK(client.post("/", "x", response, status));
+    CHECK_EQ(status, 400);
+    CHECK_EQ(server.connectionCount(), 1);
+
+    // Connection: close 之后下一次请求重新连接
+    server.setHandler([](int fd, const std::string&) {
+        HttpTestServer::sendAll(fd, HttpTestServer::response("bye", 200, "Connection: close\r\n"));
+        return false;
+    });
+    CHECK(client.post("/", "x", response, status));
+    CHECK_EQ(response, std::string("bye"));
+    CHECK(!client.isConnected());
+}
+
+void testChunked(HttpTestServer& server) {
+    server.reset();
+    server.setHandler([](int fd, const std::string&) {
+        std::string r = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n";
+        r += "5\r\nhello\r\n";
+        r += "1;name=value\r\n \r\n";
+        r += "A \r\n0123456789\r\n";
+        r += "0\r\nX-Trailer: 1\r\n\r\n";
+        return HttpTestServer::sendAll(fd, r);
+    });
+    HttpClient client("127.0.0.1", server.port());
+    std::vector<std::string> pieces;
+    int status = 0;
+    bool ok = client.postStream("/api/generate", "{}", [&](const char* data, size_t len) {
+        pieces.emplace_back(data, len);
+        return true;
+    }, status);
+    CHECK(ok);
+    std::string joined;
+    for (const auto& p : pieces) joined += p;
+    CHECK_EQ(joined, std::string("hello 0123456789"));
+    CHECK(pieces.size() >= 3);
+
+    // 紧接着的请求还用同一个连接 (trailer 已经读干净)
+    std::string response;
+    CHECK(client.post("/", "x", response, status));
+    CHECK_EQ(response, joined);
+    CHECK_EQ(server.connectionCount(), 1);
+
+    // 块大小行必须以十六进制数字开头，之后只能是空白或 ";扩展"
+    const char* bad[] = {"", ";ext", " 5", "zz", "-1", "5x", "0x5", "+5", "ffffffffffffffffff"};
+    for (const char* sizeLine : bad) {
+        server.setHandler([sizeLine](int fd, const std::string&) {
+            std::string r = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n";
+            r += std::string(sizeLine) + "\r\nhello\r\n0\r\n\r\n";
+            HttpTestServer::sendAll(fd, r);
+            return false;
+        });
+        CHECK(!client.post("/", "x", response, status));
+        CHECK_EQ(client.lastError(), std::string("malformed chunk"));
+        CHECK(!client.isConnected());
+    }
+
+    // 提前放弃剩余数据：连接关掉，下次请求重连
+    server.reset();
+    server.setHandler([](int fd, const std::string&) {
+        return HttpTestServer::sendAll(fd, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+                                           "3\r\nabc\r\n3\r\ndef\r\n0\r\n\r\n");
+    });
+    std::string first;
+    CHECK(client.postStream("/", "x", [&](const char* data, size_t len) {
+        first.assign(data, len);
+        return false;
+    }, status));
+    CHECK_EQ(first, std::string("abc"));
+    CHECK(!client.isConnected());
+    CHECK(client.post("/", "x", response, status));
+    CHECK_EQ(response, std::string("abcdef"));
+}
+
+// 服务端在响应后关掉空闲连接：下一次请求在旧连接上发现对端已关闭，重连后重发一次
+void testReconnect(HttpTestServer& server) {
+    server.reset();
+    server.setHandler([](int fd, const std::string& body) {
+        HttpTestServer::sendAll(fd, HttpTestServer::response("r:" + body));
+        return false;   // 没发 Connection: close 就关掉，客户端以为还能复用
+    });
+    HttpClient client("127.0.0.1", server.port());
+    std::string response;
+    int status = 0;
+    for (int i = 0; i < 3; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));   // 等服务端的 FIN 到达
+        CHECK(client.post("/", "n" + std::to_string(i), response, status));
+        CHECK_EQ(response, "r:n" + std::to_string(i));
+        CHECK(client.lastError().empty());
+    }
+    CHECK_EQ(server.connectionCount(), 3);
+    // 旧连接上的请求服务端没有读到，每个请求只被处理了一次
+    CHECK_EQ(server.requests().size(), static_cast<size_t>(3));
+
+    // 空闲连接被重置 (RST) 也一样
+    server.reset();
+    server.setHandler([](int fd, const std::string& body) {
+        HttpTestServer::sendAll(fd, HttpTestServer::response("r:" + body));
+        HttpTestServer::resetConnection(fd);
+        return false;
+    });
+    CHECK(client.post("/", "a", response, status));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(client.post("/", "b", response, status));
+    CHECK_EQ(response, std::string("r:b"));
+    CHECK_EQ(server.requests().size(), static_cast<size_t>(2));
+}
+
+// 已经收到了部分响应、或者只是超时，请求可能已被处理，不能重发
+void testNoResend(HttpTestServer& server) {
+    HttpClient client("127.0.0.1", server.port());
+    std::string response;
+    int status = 0;
+
+    // 先建立一个可复用的连接
+    server.reset();
+    server.setHandler([](int fd, const std::string&) {
+        return HttpTestServer::sendAll(fd, HttpTestServer::response("ok"));
+    });
+    CHECK(client.post("/", "warm", response, status));
+
+    // 响应头发到一半就关闭
+    server.setHandler([](int fd, const std::string&) {
+        HttpTestServer::sendAll(fd, "HTTP/1.1 200 OK\r\nContent-Le");
+        return false;
+    });
+    CHECK(!client.post("/", "half", response, status));
+    CHECK_EQ(client.lastError(), std::string("connection closed by peer"));
+    auto reqs = server.requests();
+    CHECK_EQ(static_cast<int>(std::count(reqs.begin(), reqs.end(), "half")), 1);
+
+    // 响应体没收全就关闭
+    server.reset();
+    server.setHandler([](int fd, const std::string&) {
+        return HttpTestServer::sendAll(fd, HttpTestServer::response("ok"));
+    });
+    CHECK(client.post("/", "warm", response, status));
+    server.setHandler([](int fd, const std::string&) {
+        HttpTestServer::sendAll(fd, "HTTP/1.1 200 OK\r\nContent-Length: 100\r\n\r\npartial");
+        return false;
+    });
+    CHECK(!client.post("/", "body", response, status));
+    reqs = server.requests();
+    CHECK_EQ(static_cast<int>(std::count(reqs.begin(), reqs.end(), "body")), 1);
+
+    // 超时：服务端还在"生成"，不重发
+    server.reset();
+    server.setHandler([](int fd, const std::string&) {
+        return HttpTestServer::sendAll(fd, HttpTestServer::response("ok"));
+    });
+    CHECK(client.post("/", "warm", response, status));
+    client.setTimeouts(1000, 150, 150);
+    server.setHandler([](int, const std::string&) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(400));
+        return false;
+    });
+    CHECK(!client.post("/", "slow", response, status));
+    CHECK_EQ(client.lastError(), std::string("timeout"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(450));
+    reqs = server.requests();
+    CHECK_EQ(static_cast<int>(std::count(reqs.begin(), reqs.end(), "slow")), 1);
+}
+
+// 没有长度信息的响应体读到连接关闭：只有正常关闭算完整，重置和超时都是失败
+void testReadUntilClose(HttpTestServer& server) {
+    HttpClient client("127.0.0.1", server.port());
+    client.setTimeouts(1000, 200, 200);
+    std::string response;
+    int status = 0;
+
+    server.reset();
+    server.setHandler([](int fd, const std::string&) {
+        HttpTestServer::sendAll(fd, "HTTP/1.0 200 OK\r\n\r\nwhole body");
+        return false;
+    });
+    CHECK(client.post("/", "x", response, status));
+    CHECK_EQ(response, std::string("whole body"));
+    CHECK(client.lastError().empty());
+    CHECK(!client.isConnected());
+
+    server.setHandler([](int fd, const std::string&) {
+        HttpTestServer::sendAll(fd, "HTTP/1.1 200 OK\r\nConnection: close\r\n\r\ntrunc");
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        HttpTestServer::resetConnection(fd);
+        return false;
+    });
+    CHECK(!client.post("/", "x", response, status));
+    CHECK(client.lastError().find("recv") == 0);
+
+    server.setHandler([](int fd, const std::string&) {
+        HttpTestServer::sendAll(fd, "HTTP/1.1 200 OK\r\nConnection: close\r\n\r\nstall");
+        std::this_thread::sleep_for(std::chrono::milliseconds(400));
+        return false;
+    });
+    CHECK(!client.post("/", "x", response, status));
+    CHECK_EQ(client.lastError(), std::string("timeout"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(450));
+}
+
+void testConnectErrors() {
+    // 找一个没人监听的端口
+    int port;
+    {
+        HttpTestServer tmp;
+        port = tmp.port();
+    }
+    HttpClient client("127.0.0.1", port);
+    std::string response;
+    int status = 0;
+    CHECK(!client.post("/", "x", response, status));
+    CHECK(client.lastError().find("connect") == 0);
+
+    std::atomic<bool> cancel{true};
+    HttpTestServer server;
+    HttpClient cancelled("127.0.0.1", server.port());
+    cancelled.setCancelFlag(&cancel);
+    server.setHandler([](int, const std::string&) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        return false;
+    });
+    CHECK(!cancelled.post("/", "x", response, status));
+    CHECK_EQ(cancelled.lastError(), std::string("cancelled"));
+}
+
+} // namespace
+
+int main() {
+    std::string host, path;
+    int port = 0;
+    CHECK(HttpClient::parseUrl("http://localhost:11434/api/generate", host, port, path));
+    CHECK(host == "localhost" && port == 11434 && path == "/api/generate");
+    CHECK(HttpClient::parseUrl("http://[::1]:8080", host, port, path));
+    CHECK(host == "::1" && port == 8080 && path == "/");
+    CHECK(HttpClient::parseUrl("http://[::1]/api", host, port, path));
+    CHECK(host == "::1" && port == 80 && path == "/api");
+    CHECK(!HttpClient::parseUrl("https://localhost/", host, port, path));
+    CHECK(!HttpClient::parseUrl("http://localhost:0/", host, port, path));
+
+    HttpTestServer server;
+    testKeepAlive(server);
+    testChunked(server);
+    testReconnect(server);
+    testNoResend(server);
+    testReadUntilClose(server);
+    testConnectErrors();
+    return testResult();
+}
@@ -0,0 +1,273 @@
+/**
+ * @file test_json_reader.cpp
+ * @brief JsonReader 测试：转义与代理对、残缺与乱码输入、键的顺序、随机往返，以及大 NDJSON 流的吞吐
+ */
+
+#include "core/json_reader.h"
+#include "tests/test_util.h"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string getStr(const std::string& json, const char* key, bool* ok = nullptr) {
+    std::string out;
+    bool found = JsonReader(json).getString(key, out);
+    if (ok) *ok = found;
+    return found ? out : "<missing>";
+}
+
+void appendUtf8(std::string& out, unsigned cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+void testEscapes() {
+    CHECK_EQ(getStr(R"({"response":"a\nb\tc\"d\\e\/f\bg\fh\ri"})", "response"),
+             std::string("a\nb\tc\"d\\e/f\bg\fh\ri"));
+    CHECK_EQ(getStr(R"({"response":"\u4e2d\u6587"})", "response"), std::string("中文"));
+    CHECK_EQ(getStr(R"({"response":"\u00e9\u0041"})", "response"), std::string("\xC3\xA9" "A"));
+    // 代理对 -> 4 字节 UTF-8
+    CHECK_EQ(getStr(R"({"response":"\ud83d\ude00!"})", "response"), std::string("\xF0\x9F\x98\x80!"));
+    CHECK_EQ(getStr(R"({"response":"\uD83D\uDE00"})", "response"), std::string("\xF0\x9F\x98\x80"));
+    // 孤立的高/低代理替换成 U+FFFD
+    CHECK_EQ(getStr(R"({"response":"\ud83dx"})", "response"), std::string("\xEF\xBF\xBDx"));
+    CHECK_EQ(getStr(R"({"response":"\ude00"})", "response"), std::string("\xEF\xBF\xBD"));
+    CHECK_EQ(getStr(R"({"response":"\ud83dA"})", "response"), std::string("\xEF\xBF\xBD" "A"));
+    // 原样的 UTF-8 不动
+    CHECK_EQ(getStr("{\"response\":\"原样\"}", "response"), std::string("原样"));
+
+    // 非法转义
+    bool ok = true;
+    getStr(R"({"response":"\x41"})", "response", &ok);
+    CHECK(!ok);
+    getStr(R"({"response":"\u12"})", "response", &ok);
+    CHECK(!ok);
+    getStr(R"({"response":"\u12zz"})", "response", &ok);
+    CHECK(!ok);
+    getStr(R"({"response":"abc\"})", "response", &ok);
+    CHECK(!ok);
+}
+
+void testKeyOrderAndTypes() {
+    const char* orders[] = {
+        R"({"model":"m","response":"hi","done":false})",
+        R"({"done":false,"model":"m","response":"hi"})",
+        R"({ "response" : "hi" , "done" : false })",
+        "{\n\t\"context\": [1, 2, {\"response\": \"nested\"}],\r\n\t\"response\": \"hi\"\n}",
+        R"({"meta":{"response":"nested","deep":[[{"x":"]"}]]},"response":"hi"})",
+        R"({"response":"hi"})",
+        R"({"resp\u006fnse":"hi"})",   // 键名里的转义按反转义后比较
+    };
+    for (const char* json : orders) CHECK_EQ(getStr(json, "response"), std::string("hi"));
+
+    const std::string json = R"({"done":true,"eval_count":42,"ratio":-1.5e3,"none":null,"response":"x"})";
+    JsonReader r(json);
+    bool done = false;
+    double n = 0;
+    CHECK(r.getBool("done", done) && done);
+    CHECK(r.getNumber("eval_count", n) && n == 42);
+    CHECK(r.getNumber("ratio", n) && n == -1500);
+    JsonReader::Value v;
+    CHECK(r.find("none", v) && v.type == JsonReader::NUL);
+    CHECK(!r.find("missing", v));
+    std::string s;
+    CHECK(!r.getString("done", s));   // 类型不符
+
+    // 嵌套超过 64 层的值当作格式错误，不会越过栈
+    std::string deep = "{\"ctx\":" + std::string(65, '[') + std::string(65, ']') + ",\"response\":\"hi\"}";
+    CHECK(!JsonReader(deep).find("response", v));
+    deep = "{\"ctx\":" + std::string(64, '[') + std::string(64, ']') + ",\"response\":\"hi\"}";
+    CHECK_EQ(getStr(deep, "response"), std::string("hi"));
+
+    // 顶层不是对象
+    for (const std::string bad : {R"(["response","hi"])", "", "{}", R"({"response")", R"({"response":})"}) {
+        CHECK(!JsonReader(bad).find("response", v));
+    }
+}
+
+void testTruncated() {
+    const std::string full = R"({"model":"m","context":[1,2,3],"meta":{"a":"\"}"},"response":"中\n","done":false})";
+    CHECK_EQ(getStr(full, "response"), std::string("中\n"));
+    // 每一个前缀：要么找不到，要么给出正确的值，不能越界或给出半截
+    for (size_t n = 0; n < full.size(); ++n) {
+        std::string prefix = full.substr(0, n);
+        bool ok = false;
+        std::string got = getStr(prefix, "response", &ok);
+        if (ok) CHECK_EQ(got, std::string("中\n"));
+        bool done;
+        JsonReader(prefix).getBool("done", done);
+    }
+}
+
+void testGarbage() {
+    std::mt19937 rng(12345);
+    const std::string base = R"({"model":"m","response":"a中😀","ctx":[1,{"k":"v"}],"done":true})";
+    std::string out;
+    JsonReader::Value v;
+    for (int i = 0; i < 20000; ++i) {
+        std::string s;
+        if (i % 2 == 0) {
+            // 纯随机字节 (偏向 JSON 里的特殊字符)
+            static const char special[] = "{}[]\":,\\u0123456789abcdefABCDEF \n";
+            size_t len = rng() % 64;
+            for (size_t k = 0; k < len; ++k) {
+                s += (rng() % 2) ? special[rng() % (sizeof(special) - 1)] : static_cast<char>(rng() & 0xFF);
+            }
+        } else {
+            // 在合法对象上随机改几个字节
+            s = base;
+            int edits = 1 + rng() % 4;
+            for (int k = 0; k < edits; ++k) s[rng() % s.size()] = static_cast<char>(rng() & 0xFF);
+        }
+        JsonReader r(s);
+        r.getString("response", out);
+        r.find("done", v);
+        r.find("ctx", v);
+        size_t pos = 0;
+        const char* line;
+        size_t lineLen;
+        while (JsonReader::nextLine(s.data(), s.size(), pos, line, lineLen, false)) {
+            CHECK(line >= s.data() && line + lineLen <= s.data() + s.size());
+        }
+    }
+}
+
+// 随机生成字符串和各种写法的转义，读回来必须和原文一致
+void testRoundTrip() {
+    std::mt19937 rng(2024);
+    std::vector<std::string> keys = {"model", "created_at", "response", "done", "context", "total_duration"};
+    for (int i = 0; i < 5000; ++i) {
+        std::string original;
+        std::string encoded;
+        int chars = rng() % 40;
+        for (int k = 0; k < chars; ++k) {
+            unsigned cp;
+            switch (rng() % 5) {
+                case 0: cp = 0x20 + rng() % 0x5F; break;
+                case 1: cp = rng() % 0x20; break;
+                case 2: cp = 0x4E00 + rng() % 0x5000; break;
+                case 3: cp = 0x10000 + rng() % 0x10000; break;
+                default: cp = "\"\\/\n"[rng() % 4]; break;
+            }
+            appendUtf8(original, cp);
+            bool escape = cp < 0x20 || cp == '"' || cp == '\\' || rng() % 3 == 0;
+            if (!escape) {
+                appendUtf8(encoded, cp);
+            } else if (cp == '\n' && rng() % 2) {
+                encoded += "\\n";
+            } else if (cp == '"' || cp == '\\') {
+                encoded += '\\';
+                encoded += static_cast<char>(cp);
+            } else {
+                char buf[16];
+                if (cp >= 0x10000) {
+                    unsigned c = cp - 0x10000;
+                    snprintf(buf, sizeof(buf), (rng() % 2) ? "\\u%04x\\u%04x" : "\\u%04X\\u%04X",
+                             0xD800 + (c >> 10), 0xDC00 + (c & 0x3FF));
+                } else {
+                    snprintf(buf, sizeof(buf), "\\u%04x", cp);
+                }
+                encoded += buf;
+            }
+        }
+
+        std::shuffle(keys.begin(), keys.end(), rng);
+        std::string json = "{";
+        for (size_t k = 0; k < keys.size(); ++k) {
+            if (k) json += (rng() % 2) ? "," : " ,\n ";
+            json += "\"" + keys[k] + "\":";
+            if (keys[k] == "response") json += "\"" + encoded + "\"";
+            else if (keys[k] == "context") json += "[1,[2,{\"response\":\"no\"}],\"]\"]";
+            else if (keys[k] == "done") json += "false";
+            else json += "\"x\\\"y\"";
+        }
+        json += "}";
+        CHECK_EQ(getStr(json, "response"), original);
+    }
+}
+
+void testNextLine() {
+    const std::string buf = "\n{\"a\":1}\r\n  \n{\"b\":2}\n{\"c\":3}";
+    size_t pos = 0;
+    const char* line;
+    size_t len;
+    std::vector<std::string> lines;
+    while (JsonReader::nextLine(buf.data(), buf.size(), pos, line, len)) lines.emplace_back(line, len);
+    CHECK_EQ(lines.size(), static_cast<size_t>(2));
+    if (lines.size() == 2) {
+        CHECK_EQ(lines[0], std::string("{\"a\":1}"));
+        CHECK_EQ(lines[1], std::string("{\"b\":2}"));
+    }
+    // 最后一行没有换行：默认不返回，requireNewline=false 时返回
+    CHECK(JsonReader::nextLine(buf.data(), buf.size(), pos, line, len, false));
+    CHECK_EQ(std::string(line, len), std::string("{\"c\":3}"));
+    CHECK_EQ(pos, buf.size());
+}
+
+// 模拟一次很长的流式回复：按 Ollama 的 NDJSON 格式逐行取 response 拼起来
+void testNdjsonThroughput() {
+    const char* pieces[] = {"系统", "负载", "正常", "，", "CPU ", "使用率 ", "42%", "\\n", "\\u4e2d", "\\\"ok\\\""};
+    const char* decoded[] = {"系统", "负载", "正常", "，", "CPU ", "使用率 ", "42%", "\n", "中", "\"ok\""};
+    const size_t kLines = 400000;
+
+    std::string stream;
+    std::string expected;
+    stream.reserve(kLines * 110);
+    for (size_t i = 0; i < kLines; ++i) {
+        size_t k = i % 10;
+        stream += "{\"model\":\"qwen2.5:7b\",\"created_at\":\"2024-05-01T12:00:00.";
+        stream += std::to_string(i);
+        stream += "Z\",\"response\":\"";
+        stream += pieces[k];
+        stream += "\",\"done\":false}\n";
+        expected += decoded[k];
+    }
+    stream += "{\"model\":\"qwen2.5:7b\",\"response\":\"\",\"done\":true,\"context\":[1,2,3],\"eval_count\":400000}\n";
+
+    std::string text;
+    std::string fragment;
+    size_t lines = 0;
+    double seconds = timeIt([&] {
+        size_t pos = 0;
+        const char* line;
+        size_t len;
+        while (JsonReader::nextLine(stream.data(), stream.size(), pos, line, len)) {
+            if (JsonReader(line, len).getString("response", fragment)) text += fragment;
+            lines++;
+        }
+    });
+    CHECK_EQ(lines, kLines + 1);
+    CHECK(text == expected);
+    printf("NDJSON: %zu 行 %.1f MB，%.3f 秒，%.0f MB/s\n", lines, stream.size() / 1e6, seconds,
+           stream.size() / 1e6 / seconds);
+}
+
+} // namespace
+
+int main() {
+    testEscapes();
+    testKeyOrderAndTypes();
+    testTruncated();
+    testGarbage();
+    testRoundTrip();
+    testNextLine();
+    testNdjsonThroughput();
+    return testResult();
+}
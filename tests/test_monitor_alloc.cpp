@@ -0,0 +1,109 @@
+/**
+ * @file test_monitor_alloc.cpp
+ * @brief CpuMonitor / MemMonitor 的采样路径不做堆分配
+ * @details 替换全局 operator new 计数：两个快照缓冲都填过一次之后 (每核数组已经分配好)，
+ *          再采 N 次、读 N 次快照，分配次数必须是 0。
+ */
+
+#include "modules/cpu/cpu_monitor.h"
+#include "modules/memory/mem_monitor.h"
+#include "tests/test_util.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<bool> counting{false};
+std::atomic<long> allocations{0};
+
+void* countedAlloc(size_t n) {
+    if (counting.load(std::memory_order_relaxed)) allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = malloc(n ? n : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+} // namespace
+
+void* operator new(size_t n) { return countedAlloc(n); }
+void* operator new[](size_t n) { return countedAlloc(n); }
+void* operator new(size_t n, const std::nothrow_t&) noexcept {
+    try { return countedAlloc(n); } catch (...) { return nullptr; }
+}
+void* operator new[](size_t n, const std::nothrow_t&) noexcept {
+    try { return countedAlloc(n); } catch (...) { return nullptr; }
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+namespace {
+
+const int kSamples = 2000;
+
+// 统计 fn() 期间的分配次数
+template <typename Fn>
+long countAllocations(Fn&& fn) {
+    allocations = 0;
+    counting = true;
+    fn();
+    counting = false;
+    return allocations.load();
+}
+
+void testCpu() {
+    CpuMonitor cpu;   // 构造时已发布一份
+    cpu.sample();     // 第二个缓冲也填一次
+    double sink = 0;
+    long n = countAllocations([&] {
+        for (int i = 0; i < kSamples; ++i) {
+            cpu.sample();
+            auto snap = cpu.snapshot();
+            sink += snap->usagePercent + snap->freqMHz;
+            if (snap->coreCount() > 0) sink += snap->usage[0];
+        }
+    });
+    CHECK_EQ(n, 0L);
+    auto snap = cpu.snapshot();
+    CHECK(snap->coreCount() > 0);
+    CHECK(snap->usagePercent >= 0 && snap->usagePercent <= 100);
+    CHECK_EQ(snap.version(), static_cast<uint64_t>(kSamples + 2));
+    printf("CpuMonitor: %d 次采样 %ld 次分配 (%zu 核)\n", kSamples, n, snap->coreCount());
+    (void)sink;
+}
+
+void testMem() {
+    MemMonitor mem;
+    mem.sample();
+    double sink = 0;
+    long n = countAllocations([&] {
+        for (int i = 0; i < kSamples; ++i) {
+            mem.sample();
+            sink += mem.snapshot()->availableMB;
+            sink += mem.getMemoryStatus().usedMB;
+        }
+    });
+    CHECK_EQ(n, 0L);
+    MemoryStatus s = mem.getMemoryStatus();
+    CHECK(s.totalMB > 0);
+    CHECK(s.availableMB > 0 && s.availableMB <= s.totalMB);
+    CHECK(s.usagePercent >= 0 && s.usagePercent <= 100);
+    printf("MemMonitor: %d 次采样 %ld 次分配\n", kSamples, n);
+    (void)sink;
+}
+
+} // namespace
+
+int main() {
+    // 先确认计数器本身有效，免得替换没生效时测试白白通过
+    long probe = countAllocations([] {
+        int* volatile p = new int(1);
+        delete p;
+    });
+    CHECK_EQ(probe, 1L);
+
+    testCpu();
+    testMem();
+    return testResult();
+}
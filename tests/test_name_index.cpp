@@ -0,0 +1,102 @@
+/**
+ * @file test_name_index.cpp
+ * @brief NameIndex 测试：建索引、查询排序，以及监听到的增删 (新目录的子树由后台线程补扫)
+ */
+
+#include "file/name_index.h"
+#include "tests/test_util.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+void touch(const fs::path& p) {
+    std::ofstream(p.string()) << "x";
+}
+
+// 增量更新是异步的：最多等 5 秒让 pred 成立
+template <typename Pred>
+bool waitFor(Pred&& pred) {
+    for (int i = 0; i < 250; ++i) {
+        if (pred()) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    return pred();
+}
+
+bool contains(const std::vector<std::string>& v, const std::string& s) {
+    return std::find(v.begin(), v.end(), s) != v.end();
+}
+
+} // namespace
+
+int main() {
+    char tmpl[] = "/tmp/aios_name_index_XXXXXX";
+    if (!mkdtemp(tmpl)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    const fs::path root = tmpl;
+    fs::create_directories(root / "src" / "core");
+    touch(root / "src" / "core" / "Report.txt");
+    touch(root / "src" / "core" / "old_report.txt");
+    touch(root / "src" / "report");
+    touch(root / "notes.md");
+
+    NameIndex index;
+    index.buildAsync(root.string());
+    CHECK(waitFor([&] { return index.isReady(); }));
+    CHECK_EQ(index.size(), static_cast<size_t>(6));   // 两个目录 + 四个文件
+
+    // 完全相同 > 前缀 > 词首 > 其他，忽略大小写
+    auto hits = index.search("report", 10);
+    CHECK_EQ(hits.size(), static_cast<size_t>(3));
+    if (hits.size() == 3) {
+        CHECK_EQ(hits[0], (root / "src" / "report").string());
+        CHECK_EQ(hits[1], (root / "src" / "core" / "Report.txt").string());
+        CHECK_EQ(hits[2], (root / "src" / "core" / "old_report.txt").string());
+    }
+    CHECK_EQ(index.search("md", 10).size(), static_cast<size_t>(1));   // 短查询走线性扫描
+    CHECK(index.search("nothing_like_this", 10).empty());
+
+    // 新目录带着一棵子树出现 (整体移进来)：由后台线程扫描后加入
+    fs::path staging = root.string() + "_staging";
+    fs::create_directories(staging / "deep" / "er");
+    for (int i = 0; i < 200; ++i) touch(staging / "deep" / "er" / ("moved_" + std::to_string(i) + ".log"));
+    fs::rename(staging, root / "moved");
+    CHECK(waitFor([&] { return index.search("moved_", 1000).size() == 200; }));
+    CHECK(waitFor([&] { return contains(index.search("er", 1000), (root / "moved" / "deep" / "er").string()); }));
+
+    // 新目录里随后创建的文件照常加入
+    touch(root / "moved" / "deep" / "later_file.txt");
+    CHECK(waitFor([&] { return index.search("later_file", 10).size() == 1; }));
+
+    // 单个文件的增删
+    touch(root / "src" / "fresh_file.cpp");
+    CHECK(waitFor([&] { return index.search("fresh_file", 10).size() == 1; }));
+    fs::remove(root / "src" / "fresh_file.cpp");
+    CHECK(waitFor([&] { return index.search("fresh_file", 10).empty(); }));
+
+    // 删除整棵子树
+    fs::remove_all(root / "moved");
+    CHECK(waitFor([&] { return index.search("moved_", 1000).empty() && index.search("later_file", 10).empty(); }));
+    CHECK(waitFor([&] { return index.size() == 6; }));
+
+    // 重建到别的根目录
+    index.buildAsync((root / "src").string());
+    CHECK(waitFor([&] { return index.isReady(); }));
+    CHECK(index.search("notes", 10).empty());
+    CHECK_EQ(index.search("report", 10).size(), static_cast<size_t>(3));
+
+    fs::remove_all(root);
+    return testResult();
+}
@@ -0,0 +1,124 @@
+/**
+ * @file test_proc_sampler.cpp
+ * @brief ProcSampler / ProcTable 测试：名字索引的查找结果与逐个进程比对的参考实现一致
+ * @details 先起一个 argv[0] 改过名的 sh 子进程，确认精确 (comm、长 argv[0]) 和模糊查找都能找到它；
+ *          再拿本机全部进程的名字和参数片段做关键词，与线性扫描 + transform 的参考结果逐一比较。
+ */
+
+#include "process/proc_sampler.h"
+#include "tests/test_util.h"
+#include <algorithm>
+#include <cctype>
+#include <csignal>
+#include <set>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+std::string lower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+    return s;
+}
+
+// 参考实现：逐个进程比较
+std::set<int> referenceFind(const ProcTable& table, const std::string& name, bool exact) {
+    std::set<int> pids;
+    std::string needle = lower(name);
+    for (const auto& s : table.procs) {
+        bool hit;
+        if (exact) {
+            hit = s.name == name || (s.cmdline && s.cmdline->argv0Base == name);
+        } else {
+            hit = lower(s.name).find(needle) != std::string::npos;
+            if (!hit && s.cmdline) {
+                for (const auto& tok : s.cmdline->tokens) {
+                    if (lower(tok).find(needle) != std::string::npos) hit = true;
+                }
+            }
+        }
+        if (hit) pids.insert(s.pid);
+    }
+    return pids;
+}
+
+std::set<int> indexedFind(const ProcTable& table, const std::string& name, bool exact) {
+    std::vector<size_t> hits = table.find(name, exact);
+    std::set<int> pids;
+    for (size_t i : hits) pids.insert(table.procs[i].pid);
+    CHECK_EQ(pids.size(), hits.size());   // 不重复
+    // 按 CPU% 从高到低
+    for (size_t k = 1; k < hits.size(); ++k) {
+        CHECK(table.procs[hits[k - 1]].cpuPercent >= table.procs[hits[k]].cpuPercent);
+    }
+    return pids;
+}
+
+} // namespace
+
+int main() {
+    const char* kArgv0 = "/opt/aios-test/aios_sleeper_with_a_long_name";
+    pid_t child = fork();
+    if (child == 0) {
+        setpgid(0, 0);   // 自成一组，结束时连同 sh 起的 sleep 一起杀掉
+        execl("/bin/sh", kArgv0, "-c", "sleep 30; : Marker-Arg", static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    CHECK(child > 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));   // 等 exec 完成
+
+    ProcSampler sampler;
+    ProcTable table;
+    CHECK(sampler.sample(table) > 0);
+    CHECK(!table.hasCpu);
+    CHECK(sampler.sample(table) > 0);   // 第二次复用同一张表，索引要换成新内容
+    CHECK(table.hasCpu);
+    CHECK(table.memTotalKB > 0);
+
+    auto has = [&](const std::set<int>& pids) { return pids.count(child) == 1; };
+    CHECK(has(indexedFind(table, "sh", true)));   // comm
+    CHECK(has(indexedFind(table, "aios_sleeper_with_a_long_name", true)));   // 超过 comm 的 15 字节
+    CHECK(!has(indexedFind(table, "aios_sleeper", true)));
+    CHECK(!has(indexedFind(table, "sleep 30; : Marker-Arg", true)));   // 精确查找只看 comm 和 argv[0]
+    CHECK(has(indexedFind(table, "SLEEPER_WITH", false)));
+    CHECK(has(indexedFind(table, "marker-arg", false)));
+    CHECK(has(indexedFind(table, "aios-test", false)));
+    CHECK(indexedFind(table, "", false).empty());
+    CHECK(indexedFind(table, "no-such-process-aios-zz", false).empty());
+
+    // 与参考实现逐一比对：本机每个进程的名字、参数以及它们的片段
+    std::set<std::string> queries;
+    for (const auto& s : table.procs) {
+        queries.insert(s.name);
+        if (s.name.size() > 3) queries.insert(s.name.substr(1, 3));
+        if (!s.cmdline) continue;
+        for (const auto& tok : s.cmdline->tokens) {
+            queries.insert(tok);
+            if (tok.size() > 4) queries.insert(tok.substr(tok.size() / 2, 3));
+        }
+    }
+    queries.erase("");
+    int compared = 0;
+    for (const auto& q : queries) {
+        for (bool exact : {true, false}) {
+            std::set<int> got = indexedFind(table, q, exact);
+            std::set<int> want = referenceFind(table, q, exact);
+            if (got != want) {
+                std::cerr << "mismatch for '" << q << "' exact=" << exact << ": " << got.size() << " vs "
+                          << want.size() << std::endl;
+                testFailures()++;
+            }
+            compared++;
+        }
+    }
+    std::cout << table.procs.size() << " 个进程，比对了 " << compared << " 次查找" << std::endl;
+
+    kill(-child, SIGKILL);
+    waitpid(child, nullptr, 0);
+    sampler.sample(table);
+    CHECK(!has(indexedFind(table, "aios_sleeper_with_a_long_name", true)));
+    return testResult();
+}
@@ -0,0 +1,119 @@
+/**
+ * @file test_text_match.cpp
+ * @brief TextMatcher 与 transform(tolower) + std::string::find 参考实现的对拍
+ * @details 固定种子随机生成 20 万组 (文本, 关键词)，字母表刻意偏向容易出错的字节：
+ *          大小写字母、和字母只差 0x20 的标点 ('@' '[' '`' '{')、中文、全角字母、截断的 0xEF 序列。
+ *          文本长度跨过 16/32 字节的向量块边界，关键词一半取自文本 (随机翻转大小写) 保证命中。
+ *          ASCII 模式比较返回的偏移；UTF8 模式参考实现先 foldFullwidth 再小写，偏移同样是折叠后文本中的。
+ */
+
+#include "core/text_match.h"
+#include "tests/test_util.h"
+#include <algorithm>
+#include <cctype>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int kCases = 200000;
+
+// 生成文本用的片段，每次随机取一个拼接
+const std::vector<std::string> kPieces = {
+    "a", "b", "c", "A", "B", "C", "z", "Z", "x", "X",
+    "@", "[", "`", "{", "0", "-", ".", "/", " ",
+    "\xE8\xBF\x9B",   // 进
+    "\xE7\xA8\x8B",   // 程
+    "\xEF\xBC\xA1",   // 全角 A
+    "\xEF\xBD\x81",   // 全角 a
+    "\xEF\xBC\xA3",   // 全角 C
+    "\xEF\xBD\x9B",   // 全角 {
+    "\xEF\xBC",       // 截断的全角序列
+    "\xEF",
+};
+
+std::string lower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(::tolower(c)); });
+    return s;
+}
+
+size_t referenceFind(const std::string& hay, const std::string& needle, TextMatcher::Mode mode) {
+    if (mode == TextMatcher::UTF8) {
+        return lower(TextMatcher::foldFullwidth(hay.data(), hay.size()))
+            .find(lower(TextMatcher::foldFullwidth(needle.data(), needle.size())));
+    }
+    return lower(hay).find(lower(needle));
+}
+
+std::string randomText(std::mt19937& rng, size_t pieces) {
+    std::string s;
+    for (size_t i = 0; i < pieces; ++i) s += kPieces[rng() % kPieces.size()];
+    return s;
+}
+
+// 随机翻转 ASCII 字母的大小写
+std::string flipCase(std::mt19937& rng, std::string s) {
+    for (char& c : s) {
+        unsigned char u = static_cast<unsigned char>(c);
+        if (isalpha(u) && (rng() & 1)) c = static_cast<char>(u ^ 0x20);
+    }
+    return s;
+}
+
+void crossCheck(TextMatcher::Mode mode) {
+    std::mt19937 rng(mode == TextMatcher::UTF8 ? 8 : 7);
+    int mismatches = 0;
+    int hits = 0;
+    for (int i = 0; i < kCases; ++i) {
+        std::string hay = randomText(rng, rng() % 90);
+        std::string needle;
+        if (!hay.empty() && (rng() & 1)) {
+            size_t start = rng() % hay.size();
+            needle = flipCase(rng, hay.substr(start, 1 + rng() % 12));
+        } else {
+            needle = randomText(rng, 1 + rng() % 4);
+        }
+
+        TextMatcher matcher(needle, mode);
+        size_t got = matcher.find(hay);
+        size_t want = referenceFind(hay, needle, mode);
+        if (want != std::string::npos) hits++;
+        if (got != want) {
+            if (++mismatches <= 5) {
+                std::cerr << "mode " << mode << " case " << i << ": find=" << got << " reference=" << want
+                          << " hay.size=" << hay.size() << " needle.size=" << needle.size() << std::endl;
+            }
+        }
+    }
+    CHECK_EQ(mismatches, 0);
+    // 保证对拍覆盖到了命中和未命中两种情况
+    CHECK(hits > kCases / 4);
+    CHECK(hits < kCases);
+}
+
+void testBasics() {
+    CHECK_EQ(TextMatcher("CPU").find(std::string("top cpu usage")), 4u);
+    CHECK_EQ(TextMatcher("").find(std::string("abc")), 0u);
+    CHECK_EQ(TextMatcher("abcd").find(std::string("abc")), TextMatcher::npos);
+    // '@' 和 '`' 与字母只差 0x20，不能被当成字母折叠
+    CHECK(!TextMatcher("a").matches(std::string("@`[{")));
+    CHECK(!TextMatcher("@").matches(std::string("`")));
+    // 中文关键词按原始字节匹配
+    CHECK(TextMatcher("\xE8\xBF\x9B\xE7\xA8\x8B").matches(std::string("\xE6\x9F\xA5\xE8\xBF\x9B\xE7\xA8\x8B")));
+    // 全角只在 UTF8 模式折叠："ＣＰＵ" 命中 "cpu"
+    std::string fullwidthCpu = "\xEF\xBC\xA3\xEF\xBC\xB0\xEF\xBC\xB5";
+    CHECK(!TextMatcher("cpu").matches(fullwidthCpu));
+    CHECK(TextMatcher("cpu", TextMatcher::UTF8).matches(fullwidthCpu));
+    CHECK(TextMatcher(fullwidthCpu, TextMatcher::UTF8).matches(std::string("CPU")));
+}
+
+} // namespace
+
+int main() {
+    std::cout << "kernel: " << TextMatcher::kernelName() << std::endl;
+    testBasics();
+    crossCheck(TextMatcher::ASCII);
+    crossCheck(TextMatcher::UTF8);
+    return testResult();
+}
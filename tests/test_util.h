@@ -0,0 +1,53 @@
+/**
+ * @file test_util.h
+ * @brief 测试用的最小断言工具
+ * @details 不引入测试框架：CHECK 失败时打印位置和表达式并计数，main 最后 return testResult()。
+ *          失败不中止，同一个测试里的其余检查照常运行。
+ */
+
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+inline int& testFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(expr)                                                                       \
+    do {                                                                                  \
+        if (!(expr)) {                                                                    \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #expr << std::endl; \
+            testFailures()++;                                                             \
+        }                                                                                 \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                                    \
+    do {                                                                                  \
+        auto va_ = (a);                                                                   \
+        auto vb_ = (b);                                                                   \
+        if (!(va_ == vb_)) {                                                              \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK_EQ failed: " #a " == " #b \
+                      << " (" << va_ << " vs " << vb_ << ")" << std::endl;                \
+            testFailures()++;                                                             \
+        }                                                                                 \
+    } while (0)
+
+inline int testResult() {
+    if (testFailures() == 0) std::cout << "OK" << std::endl;
+    else std::cerr << testFailures() << " check(s) failed" << std::endl;
+    return testFailures() == 0 ? 0 : 1;
+}
+
+// 计时：返回 fn() 运行的秒数
+template <typename Fn>
+double timeIt(Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+#endif // TEST_UTIL_H